@@ -0,0 +1,51 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "include_gardener.h"
+#include "solver.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Returns a solver for options.language, configured with
+///        options.process_paths and options.include_paths.
+/// @throws std::invalid_argument if the language is not supported.
+Solver::Ptr make_solver(const Analysis_Options &options);
+
+/// @brief Scans all input files and builds the graph in solver.
+/// @details
+///   This is the pipeline of the command line tool: the file walk
+///   (File_Detector), the scan (Statement_Detector, optionally with a
+///   Scan_Cache) and the resolution by the solver. With a partial shard
+///   (options.shard), all files get a vertex, but only the files of the
+///   shard are scanned, so the graph only has their out-edges.
+void build_graph(const Solver::Ptr &solver, const Analysis_Options &options);
+
+/// @brief Runs the pipeline with a configured solver.
+Include_Graph analyze(const Solver::Ptr &solver,
+                      const Analysis_Options &options);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // ANALYSIS_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,276 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "run_stats.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Bounded multi-producer / multi-consumer queue without locks.
+/// @details
+///   The entries are stored in a ring of cells with sequence numbers
+///   (D. Vyukov's bounded MPMC queue): push and pop reserve a cell via
+///   compare-and-swap of their position and publish it via the sequence
+///   number of the cell, so producers and consumers never wait for a lock.
+///   The capacity is rounded up to a power of two.
+///
+///   A full queue (push) or an empty queue (pop) makes the calling thread
+///   back off: it first yields and then sleeps up to MAX_BACKOFF.
+///   close() is called after the last push: pop() then returns false as
+///   soon as the queue is empty.
+///
+///   The depth after each push and the number of waits are counted, see
+///   get_stats().
+template <typename T>
+class Bounded_Queue {
+ public:
+  /// @brief Longest sleep of a waiting push() or pop().
+  static constexpr std::chrono::microseconds MAX_BACKOFF{1000};
+
+  /// @brief Initializes an empty queue.
+  /// @param capacity Minimum number of entries (at least 2).
+  explicit Bounded_Queue(std::size_t capacity)
+      : mask(round_up(capacity) - 1),
+        cells(std::make_unique<Cell[]>(mask + 1)) {
+    for (std::size_t i = 0; i <= mask; ++i) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /// @brief Copy ctor: not implemented!
+  Bounded_Queue(const Bounded_Queue &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Bounded_Queue &operator=(const Bounded_Queue &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Bounded_Queue(Bounded_Queue &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Bounded_Queue &operator=(Bounded_Queue &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Bounded_Queue() = default;
+
+  /// @brief Adds an entry if the queue is not full.
+  /// @return True if value was moved into the queue.
+  bool try_push(T &value) {
+    Cell *cell;
+    auto pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &cells[pos & mask];
+      const auto seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    count_push(pos + 1);
+    return true;
+  }
+
+  /// @brief Takes the oldest entry if the queue is not empty.
+  /// @return True if an entry was moved to value.
+  bool try_pop(T *value) {
+    Cell *cell;
+    auto pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &cells[pos & mask];
+      const auto seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    *value = std::move(cell->value);
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Adds an entry, waits while the queue is full.
+  void push(T value) {
+    if (try_push(value)) {
+      return;
+    }
+    n_full.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    while (!try_push(value)) {
+      backoff.wait();
+    }
+  }
+
+  /// @brief Takes the oldest entry, waits while the queue is empty.
+  /// @return False if the queue is closed and empty.
+  bool pop(T *value) {
+    if (try_pop(value)) {
+      return true;
+    }
+    n_empty.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    for (;;) {
+      if (closed.load(std::memory_order_acquire)) {
+        // all pushes happened before close()
+        return try_pop(value);
+      }
+      if (try_pop(value)) {
+        return true;
+      }
+      backoff.wait();
+    }
+  }
+
+  /// @brief Marks the end of the entries (no push() must follow).
+  void close() { closed.store(true, std::memory_order_release); }
+
+  /// @brief Returns the capacity.
+  std::size_t get_capacity() const { return mask + 1; }
+
+  /// @brief Returns the number of entries (approximately, while other
+  ///        threads push or pop).
+  std::size_t size() const {
+    const auto head = dequeue_pos.load(std::memory_order_relaxed);
+    const auto tail = enqueue_pos.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+  /// @brief Returns the depth statistics.
+  Queue_Stats get_stats() const {
+    Queue_Stats stats;
+    stats.capacity = get_capacity();
+    stats.n_pushes = n_pushes.load(std::memory_order_relaxed);
+    stats.depth_sum = depth_sum.load(std::memory_order_relaxed);
+    stats.max_depth = max_depth.load(std::memory_order_relaxed);
+    stats.n_full = n_full.load(std::memory_order_relaxed);
+    stats.n_empty = n_empty.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  /// @brief An entry and its sequence number.
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};  ///< Position which may use it
+    T value{};                             ///< The entry
+  };
+
+  /// @brief Yields first, then sleeps with increasing duration.
+  class Backoff {
+   public:
+    void wait() {
+      if (n_yields < MAX_YIELDS) {
+        ++n_yields;
+        std::this_thread::yield();
+        return;
+      }
+      std::this_thread::sleep_for(sleep);
+      sleep = std::min(sleep * 2, MAX_BACKOFF);
+    }
+
+   private:
+    static constexpr unsigned int MAX_YIELDS = 16;
+    unsigned int n_yields = 0;
+    std::chrono::microseconds sleep{10};
+  };
+
+  /// @brief Returns the next power of two (at least 2).
+  static std::size_t round_up(std::size_t n) {
+    std::size_t result = 2;
+    while (result < n) {
+      result *= 2;
+    }
+    return result;
+  }
+
+  /// @brief Counts a push which ended at position end.
+  void count_push(std::size_t end) {
+    const auto head = dequeue_pos.load(std::memory_order_relaxed);
+    const std::size_t depth = end > head ? end - head : 0;
+    n_pushes.fetch_add(1, std::memory_order_relaxed);
+    depth_sum.fetch_add(depth, std::memory_order_relaxed);
+    auto max = max_depth.load(std::memory_order_relaxed);
+    while (depth > max && !max_depth.compare_exchange_weak(
+                              max, depth, std::memory_order_relaxed)) {
+    }
+  }
+
+  /// @brief Capacity - 1 (the capacity is a power of two).
+  const std::size_t mask;
+
+  /// @brief The ring.
+  std::unique_ptr<Cell[]> cells;
+
+  /// @brief Position of the next push (on its own cache line).
+  alignas(64) std::atomic<std::size_t> enqueue_pos{0};
+
+  /// @brief Position of the next pop (on its own cache line).
+  alignas(64) std::atomic<std::size_t> dequeue_pos{0};
+
+  /// @brief Set by close().
+  alignas(64) std::atomic<bool> closed{false};
+
+  /// @brief Number of pushes.
+  std::atomic<std::uint64_t> n_pushes{0};
+
+  /// @brief Sum of the depths after each push.
+  std::atomic<std::uint64_t> depth_sum{0};
+
+  /// @brief Maximum depth.
+  std::atomic<std::size_t> max_depth{0};
+
+  /// @brief Number of pushes which waited.
+  std::atomic<std::uint64_t> n_full{0};
+
+  /// @brief Number of pops which waited.
+  std::atomic<std::uint64_t> n_empty{0};
+
+};  // class Bounded_Queue
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // BOUNDED_QUEUE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
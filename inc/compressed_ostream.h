@@ -0,0 +1,216 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef COMPRESSED_OSTREAM_H
+#define COMPRESSED_OSTREAM_H
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Compression method and level (as given via --compress).
+struct Compression {
+  /// @brief Supported compression methods.
+  enum class Method { NONE, GZIP, ZSTD };
+
+  Method method = Method::NONE;  ///< The compression method
+  int level = DEFAULT_LEVEL;     ///< The compression level
+
+  /// @brief Selects the default level of the method.
+  static constexpr int DEFAULT_LEVEL = -1;
+
+  /// @brief Parses "gzip", "zstd", "gzip:<level>" or "zstd:<level>".
+  /// @return The compression or nothing if spec is invalid.
+  static std::optional<Compression> parse(const std::string &spec);
+
+  /// @brief Returns true if support for the method is compiled in.
+  static bool is_supported(Method method);
+};
+
+/// @brief Stream buffer which compresses all data on a background thread.
+/// @details
+///   The data is collected in chunks. A full chunk (or a flush) hands the
+///   chunk over to the compression thread, which compresses it and
+///   writes the result to the sink. The writing thread only waits if
+///   the compression thread falls behind by more than MAX_PENDING_CHUNKS.
+///   With sync_flush, a flush also flushes the compressor (gzip
+///   Z_SYNC_FLUSH, zstd ZSTD_e_flush) and the sink, so a reader of the
+///   sink can decompress everything written so far (used by --stream).
+///   close() finishes the compressed stream; errors of the compression
+///   thread are reported by close() via std::runtime_error.
+class Compressing_Buffer : public std::streambuf {
+ public:
+  /// @brief Size of a chunk.
+  static constexpr std::size_t CHUNK_SIZE = 1U << 20U;
+
+  /// @brief Number of chunks which may wait for compression.
+  static constexpr std::size_t MAX_PENDING_CHUNKS = 8;
+
+  /// @brief Starts the compression thread.
+  /// @param sink The compressed data is written to this stream.
+  /// @param compression Method and level.
+  /// @param sync_flush If true, a flush makes all data decompressible.
+  Compressing_Buffer(std::ostream &sink, const Compression &compression,
+                     bool sync_flush = false);
+
+  /// @brief Copy ctor: not implemented!
+  Compressing_Buffer(const Compressing_Buffer &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Compressing_Buffer &operator=(const Compressing_Buffer &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Compressing_Buffer(Compressing_Buffer &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Compressing_Buffer &operator=(Compressing_Buffer &&rhs) = delete;
+
+  /// @brief Closes the buffer (errors are ignored, use close() to get them).
+  ~Compressing_Buffer() override;
+
+  /// @brief Compresses the remaining data and finishes the stream.
+  void close();
+
+  /// @brief Interface of the compression back-ends.
+  class Compressor {
+   public:
+    Compressor() = default;
+    Compressor(const Compressor &other) = delete;
+    Compressor &operator=(const Compressor &rhs) = delete;
+    Compressor(Compressor &&rhs) = delete;
+    Compressor &operator=(Compressor &&rhs) = delete;
+    virtual ~Compressor() = default;
+
+    /// @brief What compress() does after the data.
+    enum class Mode {
+      CONTINUE,  ///< Keeps data back for a better ratio
+      FLUSH,     ///< Outputs all data, the stream stays open
+      FINISH     ///< Finishes the compressed stream
+    };
+
+    /// @brief Compresses data and appends the output to out.
+    virtual void compress(const char *data, std::size_t size, Mode mode,
+                          std::string *out) = 0;
+  };
+
+ protected:
+  /// @brief Hands the full chunk over and continues with a new one.
+  int_type overflow(int_type ch) override;
+
+  /// @brief Hands the current chunk over to the compression thread.
+  int sync() override;
+
+ private:
+  /// @brief A chunk of uncompressed data.
+  struct Chunk {
+    std::vector<char> data;  ///< Storage (CHUNK_SIZE bytes)
+    std::size_t size;        ///< Number of used bytes
+    Compressor::Mode mode;   ///< FINISH for the last chunk of the stream
+  };
+
+  /// @brief Passes the current chunk to the compression thread.
+  void hand_over(Compressor::Mode mode);
+
+  /// @brief Threading method: compresses and writes all chunks.
+  void compress_loop();
+
+  /// @brief Output stream of the compressed data.
+  std::ostream &sink;
+
+  /// @brief The compression back-end.
+  std::unique_ptr<Compressor> compressor;
+
+  /// @brief The chunk which is currently filled.
+  std::vector<char> current;
+
+  /// @brief Chunks waiting for compression.
+  std::deque<Chunk> pending;
+
+  /// @brief Compressed chunks, kept for re-use.
+  std::vector<std::vector<char>> free_chunks;
+
+  /// @brief Protects pending, free_chunks and error.
+  std::mutex queue_mutex;
+
+  /// @brief Signals changes of pending.
+  std::condition_variable queue_condition;
+
+  /// @brief Error message of the compression thread (empty if none).
+  std::string error;
+
+  /// @brief Flushes the compressor at each sync().
+  const bool sync_flush;
+
+  /// @brief True after close().
+  bool closed;
+
+  /// @brief The compression thread.
+  std::thread worker;
+
+};  // class Compressing_Buffer
+
+/// @brief Output stream which compresses all data (see Compressing_Buffer).
+class Compressed_Ostream : public std::ostream {
+ public:
+  /// @brief Ctor
+  /// @param sink The compressed data is written to this stream.
+  /// @param compression Method and level.
+  /// @param sync_flush If true, a flush makes all data decompressible.
+  Compressed_Ostream(std::ostream &sink, const Compression &compression,
+                     bool sync_flush = false);
+
+  /// @brief Copy ctor: not implemented!
+  Compressed_Ostream(const Compressed_Ostream &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Compressed_Ostream &operator=(const Compressed_Ostream &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Compressed_Ostream(Compressed_Ostream &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Compressed_Ostream &operator=(Compressed_Ostream &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Compressed_Ostream() override = default;
+
+  /// @brief Finishes the compressed stream (see Compressing_Buffer::close).
+  void close();
+
+ private:
+  /// @brief The compressing stream buffer.
+  Compressing_Buffer buffer;
+
+};  // class Compressed_Ostream
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // COMPRESSED_OSTREAM_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
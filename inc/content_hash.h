@@ -0,0 +1,42 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Returns the 64-bit hash of data (XXH64 algorithm).
+/// @details
+///   XXH64 processes 32 bytes per step in four independent lanes, which
+///   keeps the CPU pipelines busy; hashing is much cheaper than scanning
+///   the data with the statement regexes. The result equals the one of
+///   the reference implementation on little-endian machines.
+std::uint64_t content_hash(const void *data, std::size_t size,
+                           std::uint64_t seed = 0);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // CONTENT_HASH_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,101 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "graph.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Read-only snapshot of a Graph in compressed sparse row layout.
+/// @details
+///   The out-edges of vertex v are the edges get_first_edge(v) to
+///   get_end_edge(v) - 1, in the order of the Graph's out-edge lists.
+///   All targets (and lines) are stored in one array, so analyses
+///   walk contiguous memory instead of the list nodes of the Graph.
+class Csr_Graph {
+ public:
+  /// @brief Takes a snapshot of graph.
+  explicit Csr_Graph(const Graph &graph);
+
+  /// @brief Copy ctor: not implemented!
+  Csr_Graph(const Csr_Graph &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Csr_Graph &operator=(const Csr_Graph &rhs) = delete;
+
+  /// @brief Default move constructor.
+  Csr_Graph(Csr_Graph &&rhs) = default;
+
+  /// @brief Default move assignment operator.
+  Csr_Graph &operator=(Csr_Graph &&rhs) = default;
+
+  /// @brief Default dtor
+  ~Csr_Graph() = default;
+
+  /// @brief Returns the graph with all edges reversed.
+  /// @details The in-edges of each vertex are ordered by source.
+  Csr_Graph reversed() const;
+
+  /// @brief Returns the number of vertices.
+  Vertex_Id get_n_vertices() const {
+    return static_cast<Vertex_Id>(first.size() - 1);
+  }
+
+  /// @brief Returns the number of edges.
+  std::size_t get_n_edges() const { return targets.size(); }
+
+  /// @brief Returns the first out-edge of v.
+  std::size_t get_first_edge(Vertex_Id v) const { return first[v]; }
+
+  /// @brief Returns the end of the out-edges of v.
+  std::size_t get_end_edge(Vertex_Id v) const { return first[v + 1]; }
+
+  /// @brief Returns the target of edge e.
+  Vertex_Id get_target(std::size_t e) const { return targets[e]; }
+
+  /// @brief Returns the line of edge e (see Edge::line).
+  int get_line(std::size_t e) const { return lines[e]; }
+
+ private:
+  /// @brief Creates an empty graph.
+  Csr_Graph() = default;
+
+  /// @brief Index of the first out-edge of each vertex (plus end).
+  std::vector<std::size_t> first;
+
+  /// @brief Target of each edge.
+  std::vector<Vertex_Id> targets;
+
+  /// @brief Line of each edge.
+  std::vector<int> lines;
+
+};  // class Csr_Graph
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // CSR_GRAPH_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,60 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <cstddef>
+#include <vector>
+
+#include "csr_graph.h"
+#include "scc.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief An include cycle.
+struct Include_Cycle {
+  /// @brief The vertices of the cycle, the last one includes the first one.
+  std::vector<Vertex_Id> vertices;
+
+  /// @brief lines[i] is the line of the edge from vertices[i] to the next.
+  std::vector<int> lines;
+
+  /// @brief Number of vertices of the strongly connected component which
+  ///        contains the cycle (all of them are part of some cycle).
+  std::size_t component_size = 0;
+};
+
+/// @brief Returns one shortest cycle per cyclic strongly connected
+///        component.
+/// @details
+///   Each component with more than one vertex (or with a self-include)
+///   contains at least one cycle; the reported cycle starts at the
+///   component's vertex with the lowest id and is found by a breadth-first
+///   search which stays within the component. The total runtime is
+///   O(V + E). The cycles are ordered by their first vertex.
+std::vector<Include_Cycle> find_cycles(const Csr_Graph &graph,
+                                       const Strong_Components &components);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // CYCLES_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
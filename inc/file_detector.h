@@ -26,7 +26,8 @@
 
 #include <boost/regex.hpp>
 
-#include "input_files.h"
+#include "shard.h"
+#include "solver.h"
 
 namespace INCLUDE_GARDENER {
 
@@ -35,8 +36,13 @@ namespace INCLUDE_GARDENER {
 ///   A regular expression is provided to define the search pattern.
 ///   In addition, a list of regular expressions can be given to define,
 ///   which files shall be excluded.
+///   A vertex is added for each file. Unlike an Input_Files, the walk
+///   doesn't keep a list of paths, but the vertex ids of the input files
+///   (see take_ids): the paths are stored in the vertex table anyway.
+///   With a shard (see set_shard), only the files of the shard are input
+///   files.
 /// @author feddischson
-class File_Detector : public Input_Files {
+class File_Detector {
  public:
   /// @brief Ctor: Initializes all members.
   /// @param file_regex The regex which defines the input files
@@ -61,7 +67,7 @@ class File_Detector : public Input_Files {
   File_Detector &operator=(File_Detector &&rhs) = delete;
 
   /// @brief Default dtor
-  ~File_Detector() override = default;
+  ~File_Detector() = default;
 
   /// @brief Returns exlcude regex list
   std::vector<boost::regex> get_exclude_regex();
@@ -69,8 +75,28 @@ class File_Detector : public Input_Files {
   /// @brief Returns true if the file shall be considered, otherwise false.
   bool use_file(const std::string &file) const;
 
-  /// @brief Puts all input files in the private storage files.
-  void get(Solver::Ptr solver) override;
+  /// @brief Adds a vertex for each file and keeps the ids of the input
+  ///        files.
+  void get(Solver::Ptr solver);
+
+  /// @brief Moves the vertex ids of the input files out (see get).
+  std::vector<Vertex_Id> take_ids();
+
+  /// @brief Returns the name which the walk gives to a file.
+  /// @details
+  ///   The name is the path of the file relative to the first process path
+  ///   which contains it. If no process path contains the file, the
+  ///   (absolute) path itself is returned.
+  /// @param process_paths Paths of the base directories.
+  /// @param abs_path The canonical path of the file.
+  static std::string get_name(const std::vector<std::string> &process_paths,
+                              const std::string &abs_path);
+
+  /// @brief Selects a part of the files (must be called before get).
+  void set_shard(const Shard &shard) { this->shard = shard; }
+
+  /// @brief Returns the number of files of other shards.
+  std::size_t get_n_other_shards() const { return n_other_shards; }
 
  private:
   /// @brief  Runs through a given file path and proceedes all include files.
@@ -101,6 +127,15 @@ class File_Detector : public Input_Files {
   /// @brief Limit for the recursive file search.
   const int recursive_limit;
 
+  /// @brief The selected part of the files.
+  Shard shard;
+
+  /// @brief Number of files of other shards.
+  std::size_t n_other_shards;
+
+  /// @brief Vertex ids of the input files.
+  std::vector<Vertex_Id> file_ids;
+
 };  // class File_Detector
 
 }  // namespace INCLUDE_GARDENER
@@ -0,0 +1,77 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef GARDENER_LOG_H
+#define GARDENER_LOG_H
+
+#include <iostream>
+
+#include <boost/log/trivial.hpp>
+
+/// @brief Minimum severity of the log statements which are compiled in.
+/// @details
+///   The value of a boost::log::trivial::severity_level (0 = trace,
+///   1 = debug, 2 = info, ...), set via the CMake cache variable
+///   GARDENER_MIN_LOG_LEVEL. Statements below it are removed at compile
+///   time: neither the filter of the logging core is checked nor are
+///   the streamed arguments evaluated.
+#ifndef GARDENER_MIN_LOG_LEVEL
+#define GARDENER_MIN_LOG_LEVEL 0
+#endif
+
+/// @brief Like BOOST_LOG_TRIVIAL(severity), but removed at compile time
+///        if severity is below min_level.
+#define GARDENER_LOG_MIN(severity, min_level)                             \
+  if constexpr (static_cast<int>(::boost::log::trivial::severity) <       \
+                static_cast<int>(min_level)) {                            \
+  } else                                                                  \
+    BOOST_LOG_TRIVIAL(severity)
+
+/// @brief Log statement for hot paths, removed at compile time if
+///        severity is below GARDENER_MIN_LOG_LEVEL.
+#define GARDENER_LOG(severity) \
+  GARDENER_LOG_MIN(severity, GARDENER_MIN_LOG_LEVEL)
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Set-up of the log sink.
+class Logging {
+ public:
+  /// @brief Number of log records which may wait for the sink thread.
+  static constexpr unsigned int MAX_PENDING_RECORDS = 4096;
+
+  /// @brief Adds a sink which writes all records to os.
+  /// @details
+  ///   With async, the records are formatted and written by a background
+  ///   thread; a logging thread only waits if more than
+  ///   MAX_PENDING_RECORDS are pending. The remaining records are written
+  ///   by shutdown(), which is also registered via std::atexit.
+  ///   A sink added by a previous init() call is removed.
+  static void init(bool async = true, std::ostream &os = std::clog);
+
+  /// @brief Writes all pending records and removes the sink.
+  static void shutdown();
+};
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // GARDENER_LOG_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -25,7 +25,6 @@
 #include <string>
 
 #include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/labeled_graph.hpp>
 
 #include "vertex.h"
 
@@ -39,16 +38,17 @@ struct Edge {
   Edge() = default;
   explicit Edge(int l) : line(l) {}
   int line = START_LINE;  ///< The line number where
-};                        ///  the include statement is defined.
+                          ///  the include statement is defined.
+  unsigned int count = 1;  ///< Number of statements (in the source file)
+};                         ///  which result in this edge.
 
 /// @brief Graph definition.
+/// @details
+///   Vertices carry no properties: a vertex descriptor is the
+///   Vertex_Id of the vertex in the solver's Vertex_Table.
 /// @author feddischson
-using Graph_ = boost::adjacency_list<boost::listS, boost::vecS,
-                                     boost::directedS, Vertex::Ptr, Edge>;
-
-/// @brief Labeled-graph definition
-/// @author feddischson
-using Graph = boost::labeled_graph<Graph_, std::string>;
+using Graph = boost::adjacency_list<boost::listS, boost::vecS,
+                                    boost::directedS, boost::no_property, Edge>;
 
 /// @brief Aliases for handling vertices and edges of a graph
 /// @author feddischson
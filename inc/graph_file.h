@@ -0,0 +1,187 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "graph.h"
+#include "mapped_file.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Header of the binary graph format.
+/// @details
+///   The binary format is designed to be memory-mapped and queried
+///   without deserialization. All integers are stored in host byte order
+///   (checked via the endian field), all sections start at 8-byte aligned
+///   offsets (relative to the beginning of the file):
+///
+///   | Section        | Type                      | Entries         |
+///   |----------------|---------------------------|-----------------|
+///   | string offsets | uint64_t                  | n_strings + 1   |
+///   | string data    | char                      | (concatenated)  |
+///   | vertices       | Graph_File_Vertex         | n_vertices      |
+///   | key index      | uint32_t (vertex ids)     | n_vertices      |
+///   | rows (CSR)     | uint64_t                  | n_vertices + 1  |
+///   | targets (CSR)  | uint32_t (vertex ids)     | n_edges         |
+///   | lines          | int32_t                   | n_edges         |
+///   | counts         | uint32_t                  | n_edges         |
+///
+///   The out-edges of vertex v are the edges rows[v] ... rows[v+1]-1.
+///   The key index lists the vertex ids sorted by their key
+///   (absolute path, or name if no absolute path exists).
+struct Graph_File_Header {
+  char magic[8];                ///< GRAPH_FILE_MAGIC
+  std::uint32_t version;        ///< GRAPH_FILE_VERSION
+  std::uint32_t endian;         ///< GRAPH_FILE_ENDIAN
+  std::uint64_t n_vertices;     ///< Number of vertices
+  std::uint64_t n_edges;        ///< Number of edges
+  std::uint64_t n_strings;      ///< Number of strings
+  std::uint64_t string_offsets; ///< Offset of the string offsets section
+  std::uint64_t string_data;    ///< Offset of the string data section
+  std::uint64_t vertices;       ///< Offset of the vertices section
+  std::uint64_t key_index;      ///< Offset of the key index section
+  std::uint64_t rows;           ///< Offset of the rows section
+  std::uint64_t targets;        ///< Offset of the targets section
+  std::uint64_t lines;          ///< Offset of the lines section
+  std::uint64_t counts;         ///< Offset of the counts section
+  std::uint64_t file_size;      ///< Size of the whole file
+};
+
+/// @brief Vertex record of the binary graph format.
+struct Graph_File_Vertex {
+  std::uint32_t name;      ///< String index of the name
+  std::uint32_t abs_path;  ///< String index of the abs. path or NO_STRING
+};
+
+/// @brief Magic bytes at the beginning of a binary graph file.
+static constexpr char GRAPH_FILE_MAGIC[8] = {'I', 'G', 'G', 'R',
+                                             'A', 'P', 'H', '\0'};
+
+/// @brief Current version of the binary graph format.
+static constexpr std::uint32_t GRAPH_FILE_VERSION = 1;
+
+/// @brief Used to detect files written on a host with other byte order.
+static constexpr std::uint32_t GRAPH_FILE_ENDIAN = 0x01020304;
+
+/// @brief Marks a missing string (e.g. no absolute path).
+static constexpr std::uint32_t NO_STRING = 0xffffffff;
+
+/// @brief Writes graph and vertexes in the binary graph format to os.
+void write_graph_file(std::ostream &os, const Graph &graph,
+                      const Vertex_Table &vertexes);
+
+/// @brief Read-only access to a binary graph file.
+/// @details
+///   The file is memory-mapped (see Mapped_File), all accessors work
+///   directly on the mapped data. Errors (missing file, bad magic, unsupported version,
+///   truncated file) are reported via std::runtime_error.
+class Graph_File {
+ public:
+  /// @brief Maps the file at path.
+  explicit Graph_File(const std::string &path);
+
+  /// @brief Copy ctor: not implemented!
+  Graph_File(const Graph_File &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Graph_File &operator=(const Graph_File &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Graph_File(Graph_File &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Graph_File &operator=(Graph_File &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Graph_File() = default;
+
+  /// @brief Returns the number of vertices.
+  std::uint64_t get_n_vertices() const;
+
+  /// @brief Returns the number of edges.
+  std::uint64_t get_n_edges() const;
+
+  /// @brief Returns the name of vertex v.
+  std::string_view get_name(Vertex_Id v) const;
+
+  /// @brief Returns the absolute path of vertex v (empty if unresolved).
+  std::string_view get_abs_path(Vertex_Id v) const;
+
+  /// @brief Returns the key (abs. path or name) of vertex v.
+  std::string_view get_key(Vertex_Id v) const;
+
+  /// @brief Returns the vertex with the given key (binary search),
+  ///        or NO_VERTEX.
+  Vertex_Id find(std::string_view key) const;
+
+  /// @brief Returns the index of the first out-edge of v.
+  std::uint64_t get_first_edge(Vertex_Id v) const;
+
+  /// @brief Returns the index behind the last out-edge of v.
+  std::uint64_t get_end_edge(Vertex_Id v) const;
+
+  /// @brief Returns the target vertex of edge e.
+  Vertex_Id get_target(std::uint64_t e) const;
+
+  /// @brief Returns the line number of edge e.
+  int get_line(std::uint64_t e) const;
+
+  /// @brief Returns the number of statements which result in edge e.
+  unsigned int get_count(std::uint64_t e) const;
+
+ private:
+  /// @brief Returns the string with index idx.
+  std::string_view get_string(std::uint32_t idx) const;
+
+  /// @brief Returns a typed pointer to a section.
+  template <class T>
+  const T *section(std::uint64_t offset) const {
+    return reinterpret_cast<const T *>(data + offset);
+  }
+
+  /// @brief Checks the header and all section bounds.
+  void validate(const std::string &path) const;
+
+  /// @brief The mapped file.
+  Mapped_File file;
+
+  /// @brief Start of the mapped file.
+  const char *data;
+
+  /// @brief Size of the mapped file.
+  std::size_t size;
+
+  /// @brief Header (points into the mapped file).
+  const Graph_File_Header *header;
+
+};  // class Graph_File
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // GRAPH_FILE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,123 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef GRAPH_MERGER_H
+#define GRAPH_MERGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Combines several graph files into one graph.
+/// @details
+///   The inputs are binary graph files (see Graph_File) or GraphML files
+///   (the format is detected by the content). Vertices are unified by
+///   their key (the absolute path or, if there is none, the name; GraphML
+///   written by this tool has names only) and keep the order of their
+///   first appearance. Edges with the same source and target are merged
+///   into one edge with the smallest line and the largest count.
+///
+///   The inputs are memory-mapped and never loaded as a whole:
+///    1. The vertices of up to n_threads inputs are read in parallel and
+///       added to the vertex table (in input order). Each input keeps
+///       only the mapping of its vertices to the merged ones.
+///    2. n_threads threads read the edges of the inputs, translate them
+///       to merged vertex ids and write them as sorted runs (of up to
+///       run_size edges) to temporary files.
+///    3. The runs are merged (k-way), duplicates are removed and the
+///       edges are added to the merged graph.
+///   So besides the merged graph, at most n_threads runs are kept in
+///   memory.
+class Graph_Merger {
+ public:
+  /// @brief Default number of edges per sorted run (16 bytes per edge).
+  static constexpr std::size_t RUN_SIZE = 1U << 22U;
+
+  /// @brief Ctor
+  /// @param n_threads Number of threads which read and sort the inputs.
+  /// @param run_size Maximum number of edges of a sorted run.
+  explicit Graph_Merger(unsigned int n_threads = 1,
+                        std::size_t run_size = RUN_SIZE);
+
+  /// @brief Copy ctor: not implemented!
+  Graph_Merger(const Graph_Merger &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Graph_Merger &operator=(const Graph_Merger &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Graph_Merger(Graph_Merger &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Graph_Merger &operator=(Graph_Merger &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Graph_Merger() = default;
+
+  /// @brief Merges the given graph files into the graph (call it once).
+  /// @throws std::runtime_error if a file can't be read or parsed.
+  void merge(const std::vector<std::string> &paths);
+
+  /// @brief Returns the merged graph.
+  const Graph &get_graph() const { return graph; }
+
+  /// @brief Returns the vertex table of the merged graph.
+  const Vertex_Table &get_vertexes() const { return vertexes; }
+
+  /// @brief Returns the number of sorted runs of the last merge().
+  std::size_t get_n_runs() const { return n_runs; }
+
+  /// @brief An edge with merged vertex ids (the record of a run).
+  struct Merge_Edge {
+    std::uint32_t src;    ///< Source vertex
+    std::uint32_t dst;    ///< Target vertex
+    std::int32_t line;    ///< Line of the statement
+    std::uint32_t count;  ///< Number of statements
+  };
+
+ private:
+  /// @brief Number of threads which read and sort the inputs.
+  const unsigned int n_threads;
+
+  /// @brief Maximum number of edges of a sorted run.
+  const std::size_t run_size;
+
+  /// @brief The merged graph.
+  Graph graph;
+
+  /// @brief Vertices of the merged graph.
+  Vertex_Table vertexes;
+
+  /// @brief Number of sorted runs.
+  std::size_t n_runs;
+
+};  // class Graph_Merger
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // GRAPH_MERGER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
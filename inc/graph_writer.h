@@ -0,0 +1,123 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef GRAPH_WRITER_H
+#define GRAPH_WRITER_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "graph.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Serializes a graph as dot or GraphML text.
+/// @details
+///   The output is byte-identical to boost::write_graphviz (with the
+///   Vertex_Writer / Edge_Writer of graph.h) and boost::write_graphml
+///   (with the properties "line" and "name"), but the text is produced
+///   directly from the Graph and the Vertex_Table into one large buffer.
+///   Names are appended from the Path_Table without temporary strings.
+///   The buffer is handed to the stream only when it is full, so file
+///   streams see a few large writes instead of one per token.
+class Graph_Writer {
+ public:
+  /// @brief Default size of the output buffer.
+  static constexpr std::size_t DEFAULT_BUFFER_SIZE = 1U << 20U;
+
+  /// @brief Ctor
+  /// @param graph The graph to write.
+  /// @param vertexes The vertex table of the graph.
+  /// @param buffer_size Number of bytes which are collected before writing.
+  Graph_Writer(const Graph &graph, const Vertex_Table &vertexes,
+               std::size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+  /// @brief Copy ctor: not implemented!
+  Graph_Writer(const Graph_Writer &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Graph_Writer &operator=(const Graph_Writer &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Graph_Writer(Graph_Writer &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Graph_Writer &operator=(Graph_Writer &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Graph_Writer() = default;
+
+  /// @brief Writes the graph in dot format.
+  void write_dot(std::ostream &os);
+
+  /// @brief Writes the graph in GraphML format.
+  void write_graphml(std::ostream &os);
+
+  /// @brief Writes the graph as newline-delimited JSON.
+  /// @details
+  ///   The records are the same as the ones of Ndjson_Stream: first all
+  ///   vertices, then all edges.
+  void write_ndjson(std::ostream &os);
+
+ private:
+  /// @brief Writes the buffer to os if it is (nearly) full.
+  void flush_if_full(std::ostream &os);
+
+  /// @brief Writes the buffer to os and clears it.
+  void flush(std::ostream &os);
+
+  /// @brief Appends a decimal number to the buffer.
+  template <class T>
+  void append_number(T value);
+
+  /// @brief Appends the name of v, XML-encoded like
+  ///        boost::property_tree::xml_parser::encode_char_entities.
+  void append_xml_name(Vertex_Id v);
+
+  /// @brief The graph to write.
+  const Graph &graph;
+
+  /// @brief The vertex table of the graph.
+  const Vertex_Table &vertexes;
+
+  /// @brief Number of bytes which are collected before writing.
+  const std::size_t buffer_size;
+
+  /// @brief Output buffer (re-used for all writes).
+  std::string buffer;
+
+};  // class Graph_Writer
+
+/// @brief Writes a graph in the given format.
+/// @param format Either "dot", "xml"/"graphml", "ndjson" or "bin"
+///               (see Graph_File); other formats are ignored.
+/// @param graph The graph to write.
+/// @param vertexes The vertex table of the graph.
+/// @param os Output stream
+void write_graph(const std::string &format, const Graph &graph,
+                 const Vertex_Table &vertexes, std::ostream &os);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // GRAPH_WRITER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -22,6 +22,9 @@
 #define HELPER_H
 
 //#include <regex>
+#include <cstddef>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include <boost/regex.hpp>
@@ -32,6 +35,15 @@ namespace INCLUDE_GARDENER {
 std::vector<boost::regex> init_regex_vector(
     const std::vector<std::string> &string_vector);
 
+/// @brief Reads a whole file into content.
+/// @return False if the file can't be read.
+bool read_file(const std::string &path, std::string *content);
+
+/// @brief Parses a size in bytes with an optional suffix K, M or G
+///        (factor 1024, 1024^2, 1024^3), e.g. "512M".
+/// @return The size or nothing if spec is invalid.
+std::optional<std::size_t> parse_size(const std::string &spec);
+
 }  // namespace INCLUDE_GARDENER
 
 #endif  // HELPER_H
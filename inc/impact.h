@@ -0,0 +1,47 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef IMPACT_H
+#define IMPACT_H
+
+#include <vector>
+
+#include "csr_graph.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Returns all vertices which (transitively) include one of the
+///        changed vertices, and the changed vertices themselves.
+/// @details
+///   Multi-source breadth-first search over the reversed graph: all
+///   changed vertices form the first frontier, each vertex is visited
+///   once, so the runtime is O(V + E) independent of the number of
+///   changed vertices.
+/// @param reverse The reversed include graph (see Csr_Graph::reversed).
+/// @param changed The changed vertices (duplicates are allowed).
+/// @return The affected vertices, ascending.
+std::vector<Vertex_Id> find_affected(const Csr_Graph &reverse,
+                                     const std::vector<Vertex_Id> &changed);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // IMPACT_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,108 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef INCLUDE_COST_H
+#define INCLUDE_COST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "transitive_closure.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Include cost of a translation unit.
+struct Unit_Cost {
+  Vertex_Id unit;         ///< The translation unit
+  std::uint64_t bytes;    ///< Bytes of the unit and all included files
+  std::uint64_t lines;    ///< Lines of the unit and all included files
+  std::size_t n_headers;  ///< Number of (transitively) included files
+};
+
+/// @brief Contribution of a header to all translation units.
+struct Header_Cost {
+  Vertex_Id header;     ///< The header
+  std::size_t n_units;  ///< Number of units which include it
+  std::uint64_t bytes;  ///< n_units * bytes of the header
+  std::uint64_t lines;  ///< n_units * lines of the header
+};
+
+/// @brief Sums the file sizes over the transitive includes of each
+///        translation unit.
+/// @details
+///   The translation units are given (see Solver::get_unit_regex). The
+///   cost of a unit is the size of the unit plus the sizes of all files
+///   which are reachable from it (see Transitive_Closure), each counted
+///   once. The sizes are taken from the Vertex_Table (see File_Size);
+///   files which were not scanned (e.g. unresolved includes) count zero
+///   bytes.
+///   The units are distributed over n_threads threads; each thread
+///   counts the units per header, the counts are summed afterwards.
+class Include_Cost {
+ public:
+  /// @brief Computes the costs.
+  /// @param graph The include graph.
+  /// @param closure The transitive closure of graph.
+  /// @param vertexes The vertex table (with the file sizes).
+  /// @param unit_ids The translation units.
+  /// @param n_threads Number of threads which compute the costs.
+  Include_Cost(const Csr_Graph &graph, const Transitive_Closure &closure,
+               const Vertex_Table &vertexes,
+               const std::vector<Vertex_Id> &unit_ids,
+               unsigned int n_threads);
+
+  /// @brief Copy ctor: not implemented!
+  Include_Cost(const Include_Cost &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Include_Cost &operator=(const Include_Cost &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Include_Cost(Include_Cost &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Include_Cost &operator=(Include_Cost &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Include_Cost() = default;
+
+  /// @brief Returns all translation units, the most expensive first.
+  const std::vector<Unit_Cost> &get_units() const { return units; }
+
+  /// @brief Returns all included files, the largest contribution first.
+  const std::vector<Header_Cost> &get_headers() const { return headers; }
+
+ private:
+  /// @brief Costs of the translation units.
+  std::vector<Unit_Cost> units;
+
+  /// @brief Contributions of the included files.
+  std::vector<Header_Cost> headers;
+
+};  // class Include_Cost
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // INCLUDE_COST_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,208 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef INCLUDE_GARDENER_H
+#define INCLUDE_GARDENER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "shard.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+class Solver;
+
+/// @brief Inputs and options of an analysis (see analyze()).
+struct Analysis_Options {
+  std::string language = "c";              ///< c, py or ruby
+  std::vector<std::string> process_paths;  ///< Files / directories to scan
+  std::vector<std::string> include_paths;  ///< Include paths (c, ruby)
+  std::vector<std::string> exclude;        ///< Regexes of excluded files
+  int recursive_limit = -1;                ///< -1: unlimited
+  int n_threads = 1;                       ///< Scan threads (-1: adaptive)
+  std::string cache_file;                  ///< Scan cache (empty: none)
+  std::size_t queue_capacity = 0;          ///< Queued files (0: unbounded)
+  std::size_t max_memory = 0;              ///< Resident bytes (0: no limit)
+  unsigned int uring_depth = 0;            ///< io_uring depth (0: read())
+  unsigned int n_resolvers = 0;            ///< Resolve threads (0: workers)
+  Shard shard;                             ///< Scanned part of the files
+};
+
+/// @brief Read-only result of an analysis.
+/// @details
+///   The vertices and edges are accessed via iterable views, which refer
+///   to the data of the Include_Graph (no serialization). The data is kept
+///   on the heap, so the views stay valid if the Include_Graph is moved.
+///   The edges are ordered by source; the out-edges of a vertex are
+///   contiguous.
+///   The solver, which built the graph, is kept internally, so the graph
+///   can be written in one of the output formats (see write()).
+class Include_Graph {
+  /// @brief The snapshot (defined in the source file).
+  struct Data;
+
+ public:
+  /// @brief View of a vertex (valid as long as the Include_Graph).
+  struct Vertex {
+    Vertex_Id id;           ///< Index of the vertex
+    std::string_view name;  ///< Name (e.g. as written in the statement)
+    std::string_view path;  ///< Absolute path (empty if not found)
+    File_Size size;         ///< Size of the file (zero if not scanned)
+  };
+
+  /// @brief View of an edge.
+  struct Edge {
+    Vertex_Id source;  ///< The including file
+    Vertex_Id target;  ///< The included file
+    int line;          ///< Line of the statement (see Edge::line)
+  };
+
+  /// @brief Iterates over the vertices.
+  class Vertex_Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Vertex;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Vertex;
+
+    Vertex_Iterator(const Data *data, Vertex_Id id) : data(data), id(id) {}
+    Vertex operator*() const;
+    Vertex_Iterator &operator++() {
+      ++id;
+      return *this;
+    }
+    bool operator==(const Vertex_Iterator &rhs) const { return id == rhs.id; }
+    bool operator!=(const Vertex_Iterator &rhs) const { return id != rhs.id; }
+
+   private:
+    const Data *data;
+    Vertex_Id id;
+  };
+
+  /// @brief Iterates over edges (all edges or the out-edges of a vertex).
+  class Edge_Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Edge;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Edge;
+
+    Edge_Iterator(const Data *data, Vertex_Id source, std::size_t edge);
+    Edge operator*() const;
+    Edge_Iterator &operator++();
+    bool operator==(const Edge_Iterator &rhs) const {
+      return edge == rhs.edge;
+    }
+    bool operator!=(const Edge_Iterator &rhs) const {
+      return edge != rhs.edge;
+    }
+
+   private:
+    /// @brief Moves source to the source of edge.
+    void skip_sources();
+
+    const Data *data;
+    Vertex_Id source;
+    std::size_t edge;
+  };
+
+  /// @brief A pair of iterators, usable in range-based for loops.
+  template <class T>
+  struct Range {
+    T first;  ///< Begin of the range
+    T last;   ///< End of the range
+    T begin() const { return first; }
+    T end() const { return last; }
+  };
+
+  /// @brief Takes a snapshot of the graph of solver (Solver is internal,
+  ///        see analyze()).
+  explicit Include_Graph(std::shared_ptr<Solver> solver);
+
+  /// @brief Copy ctor: not implemented!
+  Include_Graph(const Include_Graph &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Include_Graph &operator=(const Include_Graph &rhs) = delete;
+
+  /// @brief Move constructor (the views of rhs stay valid).
+  Include_Graph(Include_Graph &&rhs) noexcept;
+
+  /// @brief Move assignment operator (the views of rhs stay valid).
+  Include_Graph &operator=(Include_Graph &&rhs) noexcept;
+
+  /// @brief Dtor
+  ~Include_Graph();
+
+  /// @brief Returns the number of vertices.
+  std::size_t get_n_vertices() const;
+
+  /// @brief Returns the number of edges.
+  std::size_t get_n_edges() const;
+
+  /// @brief Returns a vertex.
+  Vertex get_vertex(Vertex_Id id) const;
+
+  /// @brief Returns all vertices.
+  Range<Vertex_Iterator> vertices() const;
+
+  /// @brief Returns all edges.
+  Range<Edge_Iterator> edges() const;
+
+  /// @brief Returns the out-edges of a vertex.
+  Range<Edge_Iterator> out_edges(Vertex_Id id) const;
+
+  /// @brief Returns the vertex of a file (path or name) or NO_VERTEX.
+  Vertex_Id find(const std::string &file) const;
+
+  /// @brief Writes the graph to os.
+  /// @param format Either "dot", "xml"/"graphml", "ndjson" or "bin" (the
+  ///               formats of the command line tool).
+  void write(const std::string &format, std::ostream &os) const;
+
+  /// @brief Logs a warning for each include cycle.
+  /// @return The number of reported cycles.
+  std::size_t report_cycles() const;
+
+ private:
+  /// @brief The snapshot.
+  std::unique_ptr<const Data> data;
+
+};  // class Include_Graph
+
+/// @brief Runs the pipeline (walk, scan and resolution) with the solver
+///        given by the options.
+/// @throws std::invalid_argument if the language is not supported.
+Include_Graph analyze(const Analysis_Options &options);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // INCLUDE_GARDENER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,80 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Read-only memory mapping of a whole file.
+/// @details
+///   If the file can't be opened or mapped, or if it is empty, the
+///   mapping is empty (is_open() tells the difference).
+///   The file must not shrink while it is mapped: accessing the pages
+///   beyond its new end raises SIGBUS. So it is only used for graph
+///   files (see Graph_File and Graph_Merger); scanned sources, which may
+///   be written meanwhile, are read with read_file.
+class Mapped_File {
+ public:
+  /// @brief Maps the file.
+  explicit Mapped_File(const std::string &path);
+
+  /// @brief Copy ctor: not implemented!
+  Mapped_File(const Mapped_File &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Mapped_File &operator=(const Mapped_File &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Mapped_File(Mapped_File &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Mapped_File &operator=(Mapped_File &&rhs) = delete;
+
+  /// @brief Unmaps the file.
+  ~Mapped_File();
+
+  /// @brief Returns false if the file couldn't be read.
+  bool is_open() const { return open; }
+
+  /// @brief Returns the content of the file.
+  std::string_view get_content() const { return {data, size}; }
+
+ private:
+  /// @brief Start of the mapping (nullptr if nothing is mapped).
+  const char *data;
+
+  /// @brief Size of the mapping.
+  std::size_t size;
+
+  /// @brief True if the file was read.
+  bool open;
+
+};  // class Mapped_File
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // MAPPED_FILE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
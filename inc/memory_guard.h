@@ -0,0 +1,105 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef MEMORY_GUARD_H
+#define MEMORY_GUARD_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Checks the resident memory of the process against a limit.
+/// @details
+///   Used to throttle the scan (--max-memory): while the limit is
+///   exceeded, the files are handed over in batches of one file per
+///   worker, and the next batch only once the previous one is processed
+///   (see Statement_Detector). Once exceeded, the limit counts as
+///   exceeded until the resident memory drops below RESUME_PERCENT
+///   percent of it, so the scan doesn't toggle between both modes at
+///   every measurement.
+///   Reading the resident size costs a system call, so it is only read
+///   every CHECK_INTERVAL calls of is_exceeded(); the result is kept in
+///   between.
+class Memory_Guard {
+ public:
+  /// @brief Number of is_exceeded() calls which share one measurement.
+  static constexpr unsigned int CHECK_INTERVAL = 64;
+
+  /// @brief Percentage of the limit below which the throttling ends.
+  static constexpr std::size_t RESUME_PERCENT = 90;
+
+  /// @brief Ctor
+  /// @param max_bytes Limit of the resident memory (0: no limit).
+  explicit Memory_Guard(std::size_t max_bytes = 0);
+
+  /// @brief Copy ctor: not implemented!
+  Memory_Guard(const Memory_Guard &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Memory_Guard &operator=(const Memory_Guard &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Memory_Guard(Memory_Guard &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Memory_Guard &operator=(Memory_Guard &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Memory_Guard() = default;
+
+  /// @brief Returns the resident memory of the process in bytes
+  ///        (0 if it is unknown).
+  static std::size_t get_rss();
+
+  /// @brief Returns true if the resident memory exceeds the limit (or,
+  ///        after it was exceeded, the resume threshold).
+  /// @details
+  ///   Before reporting an exceeded limit, the memory which was freed
+  ///   but kept by the allocator is returned to the system.
+  bool is_exceeded();
+
+  /// @brief Same as is_exceeded(), but always measures the resident
+  ///        memory.
+  bool check();
+
+  /// @brief Returns the limit (0: no limit).
+  std::size_t get_max_bytes() const { return max_bytes; }
+
+ private:
+  /// @brief Limit of the resident memory (0: no limit).
+  const std::size_t max_bytes;
+
+  /// @brief Threshold below which an exceeded limit is released.
+  const std::size_t resume_bytes;
+
+  /// @brief Number of is_exceeded() calls.
+  std::atomic<unsigned int> n_calls;
+
+  /// @brief Result of the last measurement.
+  std::atomic<bool> exceeded;
+
+};  // class Memory_Guard
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // MEMORY_GUARD_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
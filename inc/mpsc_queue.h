@@ -0,0 +1,104 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Unbounded lock-free queue for many producers and one consumer.
+/// @details
+///   Linked list with a stub node (D. Vyukov's MPSC queue): push() is one
+///   atomic exchange plus one store and never waits; pop() must only be
+///   called by a single consumer thread. The items of one producer are
+///   popped in the order in which they were pushed. A push which is still
+///   in progress can hide the items pushed after it until it completes, in
+///   this case pop() returns false although the queue is not empty.
+template <class T>
+class Mpsc_Queue {
+ public:
+  /// @brief Creates an empty queue.
+  Mpsc_Queue() : head(new Node()), tail(head.load()) {}
+
+  /// @brief Copy ctor: not implemented!
+  Mpsc_Queue(const Mpsc_Queue &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Mpsc_Queue &operator=(const Mpsc_Queue &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Mpsc_Queue(Mpsc_Queue &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Mpsc_Queue &operator=(Mpsc_Queue &&rhs) = delete;
+
+  /// @brief Deletes all remaining items.
+  ~Mpsc_Queue() {
+    while (tail != nullptr) {
+      Node *next = tail->next.load(std::memory_order_relaxed);
+      delete tail;
+      tail = next;
+    }
+  }
+
+  /// @brief Appends an item (may be called by any thread).
+  void push(T value) {
+    auto *node = new Node();
+    node->value = std::move(value);
+    Node *prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /// @brief Takes the oldest item (must only be called by one thread).
+  /// @return False if no item is available.
+  bool pop(T *value) {
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *value = std::move(next->value);
+    delete tail;
+    tail = next;
+    return true;
+  }
+
+ private:
+  /// @brief List node, the node at tail is the (already popped) stub.
+  struct Node {
+    std::atomic<Node *> next{nullptr};  ///< Next (newer) node
+    T value;                            ///< The item
+  };
+
+  /// @brief The newest node (modified by the producers).
+  std::atomic<Node *> head;
+
+  /// @brief The stub node (modified by the consumer).
+  Node *tail;
+
+};  // class Mpsc_Queue
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // MPSC_QUEUE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
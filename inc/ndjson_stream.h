@@ -0,0 +1,146 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef NDJSON_STREAM_H
+#define NDJSON_STREAM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "mpsc_queue.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Writes vertex and edge records as newline-delimited JSON while
+///        the graph is built.
+/// @details
+///   Each record is one line:
+///
+///     {"type":"vertex","id":0,"name":"a.h","path":"/repo/a.h"}
+///     {"type":"edge","source":1,"target":0,"line":3}
+///
+///   The solver pushes a record for each new vertex and each new edge
+///   (duplicates are not reported). The records are passed through a
+///   lock-free queue to one writer thread, which formats and writes them,
+///   so the workers never wait for the output. As long as the records are
+///   pushed while the graph is locked, a vertex record is always written
+///   before the first edge record which refers to it.
+///   If the queue is empty, the writer sleeps on a condition variable;
+///   a push only takes the mutex to wake it up if it is waiting.
+class Ndjson_Stream {
+ public:
+  /// @brief Smart pointer for Ndjson_Stream
+  using Ptr = std::shared_ptr<Ndjson_Stream>;
+
+  /// @brief Starts the writer thread.
+  /// @param os The records are written to this stream.
+  explicit Ndjson_Stream(std::ostream &os);
+
+  /// @brief Copy ctor: not implemented!
+  Ndjson_Stream(const Ndjson_Stream &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Ndjson_Stream &operator=(const Ndjson_Stream &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Ndjson_Stream(Ndjson_Stream &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Ndjson_Stream &operator=(Ndjson_Stream &&rhs) = delete;
+
+  /// @brief Closes the stream.
+  ~Ndjson_Stream();
+
+  /// @brief Queues a vertex record.
+  void push_vertex(Vertex_Id id, const std::string &name,
+                   const std::string &abs_path);
+
+  /// @brief Queues an edge record.
+  void push_edge(Vertex_Id src, Vertex_Id dst, int line);
+
+  /// @brief Writes all queued records and stops the writer thread.
+  void close();
+
+  /// @brief Appends a vertex record (including the newline) to out.
+  static void append_vertex(Vertex_Id id, std::string_view name,
+                            std::string_view abs_path, std::string *out);
+
+  /// @brief Appends an edge record (including the newline) to out.
+  static void append_edge(Vertex_Id src, Vertex_Id dst, int line,
+                          std::string *out);
+
+  /// @brief Appends s as quoted and escaped JSON string to out.
+  static void append_string(std::string_view s, std::string *out);
+
+ private:
+  /// @brief A queued record.
+  struct Record {
+    bool is_edge = false;      ///< Edge or vertex record
+    Vertex_Id src = 0;         ///< Vertex id or source of the edge
+    Vertex_Id dst = 0;         ///< Target of the edge
+    int line = 0;              ///< Line of the edge
+    std::string name;          ///< Name of the vertex
+    std::string abs_path;      ///< Absolute path of the vertex
+  };
+
+  /// @brief Counts a pushed record and wakes up the writer if necessary.
+  void notify_writer();
+
+  /// @brief Threading method: writes all records.
+  void write_loop();
+
+  /// @brief Output stream.
+  std::ostream &os;
+
+  /// @brief Records which are not written yet.
+  Mpsc_Queue<Record> records;
+
+  /// @brief Set by close(), the writer stops when the queue is empty.
+  std::atomic<bool> closing;
+
+  /// @brief Number of pushed records.
+  std::atomic<std::size_t> n_pushed;
+
+  /// @brief True while the writer waits (or is about to wait) for records.
+  std::atomic<bool> writer_waiting;
+
+  /// @brief Protects the wake-up of the writer.
+  std::mutex wake_mutex;
+
+  /// @brief Notified on a push while the writer waits and by close().
+  std::condition_variable wake_condition;
+
+  /// @brief The writer thread.
+  std::thread writer;
+
+};  // class Ndjson_Stream
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // NDJSON_STREAM_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
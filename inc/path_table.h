@@ -0,0 +1,119 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Stores paths as a component-interned prefix tree.
+/// @details
+///   Every path is split at '/' into components. Each distinct component
+///   string is stored once, and each path is a node in a tree whose edges
+///   are labeled with component ids. Paths sharing a prefix therefore
+///   share the nodes of that prefix.
+///   Nodes are identified by dense indices; the node data is kept as
+///   struct-of-arrays (parent and component per node).
+///   Splitting and joining at every '/' round-trips exactly, including
+///   leading, trailing and repeated slashes.
+class Path_Table {
+ public:
+  /// @brief Node identifier.
+  using Id = std::uint32_t;
+
+  /// @brief The root node, which represents no path.
+  static constexpr Id ROOT = 0;
+
+  /// @brief Returned by find() if a path is not stored.
+  static constexpr Id NONE = std::numeric_limits<Id>::max();
+
+  /// @brief Initializes the table with the root node only.
+  Path_Table();
+
+  /// @brief Copy ctor: not implemented!
+  Path_Table(const Path_Table &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Path_Table &operator=(const Path_Table &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Path_Table(Path_Table &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Path_Table &operator=(Path_Table &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Path_Table() = default;
+
+  /// @brief Adds a path (if not yet stored) and returns its node.
+  Id insert(std::string_view path);
+
+  /// @brief Returns the node of a path or NONE if it is not stored.
+  Id find(std::string_view path) const;
+
+  /// @brief Returns the path of a node.
+  std::string get(Id id) const;
+
+  /// @brief Appends the path of a node to out (no temporary string).
+  void append(Id id, std::string *out) const;
+
+  /// @brief Returns the number of nodes (including the root node).
+  std::size_t size() const;
+
+  /// @brief Returns the number of distinct components.
+  std::size_t get_n_components() const;
+
+ private:
+  /// @brief Returns the child of parent with the given component or NONE.
+  Id find_child(Id parent, Id component) const;
+
+  /// @brief Returns the key of the children map.
+  static std::uint64_t child_key(Id parent, Id component);
+
+  /// @brief Parent node of each node.
+  std::vector<Id> parents;
+
+  /// @brief Component id of each node.
+  std::vector<Id> components;
+
+  /// @brief Interned component strings (deque: references stay valid).
+  std::deque<std::string> component_strings;
+
+  /// @brief Maps a component string to its id.
+  std::unordered_map<std::string_view, Id> component_ids;
+
+  /// @brief Maps (parent, component) to the child node.
+  std::unordered_map<std::uint64_t, Id> children;
+
+};  // class Path_Table
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // PATH_TABLE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
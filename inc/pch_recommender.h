@@ -0,0 +1,116 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef PCH_RECOMMENDER_H
+#define PCH_RECOMMENDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "include_cost.h"
+#include "transitive_closure.h"
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief A header which may be put into a precompiled header.
+struct Pch_Candidate {
+  Vertex_Id header;     ///< The header
+  std::size_t n_units;  ///< Number of units which include it
+  std::uint64_t bytes;  ///< Bytes of the header and all its includes
+  std::uint64_t score;  ///< n_units * bytes
+};
+
+/// @brief Recommends the headers of a precompiled header (PCH).
+/// @details
+///   Each header, which is included (transitively) by at least
+///   MIN_UNITS translation units, is a candidate. Its score is the
+///   number of including units times its transitive bytes (the bytes of
+///   the header and of all files it includes), i.e. roughly the bytes
+///   the compiler no longer parses if the header is precompiled.
+///   The transitive bytes are computed in parallel from the rows of the
+///   Transitive_Closure, the units per header are taken from
+///   Include_Cost.
+///
+///   The PCH is selected greedily in the order of the scores: a
+///   candidate is added if the PCH (the union of the selected headers
+///   and their includes) stays within the size budget. Candidates,
+///   which are already part of the PCH via a selected header, are
+///   skipped.
+class Pch_Recommender {
+ public:
+  /// @brief Minimum number of units which include a candidate.
+  static constexpr std::size_t MIN_UNITS = 2;
+
+  /// @brief Scores the candidates and selects the PCH.
+  /// @param closure The transitive closure of the include graph.
+  /// @param vertexes The vertex table (with the file sizes).
+  /// @param cost The include costs (units per header).
+  /// @param budget Maximum size of the PCH in bytes.
+  /// @param n_threads Number of threads which score the candidates.
+  Pch_Recommender(const Transitive_Closure &closure,
+                  const Vertex_Table &vertexes, const Include_Cost &cost,
+                  std::uint64_t budget, unsigned int n_threads);
+
+  /// @brief Copy ctor: not implemented!
+  Pch_Recommender(const Pch_Recommender &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Pch_Recommender &operator=(const Pch_Recommender &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Pch_Recommender(Pch_Recommender &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Pch_Recommender &operator=(Pch_Recommender &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Pch_Recommender() = default;
+
+  /// @brief Returns all candidates, the highest score first.
+  const std::vector<Pch_Candidate> &get_candidates() const {
+    return candidates;
+  }
+
+  /// @brief Returns the selected candidates, the highest score first.
+  const std::vector<Pch_Candidate> &get_selected() const { return selected; }
+
+  /// @brief Returns the size of the PCH (the selected headers and all
+  ///        their includes, each counted once).
+  std::uint64_t get_selected_bytes() const { return selected_bytes; }
+
+ private:
+  /// @brief All candidates.
+  std::vector<Pch_Candidate> candidates;
+
+  /// @brief The selected candidates.
+  std::vector<Pch_Candidate> selected;
+
+  /// @brief Size of the PCH.
+  std::uint64_t selected_bytes;
+
+};  // class Pch_Recommender
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // PCH_RECOMMENDER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,128 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "csr_graph.h"
+#include "solver.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Answers queries about the graph of a solver via a Unix socket.
+/// @details
+///   The graph is built once; afterwards, serve() waits with poll() on
+///   the listening socket and all connected clients, so an idle client
+///   (e.g. an editor which keeps its connection open) never blocks the
+///   others. Requests are answered one after another. A client sends
+///   requests, one per line:
+///
+///     deps <file>          files which are included by file
+///     rdeps <file>         files which include file
+///     path <from> <to>     shortest include chain from one file to another
+///     rescan <file>...     processes the files again
+///     shutdown             stops the server
+///
+///   Each reply starts with "OK" or "ERROR <message>", followed by one
+///   line per result, and ends with an empty line. Files are given and
+///   returned by their key (absolute path or, for unresolved includes,
+///   the name). In a path, each file is followed by the line of the
+///   include statement which leads to the next file ("file:line").
+class Query_Server {
+ public:
+  /// @brief Ctor
+  /// @param solver The solver, whose graph is already built.
+  /// @param n_workers Number of threads which re-scan files.
+  /// @param process_paths Base directories of the scan; new files found by
+  ///                      a rescan are named relative to them.
+  Query_Server(Solver::Ptr solver, int n_workers,
+               std::vector<std::string> process_paths = {});
+
+  /// @brief Copy ctor: not implemented!
+  Query_Server(const Query_Server &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Query_Server &operator=(const Query_Server &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Query_Server(Query_Server &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Query_Server &operator=(Query_Server &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Query_Server() = default;
+
+  /// @brief Listens on socket_path until a shutdown request is received.
+  /// @details
+  ///   An existing socket file at socket_path is replaced. Throws
+  ///   std::runtime_error if the socket can't be created. A client
+  ///   which disconnects before it reads its replies is dropped.
+  void serve(const std::string &socket_path);
+
+  /// @brief Returns the reply to one request line.
+  std::string handle(const std::string &request);
+
+  /// @brief Returns true after a shutdown request.
+  bool is_shut_down() const { return shut_down; }
+
+ private:
+  /// @brief Answers the complete requests of a readable client.
+  /// @param pending The client's received, not yet complete request line.
+  /// @return false if the client is gone.
+  bool serve_client(int fd, std::string *pending);
+
+  /// @brief Appends the key of v and a newline to reply.
+  void append_key(Vertex_Id v, std::string *reply) const;
+
+  /// @brief Returns the reversed graph (rebuilt after a rescan).
+  const Csr_Graph &get_reverse();
+
+  std::string get_dependencies(Vertex_Id v);
+  std::string get_dependents(Vertex_Id v);
+  std::string get_path(Vertex_Id from, Vertex_Id to);
+  std::string rescan(const std::vector<std::string> &files);
+
+  /// @brief The solver, which holds the graph.
+  Solver::Ptr solver;
+
+  /// @brief Number of threads which re-scan files.
+  int n_workers;
+
+  /// @brief Base directories of the scan.
+  std::vector<std::string> process_paths;
+
+  /// @brief Cached reversed graph (nullptr if outdated).
+  std::unique_ptr<Csr_Graph> reverse;
+
+  /// @brief Set by a shutdown request.
+  bool shut_down;
+
+};  // class Query_Server
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // QUERY_SERVER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,187 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief A counter which is only written by one thread.
+/// @details
+///   Increments are a plain load and store (no locked instruction), but
+///   the counter can be read by other threads at any time.
+class Thread_Counter {
+ public:
+  /// @brief Adds n to the counter.
+  void add(std::uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+  }
+
+  /// @brief Returns the current value.
+  std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+ private:
+  /// @brief The value.
+  std::atomic<std::uint64_t> value{0};
+};
+
+/// @brief A span of a thread's activity (see Trace).
+struct Trace_Event {
+  const char *name;           ///< Name of the span (a string literal)
+  std::string detail;         ///< E.g. the path of the processed file
+  std::uint64_t size;         ///< E.g. the size of the processed file
+  std::uint64_t start_ns;     ///< Start, relative to the trace start
+  std::uint64_t duration_ns;  ///< Duration
+};
+
+/// @brief Statistics of one thread (see Run_Stats).
+struct Thread_Stats {
+  unsigned int id = 0;              ///< Index of the thread
+  std::string name;                 ///< Name of the thread
+  Thread_Counter n_files;           ///< Scanned files
+  Thread_Counter n_bytes;           ///< Scanned bytes
+  Thread_Counter n_lines;           ///< Scanned lines
+  Thread_Counter n_regex_calls;     ///< regex_search invocations
+  Thread_Counter n_regex_matches;   ///< Matching regex_search invocations
+  Thread_Counter n_probes;          ///< File system probes of the solver
+  Thread_Counter n_probe_hits;      ///< Probes which found a file
+  Thread_Counter busy_ns;           ///< Time spent on jobs
+  Thread_Counter graph_wait_ns;     ///< Wait time for graph_mutex
+  Thread_Counter job_queue_wait_ns; ///< Wait time for a job
+  std::vector<Trace_Event> events;  ///< Recorded spans (see Trace)
+};
+
+/// @brief Depth statistics of a queue between two stages (see Run_Stats).
+struct Queue_Stats {
+  std::size_t capacity = 0;     ///< Capacity (0: unbounded)
+  std::uint64_t n_pushes = 0;   ///< Added entries
+  std::uint64_t depth_sum = 0;  ///< Sum of the depths after each push
+  std::size_t max_depth = 0;    ///< Maximum depth
+  std::uint64_t n_full = 0;     ///< Pushes which waited for space
+  std::uint64_t n_empty = 0;    ///< Pops which waited for an entry
+};
+
+/// @brief Run-time statistics for --stats.
+/// @details
+///   Each thread writes to its own Thread_Stats (see local()), so
+///   counting is cheap and needs no locks. The time measurements (which
+///   need clock calls) are only done if the statistics are enabled.
+///   Threads are only registered while the statistics or the Trace are
+///   enabled; the Thread_Stats of finished threads are kept for the
+///   report.
+class Run_Stats {
+ public:
+  /// @brief Clock of all time measurements.
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief Enables the time measurements.
+  static void enable();
+
+  /// @brief Disables the time measurements and the registration of
+  ///        threads and phases.
+  static void disable();
+
+  /// @brief Returns true if the statistics are enabled.
+  static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+  /// @brief Returns the statistics of the calling thread.
+  static Thread_Stats &local();
+
+  /// @brief Sets the name of the calling thread (used in the report).
+  static void set_thread_name(const std::string &name);
+
+  /// @brief Adds the duration of a phase (e.g. "walk" or "output"),
+  ///        if enabled.
+  static void add_phase(const std::string &name, Clock::duration duration);
+
+  /// @brief Adds the statistics of a queue (e.g. "resolve"), if enabled.
+  static void add_queue(const std::string &name, const Queue_Stats &stats);
+
+  /// @brief Writes the report of all phases, queues and threads.
+  static void write_report(std::ostream &os);
+
+  /// @brief Calls fn for the statistics of each thread.
+  /// @note The threads must not modify their statistics meanwhile.
+  static void for_each_thread(
+      const std::function<void(const Thread_Stats &)> &fn);
+
+  /// @brief Returns the nanoseconds since start.
+  static std::uint64_t elapsed_ns(Clock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             start)
+            .count());
+  }
+
+ private:
+  /// @brief True if enabled.
+  static std::atomic<bool> enabled;
+};
+
+/// @brief Adds the lifetime of the instance to a counter (if enabled).
+class Scoped_Timer {
+ public:
+  /// @brief Starts the measurement.
+  explicit Scoped_Timer(Thread_Counter *counter)
+      : counter(Run_Stats::is_enabled() ? counter : nullptr),
+        start(this->counter == nullptr ? Run_Stats::Clock::time_point()
+                                       : Run_Stats::Clock::now()) {}
+
+  /// @brief Copy ctor: not implemented!
+  Scoped_Timer(const Scoped_Timer &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Scoped_Timer &operator=(const Scoped_Timer &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Scoped_Timer(Scoped_Timer &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Scoped_Timer &operator=(Scoped_Timer &&rhs) = delete;
+
+  /// @brief Stops the measurement.
+  ~Scoped_Timer() {
+    if (counter != nullptr) {
+      counter->add(Run_Stats::elapsed_ns(start));
+    }
+  }
+
+ private:
+  /// @brief The counter (nullptr if disabled).
+  Thread_Counter *counter;
+
+  /// @brief Start of the measurement.
+  Run_Stats::Clock::time_point start;
+};
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // RUN_STATS_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,152 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef SCAN_CACHE_H
+#define SCAN_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "vertex.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief A statement, detected in a file.
+struct Detected_Statement {
+  std::string statement;  ///< The matched statement (passed to add_edge)
+  unsigned int idx;       ///< Index of the matching statement regex
+  unsigned int line_no;   ///< Line of the statement
+};
+
+/// @brief Persistent cache of the statements of scanned files.
+/// @details
+///   Each entry holds the statements of one file, together with the
+///   file's size, modification time and content hash. lookup() only
+///   needs a stat call if size and mtime are unchanged. If only the
+///   mtime differs (e.g. after a checkout), the content hash decides.
+///   The cache is bound to the statement regexes: a cache file, which
+///   was written with different regexes, is ignored.
+///   All methods are thread-safe.
+class Scan_Cache {
+ public:
+  /// @brief Smart pointer for Scan_Cache
+  using Ptr = std::shared_ptr<Scan_Cache>;
+
+  /// @brief Loads the cache file (if it exists and is valid).
+  /// @param cache_path Path of the cache file.
+  /// @param statement_regex The statement regexes of the solver.
+  Scan_Cache(std::string cache_path,
+             const std::vector<std::string> &statement_regex);
+
+  /// @brief Copy ctor: not implemented!
+  Scan_Cache(const Scan_Cache &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Scan_Cache &operator=(const Scan_Cache &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Scan_Cache(Scan_Cache &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Scan_Cache &operator=(Scan_Cache &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Scan_Cache() = default;
+
+  /// @brief Returns the cached statements of a file.
+  /// @details
+  ///   If nothing is returned, the file must be scanned and the result
+  ///   must be passed to store().
+  /// @param abs_path Absolute path of the file.
+  /// @param content Returns the content of the file, if it was read
+  ///        completely to compare the hash, but the hash didn't match.
+  /// @param file_size Returns size and lines of the file on a hit
+  ///        (optional).
+  /// @return The statements or nothing, if the file must be scanned.
+  std::optional<std::vector<Detected_Statement>> lookup(
+      const std::string &abs_path, std::optional<std::string> *content,
+      File_Size *file_size = nullptr);
+
+  /// @brief Stores the statements of a file after a failed lookup().
+  /// @param abs_path Absolute path of the file.
+  /// @param size Size of the scanned content.
+  /// @param hash content_hash() of the scanned content.
+  /// @param statements The statements of the content.
+  /// @param lines Number of lines of the content.
+  void store(const std::string &abs_path, std::uint64_t size,
+             std::uint64_t hash, std::vector<Detected_Statement> statements,
+             std::uint32_t lines = 0);
+
+  /// @brief Writes all entries, which were used since loading, to the
+  ///        cache file.
+  /// @return False if the file can't be written.
+  bool save();
+
+  /// @brief Returns the number of lookups which returned statements.
+  std::size_t get_n_hits() const;
+
+  /// @brief Returns the number of lookups which returned nothing.
+  std::size_t get_n_misses() const;
+
+ private:
+  /// @brief A cached file.
+  struct Entry {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;  ///< Nanoseconds since the epoch
+    std::uint64_t hash = 0;
+    std::uint32_t lines = 0;
+    std::vector<Detected_Statement> statements;
+    bool valid = false;  ///< False if the file must be scanned
+    bool used = false;   ///< Looked up since loading
+  };
+
+  /// @brief Reads the cache file.
+  bool load();
+
+  /// @brief Path of the cache file.
+  const std::string cache_path;
+
+  /// @brief Hash of the statement regexes.
+  std::uint64_t regex_hash;
+
+  /// @brief Entries by absolute path.
+  std::unordered_map<std::string, Entry> entries;
+
+  /// @brief Number of lookups which returned statements.
+  std::size_t n_hits;
+
+  /// @brief Number of lookups which returned nothing.
+  std::size_t n_misses;
+
+  /// @brief Protects all members.
+  mutable std::mutex entries_mutex;
+
+};  // class Scan_Cache
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // SCAN_CACHE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,100 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef SCC_H
+#define SCC_H
+
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Strongly connected components of a graph.
+/// @details
+///   The components are numbered in reverse topological order: all edges
+///   between two components go from the higher to the lower number.
+///   The vertices of component c are the entries get_first_member(c) to
+///   get_end_member(c) - 1 of members.
+class Strong_Components {
+ public:
+  /// @brief Component id type.
+  using Id = std::uint32_t;
+
+  /// @brief Computes the components of graph.
+  /// @details
+  ///   Tarjan's algorithm with an explicit stack instead of recursion,
+  ///   so deep include chains can't overflow the call stack.
+  ///   Runs in O(V + E).
+  explicit Strong_Components(const Csr_Graph &graph);
+
+  /// @brief Copy ctor: not implemented!
+  Strong_Components(const Strong_Components &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Strong_Components &operator=(const Strong_Components &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Strong_Components(Strong_Components &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Strong_Components &operator=(Strong_Components &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Strong_Components() = default;
+
+  /// @brief Returns the number of components.
+  Id size() const { return static_cast<Id>(first_member.size() - 1); }
+
+  /// @brief Returns the component of vertex v.
+  Id get_component(Vertex_Id v) const { return component[v]; }
+
+  /// @brief Returns the index of the first member of component c.
+  std::size_t get_first_member(Id c) const { return first_member[c]; }
+
+  /// @brief Returns the end index of the members of component c.
+  std::size_t get_end_member(Id c) const { return first_member[c + 1]; }
+
+  /// @brief Returns the member at index i.
+  Vertex_Id get_member(std::size_t i) const { return members[i]; }
+
+  /// @brief Returns the number of members of component c.
+  std::size_t get_n_members(Id c) const {
+    return first_member[c + 1] - first_member[c];
+  }
+
+ private:
+  /// @brief Component of each vertex.
+  std::vector<Id> component;
+
+  /// @brief Index of the first member of each component (plus end).
+  std::vector<std::size_t> first_member;
+
+  /// @brief Vertices, grouped by component.
+  std::vector<Vertex_Id> members;
+
+};  // class Strong_Components
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // SCC_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
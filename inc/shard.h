@@ -0,0 +1,56 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief A part of the input files (as given via --shard=i/N).
+/// @details
+///   Each file is assigned to one of count shards by the hash of its name
+///   (the path relative to its process path). The assignment therefore
+///   doesn't depend on the order of the walk or on the location of the
+///   tree, and is the same in each process and on each machine.
+struct Shard {
+  unsigned int index = 1;  ///< The selected shard (1 ... count)
+  unsigned int count = 1;  ///< Number of shards (1: all files)
+
+  /// @brief Parses "i/N" with 1 <= i <= N.
+  /// @return The shard or nothing if spec is invalid.
+  static std::optional<Shard> parse(const std::string &spec);
+
+  /// @brief Returns true if the file with the given name is part of the
+  ///        shard.
+  bool contains(std::string_view name) const;
+
+  /// @brief Returns true if only a part of the files is selected.
+  bool is_partial() const { return count > 1; }
+};
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // SHARD_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -21,18 +21,27 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include <boost/filesystem/path.hpp>
 #include <boost/program_options.hpp>
 
 #include "graph.h"
+#include "ndjson_stream.h"
 #include "vertex.h"
 
 namespace INCLUDE_GARDENER {
 
 using std::ostream;
 
+class Csr_Graph;
+
 /// @brief Solvers are used to solve an include relation ship between to files.
 /// @details
 ///     Different solvers exist, depending on the language.
@@ -71,12 +80,50 @@ class Solver {
   virtual ~Solver() = default;
 
   /// @brief Adds a vertex / entry.
-  virtual void add_vertex(const std::string &name, const std::string &abs_path);
+  /// @return The id of the new or already existing vertex.
+  virtual Vertex_Id add_vertex(const std::string &name,
+                               const std::string &abs_path);
+
+  /// @brief A statement, resolved to the included file (see resolve_edge).
+  struct Resolved_Edge {
+    std::string src_path;  ///< Path of the file with the statement
+    std::string dst_path;  ///< Path of the included file (empty: not found)
+    std::string name;      ///< Name of the included file
+    unsigned int line_no;  ///< Line number of the statement
+  };
 
-  /// @brief Shall add an edge and shall ensure exclusive access.
+  /// @brief Adds an edge and ensures exclusive access.
+  /// @details
+  ///   The default implementation resolves the statement without lock
+  ///   (resolve_edge) and inserts the result (insert_edges). A derived
+  ///   solver must override either this method or resolve_edge.
   virtual void add_edge(const std::string &src_path,
                         const std::string &statement, unsigned int idx,
-                        unsigned int line_no) = 0;
+                        unsigned int line_no);
+
+  /// @brief Resolves a statement to the included file(s).
+  /// @details
+  ///   Only the file system is probed, the graph is not accessed. The
+  ///   method can therefore be called by multiple threads without lock.
+  /// @param edges The resolved edges are appended.
+  /// @return False if the solver doesn't support resolving separately
+  ///         (add_edge must be used instead).
+  virtual bool resolve_edge(const std::string &src_path,
+                            const std::string &statement, unsigned int idx,
+                            unsigned int line_no,
+                            std::vector<Resolved_Edge> *edges);
+
+  /// @brief Inserts resolved edges (locks the graph once).
+  void insert_edges(const std::vector<Resolved_Edge> &edges);
+
+  /// @brief Records the sizes of scanned files (ensures exclusive access).
+  /// @details
+  ///   Unknown files (without vertex) are ignored. The graph is locked
+  ///   once for all files.
+  /// @param sizes Absolute path (the key of the vertex), size and number
+  ///        of lines of each file.
+  void set_file_sizes(
+      const std::vector<std::pair<std::string, File_Size>> &sizes);
 
   /// @brief Shall return the regex for the statements which shall be
   ///        detected.
@@ -86,15 +133,108 @@ class Solver {
   ///        detected.
   virtual std::string get_file_regex() const = 0;
 
+  /// @brief Returns the regex for the files which are translation units.
+  /// @details
+  ///   The regex is searched in the name of each vertex. If it is empty
+  ///   (the default), each vertex without incoming edges is a unit.
+  virtual std::string get_unit_regex() const { return std::string(); }
+
   /// @brief Shall extract the solver-specific options (variables).
   virtual void extract_options(
       const boost::program_options::variables_map &vm) = 0;
 
   /// @brief Writes the graph to a file.
-  /// @param format Either "dot" or "xml"/"graphml".
+  /// @param format Either "dot", "xml"/"graphml", "ndjson" or "bin"
+  ///               (see Graph_File).
   /// @param os Output stream
   virtual void write_graph(const std::string &format, ostream &os);
 
+  /// @brief Writes the graph via the writers of the Boost Graph Library.
+  /// @details
+  ///   The output is the same as the one of write_graph ("dot" and
+  ///   "xml"/"graphml" only). It is kept as reference for tests and
+  ///   benchmarks of Graph_Writer.
+  void write_graph_boost(const std::string &format, ostream &os);
+
+  /// @brief Writes the transitive include set of each translation unit.
+  /// @details
+  ///   The translation units are selected by get_unit_regex(). For each of
+  ///   them, one line "<name>: <name> <name> ..." is written, listing all
+  ///   vertices which are reachable from it (see Transitive_Closure).
+  /// @param os Output stream
+  /// @param n_threads Number of threads which compute the closure.
+  void write_closure(ostream &os, unsigned int n_threads);
+
+  /// @brief Writes the include cost report.
+  /// @details
+  ///   For each translation unit (see get_unit_regex), the bytes and lines
+  ///   of the unit and of all files it includes (transitively) are summed
+  ///   up (see Include_Cost). The n_top most
+  ///   expensive units are written, and the n_top headers which add the
+  ///   most bytes to all units together.
+  /// @param os Output stream
+  /// @param n_threads Number of threads which compute the costs.
+  /// @param n_top Number of listed units and headers.
+  void write_include_cost(ostream &os, unsigned int n_threads,
+                          std::size_t n_top);
+
+  /// @brief Writes the recommended headers of a precompiled header.
+  /// @details
+  ///   The headers are scored by the number of including translation
+  ///   units times their transitive bytes and selected within the budget
+  ///   (see Pch_Recommender). One line per selected header is written.
+  /// @param os Output stream
+  /// @param n_threads Number of threads which score the headers.
+  /// @param budget Maximum size of the precompiled header in bytes.
+  void write_pch(ostream &os, unsigned int n_threads, std::uint64_t budget);
+
+  /// @brief Returns the graph.
+  /// @details Must not be used while files are processed.
+  const Graph &get_graph() const { return graph; }
+
+  /// @brief Returns the vertex table.
+  /// @details Must not be used while files are processed.
+  const Vertex_Table &get_vertexes() const { return vertexes; }
+
+  /// @brief Returns the absolute path of a vertex.
+  /// @details
+  ///   Locks the graph, so it may be used while files are processed.
+  std::string get_abs_path(Vertex_Id id);
+
+  /// @brief Returns the vertex of a file.
+  /// @param file A path of the file (resolved to its canonical path if the
+  ///        file exists) or, for unresolved includes, the name.
+  /// @return The vertex or NO_VERTEX if the file is unknown.
+  Vertex_Id find_file(const std::string &file) const;
+
+  /// @brief Removes all edges from src (before src is processed again).
+  void remove_out_edges(Vertex_Id src);
+
+  /// @brief Writes the translation units which are affected by changes.
+  /// @details
+  ///   A translation unit (see get_unit_regex) is affected if it is one of
+  ///   the changed files or if it (transitively) includes one of them (see
+  ///   find_affected). The names of the affected units are written one per
+  ///   line.
+  /// @param os Output stream
+  /// @param changed_files Paths (or, for unresolved includes, names) of
+  ///        the changed files; unknown files are logged and skipped.
+  void write_affected(ostream &os,
+                      const std::vector<std::string> &changed_files);
+
+  /// @brief Logs a warning for each include cycle of the graph.
+  /// @details
+  ///   One shortest cycle is reported per strongly connected component
+  ///   (see find_cycles), together with the lines of its include
+  ///   statements.
+  /// @return The number of reported cycles.
+  std::size_t report_cycles();
+
+  /// @brief Sets a stream which gets each new vertex and edge.
+  /// @details
+  ///   Must be set before the first vertex is added.
+  void set_stream(Ndjson_Stream::Ptr stream);
+
   /// @brief Adds solver-specific options.
   virtual void add_options(
       boost::program_options::options_description *options) const = 0;
@@ -108,11 +248,55 @@ class Solver {
   Graph graph;
 
   /// @brief Storage of all added vertexes.
-  Vertex::Map vertexes;
+  Vertex_Table vertexes;
+
+  /// @brief Adds an edge from src to dst if it doesn't exist yet.
+  /// @details
+  ///   If the edge already exists, only its count is incremented,
+  ///   no parallel edge is added.
+  /// @return True if a new edge has been added.
+  bool insert_unique_edge(Vertex_Id src, Vertex_Id dst, unsigned int line_no);
+
+  /// @brief Inserts a resolved edge (graph_mutex must be locked).
+  /// @details
+  ///   The default adds both vertexes and counts duplicate edges (see
+  ///   insert_unique_edge).
+  /// @param src_path Path of the file with the statement.
+  /// @param dst_path Path of the included file (empty: not found).
+  /// @param name The name of the included file.
+  /// @param line_no The line number of the statement.
+  virtual void insert_edge(const std::string &src_path,
+                           const std::string &dst_path,
+                           const std::string &name, unsigned int line_no);
+
+  /// @brief Counts one more occurrence of the edge from src to dst.
+  /// @return False if no such edge exists (nothing is counted).
+  bool count_edge(Vertex_Id src, Vertex_Id dst);
+
+  /// @brief Returns the translation units of graph (see get_unit_regex).
+  /// @param graph The graph (must not be reversed).
+  std::vector<Vertex_Id> find_units(const Csr_Graph &graph) const;
+
+  /// @brief Index of all edges, the key is built from (src, dst).
+  std::unordered_map<std::uint64_t, Edge_Descriptor> edge_index;
+
+  /// @brief Returns the vertex with the given key.
+  /// @details A vertex (named by the key) is added if it doesn't exist.
+  Vertex_Id find_or_add_vertex(const std::string &key);
 
   /// @brief Shall be used to ensure exclusive access to graph.
   std::mutex graph_mutex;
 
+  /// @brief Locks graph_mutex (and measures the wait time for --stats).
+  std::unique_lock<std::mutex> lock_graph();
+
+  /// @brief Returns true if the file exists (and counts the probe for
+  ///        --stats). Used by the solvers to resolve the statements.
+  static bool probe(const boost::filesystem::path &p);
+
+  /// @brief Gets all new vertexes and edges (optional).
+  Ndjson_Stream::Ptr stream;
+
  private:
 };  // class Solver
 
@@ -39,6 +39,10 @@ class Solver_C : public Solver {
   /// @brief Smart pointer for Solver_C
   using Ptr = std::shared_ptr<Solver_C>;
 
+  /// @brief Default regex of the translation units.
+  static constexpr const char *DEFAULT_UNIT_REGEX =
+      "(.*)\\.(c|cc|cpp|cxx|m|mm)$";
+
   /// @brief Default ctor.
   Solver_C() = default;
 
@@ -57,13 +61,16 @@ class Solver_C : public Solver {
   /// @brief Default dtor
   ~Solver_C() override = default;
 
-  /// @brief Adds an edge to the graph.
+  /// @brief Resolves a statement to the included file (without lock).
   /// @param src_path Path the the source path (where the statement is detected.
   /// @param statement The detected statement
   /// @param idx The index of the regular expression, which matched.
   /// @param line_no The line number where the statement is detected.
-  void add_edge(const std::string &src_path, const std::string &statement,
-                unsigned int idx, unsigned int line_no) override;
+  /// @param edges The resolved edge is appended.
+  /// @return Always true.
+  bool resolve_edge(const std::string &src_path, const std::string &statement,
+                    unsigned int idx, unsigned int line_no,
+                    std::vector<Resolved_Edge> *edges) override;
 
   /// @brief Returns the regex which
   ///        detectes the statements.
@@ -73,6 +80,10 @@ class Solver_C : public Solver {
   ///        detectes the files.
   std::string get_file_regex() const override;
 
+  /// @brief Returns the regex of the translation units (source files,
+  ///        option c-unit-regex).
+  std::string get_unit_regex() const override { return unit_regex; }
+
   /// @brief Extracts solver-specific options (variables).
   void extract_options(
       const boost::program_options::variables_map &vm) override;
@@ -81,19 +92,12 @@ class Solver_C : public Solver {
   void add_options(
       boost::program_options::options_description *options) const override;
 
- protected:
-  /// @brief Adds an edge
-  /// @param src_path Path the the source path (where the statement is detected.
-  /// @param dst_path Path of the destination file (the file which is included).
-  /// @param name The statement (mostly the name of the file).
-  /// @param line_no The line number where the statement is detected.
-  virtual void insert_edge(const std::string &src_path,
-                           const std::string &dst_path, const std::string &name,
-                           unsigned int line_no);
-
  private:
   /// @brief Search path for include statements.
   std::vector<std::string> include_paths;
+
+  /// @brief Regex of the translation units.
+  std::string unit_regex = DEFAULT_UNIT_REGEX;
 };  // class Solver_C
 
 }  // namespace INCLUDE_GARDENER
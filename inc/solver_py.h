@@ -82,14 +82,17 @@ class Solver_Py : public Solver {
   /// @brief Default dtor
   ~Solver_Py() override = default;
 
-  /// @brief Adds an edge to the graph.
+  /// @brief Resolves a statement to the imported file(s) (without lock).
   /// @param src_path Path the the source path (where the statement is
   /// detected).
   /// @param statement The detected statement
   /// @param idx The index of the regular expression, which matched.
   /// @param line_no The line number where the statement is detected.
-  void add_edge(const std::string &src_path, const std::string &statement,
-                unsigned int idx, unsigned int line_no) override;
+  /// @param edges The resolved edges are appended (one per import).
+  /// @return Always true.
+  bool resolve_edge(const std::string &src_path, const std::string &statement,
+                    unsigned int idx, unsigned int line_no,
+                    std::vector<Resolved_Edge> *edges) override;
 
   /// @brief Returns the regex which detects the import statements.
   std::vector<std::string> get_statement_regex() const override;
@@ -114,13 +117,13 @@ class Solver_Py : public Solver {
   /// @param dst_path Path of the destination file (the file which is included).
   /// @param name The statement (mostly the name of the file).
   /// @param line_no The line number where the statement is detected.
-  virtual void insert_edge(const std::string &src_path,
-                           const std::string &dst_path, const std::string &name,
-                           unsigned int line_no);
+  void insert_edge(const std::string &src_path, const std::string &dst_path,
+                   const std::string &name, unsigned int line_no) override;
 
-  /// @brief Convenience function for adding a vector of statements
-  /// as edges through add_edge.
-  void add_edges(const std::vector<Statement_Py> &statements);
+  /// @brief Convenience function for resolving a vector of statements
+  /// through resolve_edge.
+  void resolve_edges(const std::vector<Statement_Py> &statements,
+                     std::vector<Resolved_Edge> *edges);
 
   /// @brief Tests if a path is a Python module.
   virtual bool is_module(const std::string &path_string);
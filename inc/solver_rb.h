@@ -53,13 +53,16 @@ class Solver_Rb : public Solver {
   /// @brief Default dtor
   ~Solver_Rb() override = default;
 
-  /// @brief Adds an edge to the graph.
+  /// @brief Resolves a statement to the included file (without lock).
   /// @param src_path Path the the source path (where the statement is detected.
   /// @param statement The detected statement
   /// @param idx The index of the regular expression, which matched.
   /// @param line_no The line number where the statement is detected.
-  void add_edge(const std::string &src_path, const std::string &statement,
-                unsigned int idx, unsigned int line_no) override;
+  /// @param edges The resolved edge is appended.
+  /// @return Always true.
+  bool resolve_edge(const std::string &src_path, const std::string &statement,
+                    unsigned int idx, unsigned int line_no,
+                    std::vector<Resolved_Edge> *edges) override;
 
   /// @brief Returns the regex which
   ///        detectes the statements.
@@ -79,16 +82,6 @@ class Solver_Rb : public Solver {
   void add_options(
       boost::program_options::options_description *options) const override;
 
- protected:
-  /// @brief Adds an edge
-  /// @param src_path Path the the source path (where the statement is detected.
-  /// @param dst_path Path of the destination file (the file which is included).
-  /// @param name The statement (mostly the name of the file).
-  /// @param line_no The line number where the statement is detected.
-  virtual void insert_edge(const std::string &src_path,
-                           const std::string &dst_path, const std::string &name,
-                           unsigned int line_no);
-
  private:
   /// @brief Search path for include statements.
   std::vector<std::string> include_paths;
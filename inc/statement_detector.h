@@ -21,17 +21,29 @@
 #ifndef STATEMENT_DETECTOR_H
 #define STATEMENT_DETECTOR_H
 
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <boost/regex.hpp>
 
+#include "bounded_queue.h"
+#include "memory_guard.h"
+#include "run_stats.h"
+#include "scan_cache.h"
 #include "solver.h"
+#include "uring_reader.h"
+#include "worker_controller.h"
 
 namespace INCLUDE_GARDENER {
 
@@ -43,6 +55,29 @@ namespace INCLUDE_GARDENER {
 ///   This class implements also a multi-threading mechanism, where
 ///   a file which shall be processed is added to a queue (via add_job).
 ///   The number of worker-threads is defined by n_workers in the ctor.
+///   The queue can be bounded (queue_capacity): add_job() then blocks
+///   until a worker took a job. With max_memory, add_job() pauses while
+///   the resident memory exceeds the limit (see Memory_Guard): it hands
+///   over one job per worker and then waits until all jobs are processed,
+///   so the graph only grows by one batch of files between two
+///   measurements. The hand-over resumes once the memory dropped below
+///   the resume threshold.
+///   With uring_depth > 0 (and without cache), the files are read by a
+///   reader thread via io_uring (see Uring_Reader), which keeps up to
+///   uring_depth operations in flight; the workers scan the read
+///   contents. If io_uring is not available, the workers read the files
+///   (see read_file).
+///   With n_workers = AUTO_WORKERS, twice the CPU budget of threads are
+///   started, and a Worker_Controller adapts how many of them take jobs.
+///
+///   With n_resolvers > 0, the scan is a pipeline: the workers only read
+///   and scan the files and pass the statements of each file via a
+///   lock-free Bounded_Queue to n_resolvers resolver threads, which probe
+///   the file system (Solver::resolve_edge). The resolved edges are passed
+///   via a second queue to one inserter thread, the only thread which
+///   locks the graph (Solver::insert_edges). Reading (with io_uring),
+///   scanning, resolving and inserting therefore overlap. The depths of
+///   all queues are reported via get_queue_stats() (and --stats).
 ///
 ///   @TODO It would be good to ensure that wait_for_workers() is called in any
 ///   case.
@@ -51,13 +86,34 @@ class Statement_Detector {
   /// @brief Smart pointer for Statement_Detector
   using Ptr = std::shared_ptr<Statement_Detector>;
 
+  /// @brief n_workers value for an adaptive number of workers (-j auto).
+  static constexpr int AUTO_WORKERS = -1;
+
   /// @brief Initializes all members.
   ///       The member all_work_done is initialized with false.
   /// @param solver
   ///     A language-specific solver which is used to process a detected
   ///     statement.
-  // @param n_workers Limits the number of threads. Must be >= 1.
-  explicit Statement_Detector(const Solver::Ptr &solver, int n_workers = 1);
+  // @param n_workers Limits the number of threads. Must be >= 1 or
+  //        AUTO_WORKERS.
+  /// @param cache Optional cache of the statements of each file.
+  /// @param queue_capacity Maximum number of queued jobs (0: unbounded).
+  /// @param max_memory Limit of the resident memory in bytes (0: none).
+  /// @param uring_depth io_uring operations in flight (0: no io_uring).
+  /// @param n_resolvers Resolver threads (0: the workers resolve the
+  ///        statements themselves, no pipeline).
+  explicit Statement_Detector(const Solver::Ptr &solver, int n_workers = 1,
+                              Scan_Cache::Ptr cache = nullptr,
+                              std::size_t queue_capacity = 0,
+                              std::size_t max_memory = 0,
+                              unsigned int uring_depth = 0,
+                              unsigned int n_resolvers = 0);
+
+  /// @brief Capacity of the pipeline queues if queue_capacity is 0.
+  static constexpr std::size_t PIPELINE_QUEUE_CAPACITY = 1024;
+
+  /// @brief Interval in which a paused add_job() measures the memory.
+  static constexpr std::chrono::milliseconds MEMORY_RECHECK{10};
 
   /// @brief Default copy ctor.
   Statement_Detector(const Statement_Detector &other) = delete;
@@ -75,26 +131,113 @@ class Statement_Detector {
   ~Statement_Detector() = default;
 
   /// @brief Adds a further job (path to file, which is processed).
-  void add_job(const std::string &abs_path);
+  /// @details
+  ///   Blocks if the queue is full (see queue_capacity) or while the
+  ///   memory limit is exceeded (see max_memory).
+  void add_job(std::string abs_path);
 
   /// @brief Returns list of statements (as regex)
   std::vector<boost::regex> get_statements() const;
 
   /// @brief Waits for all workers (blocking).
+  /// @details With --stats, the queue statistics are added to Run_Stats.
+  /// @throws std::runtime_error if the io_uring reader failed.
   void wait_for_workers();
 
+  /// @brief Returns true if the files are read via io_uring.
+  bool is_using_uring() const { return reader != nullptr; }
+
+  /// @brief Returns the number of files, which were not scanned because
+  ///        two byte-identical files were scanned before.
+  std::size_t get_n_reused() const;
+
+  /// @brief Returns the number of jobs which were handed over in batches
+  ///        because the memory limit was exceeded.
+  std::size_t get_n_throttled() const;
+
+  /// @brief Returns the statistics of each queue ("jobs", "read" with
+  ///        io_uring, "resolve" and "insert" with resolver threads).
+  /// @details Shall be called after wait_for_workers().
+  std::vector<std::pair<std::string, Queue_Stats>> get_queue_stats() const;
+
  protected:
   /// @brief Detects include / import statements.
   std::optional<std::pair<std::string, unsigned int>> detect(
       const std::string &line) const;
 
   /// @brief Walk through a stream and searches for include / import statements.
-  void process_stream(std::istream &input, const std::string &input_path);
+  /// @param found If not null, all statements are also appended to found.
+  /// @return The number of lines of the stream.
+  unsigned int process_stream(std::istream &input,
+                              const std::string &input_path,
+                              std::vector<Detected_Statement> *found = nullptr);
 
  private:
-  /// @brief Threading method: takes an entry from job_queue to processes it.
+  /// @brief Threading method: takes an entry from job_queue (or from
+  ///        read_queue) to processes it.
   void do_work(int id);
 
+  /// @brief Counts a processed job (see n_pending).
+  void finish_job();
+
+  /// @brief Threading method: reads the files of job_queue via io_uring
+  ///        and moves them to read_queue.
+  void read_loop();
+
+  /// @brief Threading method: resolves the statements of resolve_queue
+  ///        and moves the edges to insert_queue.
+  void resolve_loop(int id);
+
+  /// @brief Threading method: inserts the edges of insert_queue.
+  void insert_loop();
+
+  /// @brief Reports a finished job to the controller and applies its
+  ///        number of active workers.
+  void adapt_workers(Worker_Controller::Clock::time_point wall_start,
+                     std::uint64_t cpu_start);
+
+  /// @brief Processes a file without cache.
+  /// @param id Id of the calling worker.
+  void process_file(int id, const std::string &input_path);
+
+  /// @brief Processes a file, using the cache.
+  /// @param id Id of the calling worker.
+  void process_cached(int id, const std::string &input_path);
+
+  /// @brief Statements of a scanned content.
+  using Statements = std::shared_ptr<const std::vector<Detected_Statement>>;
+
+  /// @brief Adds the statements of the content of a file.
+  /// @details
+  ///   If a content was already scanned twice, its statements are re-used
+  ///   instead of scanning the content again. The statements
+  ///   are always resolved relative to input_path. The size of the file
+  ///   is recorded in the worker's file_sizes.
+  /// @param id Id of the calling worker.
+  /// @param hash content_hash() of content.
+  /// @param lines Returns the number of lines (optional).
+  /// @return The statements of the content.
+  Statements process_content(int id, const std::string &input_path,
+                             std::string_view content, std::uint64_t hash,
+                             unsigned int *lines = nullptr);
+
+  /// @brief Passes the statements of a file to the solver (or to the
+  ///        resolver threads).
+  void add_edges(const std::string &input_path, const Statements &statements);
+
+  /// @brief Passes a statement to the solver.
+  void add_edge(const std::string &input_path, const std::string &statement,
+                unsigned int idx, unsigned int line_no);
+
+  /// @brief Passes a statement to the solver (and appends it to found).
+  /// @details
+  ///   With resolver threads, a statement which is appended to found is
+  ///   only passed on (via add_edges) after the whole file is scanned.
+  void add_statement(const std::string &input_path,
+                     const std::pair<std::string, unsigned int> &statement,
+                     unsigned int line_no,
+                     std::vector<Detected_Statement> *found);
+
   /// @brief Internal vector of statements.
   const std::vector<boost::regex> statements;
 
@@ -107,17 +250,115 @@ class Statement_Detector {
   std::deque<std::string> job_queue;
 
   /// @brief Protects job_queue (all worker threads and main-thread).
-  std::mutex job_queue_mutex;
+  mutable std::mutex job_queue_mutex;
 
-  /// @brief Condition variable to sleep thread until jobs are available.
+  /// @brief Condition variable to sleep thread until jobs are available
+  ///        (or, in add_job, until the queue has space).
   std::condition_variable job_queue_condition;
 
+  /// @brief Maximum number of queued jobs (0: unbounded).
+  const std::size_t queue_capacity;
+
+  /// @brief Limit of the resident memory.
+  Memory_Guard memory_guard;
+
+  /// @brief Number of throttled jobs (protected by job_queue_mutex).
+  std::size_t n_throttled;
+
+  /// @brief Jobs which may still be added before add_job() waits for the
+  ///        scan, while the memory limit is exceeded (protected by
+  ///        job_queue_mutex).
+  std::size_t n_batch_left;
+
+  /// @brief Added jobs which were not processed yet (protected by
+  ///        job_queue_mutex).
+  std::size_t n_pending;
+
+  /// @brief Statistics of job_queue (protected by job_queue_mutex).
+  Queue_Stats job_queue_stats;
+
+  /// @brief Statistics of read_queue (protected by job_queue_mutex).
+  Queue_Stats read_queue_stats;
+
+  /// @brief Adapts n_active_workers (only with AUTO_WORKERS).
+  std::unique_ptr<Worker_Controller> controller;
+
+  /// @brief Workers with a smaller id take jobs (protected by
+  ///        job_queue_mutex).
+  unsigned int n_active_workers;
+
   /// @brief Flag to end worker threads.
   bool all_work_done;
 
+  /// @brief The io_uring reader (optional).
+  std::unique_ptr<Uring_Reader> reader;
+
+  /// @brief Maximum number of read files waiting for a worker.
+  const unsigned int uring_depth;
+
+  /// @brief Read files (protected by job_queue_mutex).
+  std::deque<Uring_Reader::Result> read_queue;
+
+  /// @brief Flag to end the reader thread (protected by job_queue_mutex).
+  bool reading_done;
+
+  /// @brief Error of the reader thread (protected by job_queue_mutex).
+  std::string read_error;
+
+  /// @brief The thread calling read_loop.
+  std::thread reader_thread;
+
   /// @brief Pointer to solver instance.
   Solver::Ptr solver;
 
+  /// @brief Cache of the statements of each file (optional).
+  Scan_Cache::Ptr cache;
+
+  /// @brief Sizes of the scanned files, one vector per worker.
+  /// @details
+  ///   Passed to the solver by wait_for_workers(), so the workers don't
+  ///   lock the graph for each file.
+  std::vector<std::vector<std::pair<std::string, File_Size>>> file_sizes;
+
+  /// @brief Sizes of the contents which were scanned once, by content hash.
+  std::unordered_map<std::uint64_t, std::size_t> scanned;
+
+  /// @brief A content which was scanned for more than one file.
+  struct Duplicate {
+    std::size_t size;        ///< Size of the content
+    unsigned int lines;      ///< Number of lines of the content
+    Statements statements;  ///< Statements of the content
+  };
+
+  /// @brief Statements of the contents which were scanned twice, by
+  ///        content hash.
+  std::unordered_map<std::uint64_t, Duplicate> duplicates;
+
+  /// @brief The statements of a file, waiting for a resolver thread.
+  struct Resolve_Job {
+    std::string path;       ///< Path of the file
+    Statements statements;  ///< Statements of the file
+  };
+
+  /// @brief Scanned files (only with resolver threads).
+  std::unique_ptr<Bounded_Queue<Resolve_Job>> resolve_queue;
+
+  /// @brief Resolved edges of a file (only with resolver threads).
+  std::unique_ptr<Bounded_Queue<std::vector<Solver::Resolved_Edge>>>
+      insert_queue;
+
+  /// @brief Threads calling resolve_loop.
+  std::vector<std::thread> resolvers;
+
+  /// @brief The thread calling insert_loop.
+  std::thread inserter;
+
+  /// @brief Number of files which re-used the statements of another file.
+  std::size_t n_reused;
+
+  /// @brief Protects scanned, duplicates and n_reused.
+  mutable std::mutex scanned_mutex;
+
 };  // class Statement_Detector
 
 }  // namespace INCLUDE_GARDENER
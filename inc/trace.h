@@ -0,0 +1,119 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "run_stats.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Timeline of the activity of all threads (for --trace).
+/// @details
+///   The spans are collected per thread (in the Thread_Stats of
+///   Run_Stats) and written in the Chrome trace event format, which
+///   can be loaded by chrome://tracing or Perfetto.
+class Trace {
+ public:
+  /// @brief Starts the recording.
+  static void enable();
+
+  /// @brief Stops the recording.
+  static void disable();
+
+  /// @brief Returns true if spans are recorded.
+  static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+  /// @brief Records a span of the calling thread (if enabled).
+  static void record(const char *name, Run_Stats::Clock::time_point start,
+                     Run_Stats::Clock::time_point end,
+                     std::string detail = std::string(),
+                     std::uint64_t size = 0);
+
+  /// @brief Writes all spans as Chrome trace JSON.
+  static void write(std::ostream &os);
+
+ private:
+  /// @brief True if enabled.
+  static std::atomic<bool> enabled;
+
+  /// @brief Start of the recording.
+  static Run_Stats::Clock::time_point start;
+};
+
+/// @brief Records its lifetime as span (if Trace is enabled).
+class Trace_Span {
+ public:
+  /// @brief Starts the span.
+  /// @param name Name of the span (must be a string literal).
+  /// @param detail Optional detail, e.g. a path.
+  /// @param size Optional size, e.g. of a file.
+  explicit Trace_Span(const char *name, std::string_view detail = {},
+                      std::uint64_t size = 0)
+      : name(Trace::is_enabled() ? name : nullptr),
+        detail(this->name == nullptr ? std::string_view() : detail),
+        size(size),
+        start(this->name == nullptr ? Run_Stats::Clock::time_point()
+                                    : Run_Stats::Clock::now()) {}
+
+  /// @brief Copy ctor: not implemented!
+  Trace_Span(const Trace_Span &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Trace_Span &operator=(const Trace_Span &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Trace_Span(Trace_Span &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Trace_Span &operator=(Trace_Span &&rhs) = delete;
+
+  /// @brief Ends the span.
+  ~Trace_Span() {
+    if (name != nullptr) {
+      Trace::record(name, start, Run_Stats::Clock::now(), std::move(detail),
+                    size);
+    }
+  }
+
+ private:
+  /// @brief Name of the span (nullptr if disabled).
+  const char *name;
+
+  /// @brief Detail of the span.
+  std::string detail;
+
+  /// @brief Size of the span.
+  std::uint64_t size;
+
+  /// @brief Start of the span.
+  Run_Stats::Clock::time_point start;
+};
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // TRACE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,112 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef TRANSITIVE_CLOSURE_H
+#define TRANSITIVE_CLOSURE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "scc.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Set of reachable vertices for each vertex of a graph.
+/// @details
+///   A vertex w is reachable from v if there is a path of at least one
+///   edge from v to w (v itself is only reachable if it is part of a
+///   cycle). All vertices of a strongly connected component share one
+///   row of bits, one bit per vertex. The rows are computed over the
+///   condensation of the graph: components are grouped into levels
+///   (level 0 = no successors, level n = successors on lower levels
+///   only), and the rows of one level are computed in parallel by
+///   OR-ing the rows of the successors, word by word.
+///   The memory use is n_components * n_vertices bits. It is checked
+///   against a limit before the rows are allocated.
+class Transitive_Closure {
+ public:
+  /// @brief Computes the closure of graph.
+  /// @details
+  ///   Throws std::runtime_error if the rows would need more than
+  ///   max_bytes.
+  /// @param graph The graph.
+  /// @param n_threads Number of threads which compute the rows.
+  /// @param max_bytes Limit of the rows' memory (0: the physical memory).
+  Transitive_Closure(const Csr_Graph &graph, unsigned int n_threads,
+                     std::size_t max_bytes = 0);
+
+  /// @brief Copy ctor: not implemented!
+  Transitive_Closure(const Transitive_Closure &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Transitive_Closure &operator=(const Transitive_Closure &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Transitive_Closure(Transitive_Closure &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Transitive_Closure &operator=(Transitive_Closure &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Transitive_Closure() = default;
+
+  /// @brief Returns true if dst is reachable from src.
+  bool reaches(Vertex_Id src, Vertex_Id dst) const;
+
+  /// @brief Returns all vertices reachable from v (ascending).
+  std::vector<Vertex_Id> get_reachable(Vertex_Id v) const;
+
+  /// @brief Returns the number of vertices reachable from v.
+  std::size_t count_reachable(Vertex_Id v) const;
+
+  /// @brief Returns the size of the physical memory (0 if unknown).
+  static std::size_t get_physical_memory();
+
+ private:
+  /// @brief Computes the row of component c.
+  /// @param stamp Per-thread marks of the already merged components.
+  void compute_row(Strong_Components::Id c,
+                   std::vector<Strong_Components::Id> *stamp);
+
+  /// @brief Returns the row of component c.
+  const std::uint64_t *get_row(Strong_Components::Id c) const {
+    return &bits[c * words_per_row];
+  }
+
+  /// @brief The graph.
+  const Csr_Graph &graph;
+
+  /// @brief The strongly connected components of the graph.
+  Strong_Components components;
+
+  /// @brief Length of a row in 64-bit words (a multiple of 4).
+  std::size_t words_per_row;
+
+  /// @brief One row per component.
+  std::vector<std::uint64_t> bits;
+
+};  // class Transitive_Closure
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // TRANSITIVE_CLOSURE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,170 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Reads whole files with io_uring, many files at once.
+/// @details
+///   Each file passes three operations: open, read (repeated with a
+///   larger buffer until the end of the file is reached) and close. Up
+///   to depth operations are in flight; the ring is set up via the raw
+///   system calls (no liburing). The reader is used by a single thread.
+class Uring_Reader {
+ public:
+  /// @brief A file which was read (or could not be read).
+  struct Result {
+    std::string path;                    ///< Path as given to add()
+    std::optional<std::string> content;  ///< Nothing if the read failed
+  };
+
+  /// @brief Initial size of the read buffer of a file.
+  static constexpr std::size_t INITIAL_BUFFER_SIZE = 16U << 10U;
+
+  /// @brief Sets up the ring.
+  /// @param depth Maximum number of operations in flight.
+  /// @throws std::runtime_error if io_uring is not available.
+  explicit Uring_Reader(unsigned int depth);
+
+  /// @brief Copy ctor: not implemented!
+  Uring_Reader(const Uring_Reader &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Uring_Reader &operator=(const Uring_Reader &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Uring_Reader(Uring_Reader &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Uring_Reader &operator=(Uring_Reader &&rhs) = delete;
+
+  /// @brief Waits for all operations in flight and releases the ring.
+  ~Uring_Reader();
+
+  /// @brief Returns true if another file can be added.
+  bool has_space() const { return n_in_flight < depth; }
+
+  /// @brief Returns the number of operations in flight.
+  unsigned int get_n_in_flight() const { return n_in_flight; }
+
+  /// @brief Adds a file (it is opened by the next run()).
+  /// @pre has_space()
+  void add(std::string path);
+
+  /// @brief Submits all added operations and waits for at least one
+  ///        completion (if any operation is in flight).
+  /// @param done Files which are completely read are appended.
+  void run(std::vector<Result> *done);
+
+ private:
+  /// @brief State of the file of a slot.
+  enum class State { FREE, OPENING, READING };
+
+  /// @brief A file in flight.
+  struct Slot {
+    State state = State::FREE;  ///< Current operation
+    std::string path;           ///< Path of the file
+    std::string buffer;         ///< Read buffer
+    std::size_t size = 0;       ///< Number of read bytes
+    int fd = -1;                ///< File descriptor (after opening)
+  };
+
+  /// @brief Closes the open files and unmaps / closes the ring.
+  void release();
+
+  /// @brief Prepares the next submission queue entry.
+  void push(std::uint8_t opcode, int fd, std::uint64_t addr,
+            std::uint32_t len, std::uint64_t offset, std::uint32_t flags,
+            std::uint64_t user_data);
+
+  /// @brief Prepares the read of the remaining buffer of a slot.
+  void push_read(std::size_t index);
+
+  /// @brief Prepares the close of a file descriptor.
+  void push_close(int fd);
+
+  /// @brief Handles a completion.
+  void complete(std::uint64_t user_data, int result,
+                std::vector<Result> *done);
+
+  /// @brief Finishes the file of a slot.
+  void finish(std::size_t index, bool ok, std::vector<Result> *done);
+
+  /// @brief Maximum number of operations in flight.
+  const unsigned int depth;
+
+  /// @brief The io_uring file descriptor.
+  int ring_fd;
+
+  /// @brief Mapping of the submission queue ring.
+  void *sq_ring;
+
+  /// @brief Size of sq_ring.
+  std::size_t sq_ring_size;
+
+  /// @brief Mapping of the completion queue ring (may equal sq_ring).
+  void *cq_ring;
+
+  /// @brief Size of cq_ring.
+  std::size_t cq_ring_size;
+
+  /// @brief Mapping of the submission queue entries.
+  void *sqes;
+
+  /// @brief Size of sqes.
+  std::size_t sqes_size;
+
+  /// @brief Pointers into the rings.
+  std::uint32_t *sq_head;
+  std::uint32_t *sq_tail;
+  std::uint32_t *sq_mask;
+  std::uint32_t *sq_array;
+  std::uint32_t *cq_head;
+  std::uint32_t *cq_tail;
+  std::uint32_t *cq_mask;
+  void *cqes;
+
+  /// @brief Number of prepared but not yet submitted entries.
+  unsigned int n_to_submit;
+
+  /// @brief Number of operations in flight (including the prepared).
+  unsigned int n_in_flight;
+
+  /// @brief Files in flight.
+  std::vector<Slot> slots;
+
+  /// @brief Indices of the free slots.
+  std::vector<std::size_t> free_slots;
+
+};  // class Uring_Reader
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // URING_READER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -21,58 +21,112 @@
 #ifndef VERTEX_H
 #define VERTEX_H
 
-#include <map>
-#include <memory>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "path_table.h"
 
 namespace INCLUDE_GARDENER {
 
-/// @brief Instances of this class represent a vertex
+/// @brief Index of a vertex in the Vertex_Table (and in the graph).
+using Vertex_Id = std::uint32_t;
+
+/// @brief Returned by Vertex_Table::find if no vertex exists.
+static constexpr Vertex_Id NO_VERTEX = std::numeric_limits<Vertex_Id>::max();
+
+/// @brief Size of a scanned file.
+struct File_Size {
+  std::uint64_t bytes = 0;  ///< Size of the file in bytes
+  std::uint32_t lines = 0;  ///< Number of lines
+};
+
+/// @brief Table of all vertices.
 /// @details
 ///     A vertex is a file (existing or not existing) found or processed
-///     by this tool.
-class Vertex {
+///     by this tool. Each vertex has a name and an absolute path. If the
+///     absolute path is empty, the name is used as the key of the vertex.
+///
+///     Vertices are plain indices: the table is a struct-of-arrays
+///     with one entry per vertex in each column. The strings are
+///     stored in a Path_Table, so paths which share a prefix share
+///     their storage. Vertex ids are the same as the vertex indices
+///     of the graph.
+class Vertex_Table {
  public:
-  /// @brief Smart pointer for Vertex
-  using Ptr = std::shared_ptr<Vertex>;
-
-  /// @brief A Map with string as key and a pointer to the Vertex as value.
-  using Map = std::map<std::string, Ptr>;
-
-  /// @brief Ctor
-  /// @param abs_path absolute path
-  /// @param name file name including file ending
-  explicit Vertex(std::string name, std::string abs_path = "");
+  /// @brief Default ctor.
+  Vertex_Table() = default;
 
   /// @brief Copy ctor: not implemented!
-  Vertex(const Vertex &other) = delete;
+  Vertex_Table(const Vertex_Table &other) = delete;
 
   /// @brief Assignment operator: not implemented!
-  Vertex &operator=(const Vertex &rhs) = delete;
+  Vertex_Table &operator=(const Vertex_Table &rhs) = delete;
 
   /// @brief Move constructor: not implemented!
-  Vertex(Vertex &&rhs) = delete;
+  Vertex_Table(Vertex_Table &&rhs) = delete;
 
   /// @brief Move assignment operator: not implemented!
-  Vertex &operator=(Vertex &&rhs) = delete;
+  Vertex_Table &operator=(Vertex_Table &&rhs) = delete;
 
   /// @brief Default dtor
-  ~Vertex() = default;
+  ~Vertex_Table() = default;
+
+  /// @brief Adds a vertex, if no vertex with the same key exists.
+  /// @param name file name including file ending
+  /// @param abs_path absolute path
+  /// @return The id of the vertex and true if it has been added.
+  std::pair<Vertex_Id, bool> insert(const std::string &name,
+                                    const std::string &abs_path);
+
+  /// @brief Returns the vertex with the given key or NO_VERTEX.
+  Vertex_Id find(const std::string &key) const;
 
   /// @brief Returns the name of the vertex.
-  std::string get_name() const;
+  std::string get_name(Vertex_Id id) const;
 
   /// @brief Returns the absolute path of the vertex.
-  std::string get_abs_path() const;
+  std::string get_abs_path(Vertex_Id id) const;
+
+  /// @brief Appends the name of the vertex to out.
+  void append_name(Vertex_Id id, std::string *out) const;
+
+  /// @brief Appends the absolute path of the vertex to out.
+  void append_abs_path(Vertex_Id id, std::string *out) const;
+
+  /// @brief Returns the number of vertices.
+  std::size_t size() const;
+
+  /// @brief Returns the underlying path storage.
+  const Path_Table &get_paths() const;
+
+  /// @brief Sets the size of a scanned file.
+  void set_file_size(Vertex_Id id, const File_Size &size);
+
+  /// @brief Returns the size of the file (zero if it was not scanned).
+  const File_Size &get_file_size(Vertex_Id id) const {
+    return file_sizes[id];
+  }
 
  private:
-  /// @brief file name, including file ending
-  const std::string name;
+  /// @brief Storage of all names and absolute paths.
+  Path_Table paths;
+
+  /// @brief Name of each vertex.
+  std::vector<Path_Table::Id> names;
+
+  /// @brief Absolute path of each vertex (Path_Table::NONE if empty).
+  std::vector<Path_Table::Id> abs_paths;
+
+  /// @brief Size of each vertex's file.
+  std::vector<File_Size> file_sizes;
 
-  /// @brief Absolute path
-  const std::string abs_path;
+  /// @brief Maps a path node (the key) to its vertex.
+  std::vector<Vertex_Id> vertex_by_node;
 
-};  // class Vertex
+};  // class Vertex_Table
 
 }  // namespace INCLUDE_GARDENER
 
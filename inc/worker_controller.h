@@ -0,0 +1,161 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef WORKER_CONTROLLER_H
+#define WORKER_CONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace INCLUDE_GARDENER {
+
+/// @brief Adapts the number of active worker threads (-j auto).
+/// @details
+///   The workers report each job (wall and CPU time of the thread). Every
+///   INTERVAL, the files per second and the fraction of the wall time in
+///   which the workers were blocked (wall time minus CPU time, e.g.
+///   reading cold files) are evaluated:
+///    - If the workers are mostly blocked (>= IO_BOUND_FRACTION), up to
+///      max_workers may be active, otherwise up to n_cpus.
+///    - Below the bound, one more worker is tried. If the throughput
+///      drops by more than TOLERANCE after a change, the change is
+///      reverted and the count is held for one interval (hill climbing).
+///   The controller is thread-safe.
+class Worker_Controller {
+ public:
+  /// @brief Clock of the measurements.
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief Period of the evaluations.
+  static constexpr std::chrono::milliseconds INTERVAL{100};
+
+  /// @brief Blocked fraction above which more workers than CPUs are used.
+  static constexpr double IO_BOUND_FRACTION = 0.25;
+
+  /// @brief Relative throughput change which is considered as noise.
+  static constexpr double TOLERANCE = 0.05;
+
+  /// @brief Ctor: starts with min(n_cpus, max_workers) active workers.
+  /// @param n_cpus The CPU budget (see get_cpu_budget()).
+  /// @param max_workers Number of worker threads.
+  Worker_Controller(unsigned int n_cpus, unsigned int max_workers);
+
+  /// @brief Copy ctor: not implemented!
+  Worker_Controller(const Worker_Controller &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Worker_Controller &operator=(const Worker_Controller &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Worker_Controller(Worker_Controller &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Worker_Controller &operator=(Worker_Controller &&rhs) = delete;
+
+  /// @brief Default dtor
+  ~Worker_Controller() = default;
+
+  /// @brief Returns the number of workers which shall take jobs.
+  unsigned int get_n_active() const;
+
+  /// @brief Records a finished job.
+  /// @param now End of the job.
+  /// @param wall_ns Duration of the job.
+  /// @param cpu_ns CPU time of the worker thread during the job.
+  /// @return True if the number of active workers changed.
+  bool add_job(Clock::time_point now, std::uint64_t wall_ns,
+               std::uint64_t cpu_ns);
+
+  /// @brief Evaluates one interval.
+  /// @param files_per_second Throughput of the interval.
+  /// @param blocked_fraction Fraction of the wall time of the jobs in
+  ///        which the workers did not run.
+  /// @return The new number of active workers.
+  unsigned int evaluate(double files_per_second, double blocked_fraction);
+
+  /// @brief Returns the CPU time of the calling thread in nanoseconds.
+  static std::uint64_t get_thread_cpu_ns();
+
+  /// @brief Returns the number of CPUs this process may use.
+  /// @details
+  ///   The minimum of the CPUs in the affinity mask and the CPU quota of
+  ///   the process's cgroup and its ancestors (cgroup v2 cpu.max or v1
+  ///   cpu.cfs_quota_us, the cgroup is taken from /proc/self/cgroup),
+  ///   rounded up; at least 1.
+  static unsigned int get_cpu_budget();
+
+  /// @brief Parses the content of /proc/self/cgroup.
+  /// @param content The content.
+  /// @param controller A cgroup v1 controller (e.g. "cpu"), or empty for
+  ///        the cgroup v2 hierarchy.
+  /// @return The path of the cgroup or nothing if not found.
+  static std::optional<std::string> parse_cgroup_path(
+      const std::string &content, const std::string &controller);
+
+  /// @brief Parses the content of a cgroup v2 cpu.max file
+  ///        ("<quota> <period>" or "max <period>").
+  /// @return The quota in CPUs or nothing if unlimited / invalid.
+  static std::optional<double> parse_cpu_max(const std::string &content);
+
+ private:
+  /// @brief The CPU budget.
+  const unsigned int n_cpus;
+
+  /// @brief Number of worker threads.
+  const unsigned int max_workers;
+
+  /// @brief Protects all members below.
+  mutable std::mutex mutex;
+
+  /// @brief Number of workers which shall take jobs.
+  unsigned int n_active;
+
+  /// @brief Change of n_active in the last evaluation.
+  int last_step;
+
+  /// @brief Throughput of the last interval.
+  double last_throughput;
+
+  /// @brief Start of the current interval (set by the first job).
+  std::optional<Clock::time_point> interval_start;
+
+  /// @brief Finished jobs in the current interval.
+  std::uint64_t n_jobs;
+
+  /// @brief Wall time of the jobs in the current interval.
+  std::uint64_t wall_ns;
+
+  /// @brief Blocked time of the jobs in the current interval.
+  std::uint64_t blocked_ns;
+
+  /// @brief Evaluates one interval (mutex must be held).
+  unsigned int evaluate_locked(double files_per_second,
+                               double blocked_fraction);
+
+};  // class Worker_Controller
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // WORKER_CONTROLLER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
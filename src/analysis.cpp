@@ -0,0 +1,125 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "analysis.h"
+
+#include <memory>
+#include <stdexcept>
+
+#include <boost/log/trivial.hpp>
+
+#include "file_detector.h"
+#include "run_stats.h"
+#include "scan_cache.h"
+#include "statement_detector.h"
+#include "trace.h"
+
+using std::make_shared;
+
+namespace po = boost::program_options;
+
+namespace INCLUDE_GARDENER {
+
+/// @details
+///   The solvers are configured via their command line options, so the
+///   options are passed as variables_map.
+Solver::Ptr make_solver(const Analysis_Options &options) {
+  auto solver = Solver::get_solver(options.language);
+  if (solver == nullptr) {
+    throw std::invalid_argument("Unsupported language \"" + options.language +
+                                "\"");
+  }
+  po::variables_map vm;
+  vm.insert({"process-path", po::variable_value(options.process_paths, false)});
+  if (!options.include_paths.empty()) {
+    vm.insert(
+        {"c-include-path", po::variable_value(options.include_paths, false)});
+    vm.insert({"ruby-include-path",
+               po::variable_value(options.include_paths, false)});
+  }
+  solver->extract_options(vm);
+  return solver;
+}
+
+void build_graph(const Solver::Ptr &solver, const Analysis_Options &options) {
+  auto phase_start = Run_Stats::Clock::now();
+  auto end_phase = [&phase_start](const char *name) {
+    const auto now = Run_Stats::Clock::now();
+    Run_Stats::add_phase(name, now - phase_start);
+    Trace::record(name, phase_start, now);
+    phase_start = now;
+  };
+
+  // Get all files ...
+  File_Detector input_files(solver->get_file_regex(), options.exclude,
+                            options.process_paths, options.recursive_limit);
+  input_files.set_shard(options.shard);
+  input_files.get(solver);
+  if (options.shard.is_partial()) {
+    BOOST_LOG_TRIVIAL(info) << "Shard " << options.shard.index << "/"
+                            << options.shard.count << ": skipping "
+                            << input_files.get_n_other_shards() << " files";
+  }
+  end_phase("walk");
+
+  // ... and scan them (with the cache of the previous run, if any).
+  Scan_Cache::Ptr cache;
+  if (!options.cache_file.empty()) {
+    cache = make_shared<Scan_Cache>(options.cache_file,
+                                    solver->get_statement_regex());
+  }
+  // The walk names the vertices, so it ends before the scan adds any.
+  // Its files are handed over one by one as paths from the vertex table,
+  // only the ids of the files are kept.
+  Statement_Detector s_detector(solver, options.n_threads, cache,
+                                options.queue_capacity, options.max_memory,
+                                options.uring_depth, options.n_resolvers);
+  for (auto id : input_files.take_ids()) {
+    s_detector.add_job(solver->get_abs_path(id));
+  }
+  s_detector.wait_for_workers();
+  BOOST_LOG_TRIVIAL(info) << "Skipped " << s_detector.get_n_reused()
+                          << " byte-identical files";
+  if (s_detector.get_n_throttled() > 0) {
+    BOOST_LOG_TRIVIAL(info) << "Handed over " << s_detector.get_n_throttled()
+                            << " files in batches because of the memory "
+                               "limit";
+  }
+  end_phase("scan");
+
+  if (cache) {
+    BOOST_LOG_TRIVIAL(info) << "Scan cache: " << cache->get_n_hits()
+                            << " hits, " << cache->get_n_misses() << " misses";
+    if (!cache->save()) {
+      BOOST_LOG_TRIVIAL(warning)
+          << "Failed to write the scan cache " << options.cache_file;
+    }
+  }
+}
+
+Include_Graph analyze(const Solver::Ptr &solver,
+                      const Analysis_Options &options) {
+  build_graph(solver, options);
+  return Include_Graph(solver);
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
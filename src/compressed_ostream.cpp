@@ -0,0 +1,347 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "compressed_ostream.h"
+
+#include <stdexcept>
+
+#ifdef GARDENER_WITH_ZLIB
+#define ZLIB_CONST
+#include <zlib.h>
+#endif
+#ifdef GARDENER_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+using std::lock_guard;
+using std::mutex;
+using std::optional;
+using std::ostream;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Upper bound of compressed output per compress() call and step.
+constexpr size_t OUT_STEP = 1U << 16U;
+
+#ifdef GARDENER_WITH_ZLIB
+/// @brief gzip back-end (zlib deflate with gzip wrapper).
+class Gzip_Compressor : public Compressing_Buffer::Compressor {
+ public:
+  explicit Gzip_Compressor(int level) : stream{} {
+    if (level == Compression::DEFAULT_LEVEL) {
+      level = Z_DEFAULT_COMPRESSION;
+    }
+    // 15 window bits + 16 selects the gzip wrapper
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw runtime_error("Failed to initialize gzip compression (level " +
+                          std::to_string(level) + ")");
+    }
+  }
+
+  Gzip_Compressor(const Gzip_Compressor &other) = delete;
+  Gzip_Compressor &operator=(const Gzip_Compressor &rhs) = delete;
+  Gzip_Compressor(Gzip_Compressor &&rhs) = delete;
+  Gzip_Compressor &operator=(Gzip_Compressor &&rhs) = delete;
+
+  ~Gzip_Compressor() override { deflateEnd(&stream); }
+
+  void compress(const char *data, size_t size, Mode mode,
+                string *out) override {
+    stream.next_in = reinterpret_cast<const Bytef *>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    const bool finish = mode == Mode::FINISH;
+    const int flush =
+        finish ? Z_FINISH : mode == Mode::FLUSH ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+    int result;
+    do {
+      const size_t start = out->size();
+      out->resize(start + OUT_STEP);
+      stream.next_out = reinterpret_cast<Bytef *>(&(*out)[start]);
+      stream.avail_out = static_cast<uInt>(OUT_STEP);
+      result = deflate(&stream, flush);
+      if (result == Z_STREAM_ERROR) {
+        throw runtime_error("gzip compression failed");
+      }
+      out->resize(start + OUT_STEP - stream.avail_out);
+    } while (stream.avail_out == 0 || (finish && result != Z_STREAM_END));
+  }
+
+ private:
+  z_stream stream;
+};
+#endif
+
+#ifdef GARDENER_WITH_ZSTD
+/// @brief zstd back-end (streaming API).
+class Zstd_Compressor : public Compressing_Buffer::Compressor {
+ public:
+  explicit Zstd_Compressor(int level) : context(ZSTD_createCCtx()) {
+    if (context == nullptr) {
+      throw runtime_error("Failed to initialize zstd compression");
+    }
+    if (level == Compression::DEFAULT_LEVEL) {
+      level = ZSTD_CLEVEL_DEFAULT;
+    }
+    if (ZSTD_isError(ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel,
+                                            level)) != 0U) {
+      ZSTD_freeCCtx(context);
+      throw runtime_error("Invalid zstd compression level " +
+                          std::to_string(level));
+    }
+  }
+
+  Zstd_Compressor(const Zstd_Compressor &other) = delete;
+  Zstd_Compressor &operator=(const Zstd_Compressor &rhs) = delete;
+  Zstd_Compressor(Zstd_Compressor &&rhs) = delete;
+  Zstd_Compressor &operator=(Zstd_Compressor &&rhs) = delete;
+
+  ~Zstd_Compressor() override { ZSTD_freeCCtx(context); }
+
+  void compress(const char *data, size_t size, Mode mode,
+                string *out) override {
+    ZSTD_inBuffer in = {data, size, 0};
+    const auto directive = mode == Mode::FINISH  ? ZSTD_e_end
+                           : mode == Mode::FLUSH ? ZSTD_e_flush
+                                                 : ZSTD_e_continue;
+    size_t remaining;
+    do {
+      const size_t start = out->size();
+      out->resize(start + OUT_STEP);
+      ZSTD_outBuffer buf = {&(*out)[start], OUT_STEP, 0};
+      remaining = ZSTD_compressStream2(context, &buf, &in, directive);
+      if (ZSTD_isError(remaining) != 0U) {
+        throw runtime_error(string("zstd compression failed: ") +
+                            ZSTD_getErrorName(remaining));
+      }
+      out->resize(start + buf.pos);
+    } while (in.pos < in.size ||
+             (directive != ZSTD_e_continue && remaining != 0));
+  }
+
+ private:
+  ZSTD_CCtx *context;
+};
+#endif
+
+std::unique_ptr<Compressing_Buffer::Compressor> make_compressor(
+    const Compression &compression) {
+  switch (compression.method) {
+#ifdef GARDENER_WITH_ZLIB
+    case Compression::Method::GZIP:
+      return std::make_unique<Gzip_Compressor>(compression.level);
+#endif
+#ifdef GARDENER_WITH_ZSTD
+    case Compression::Method::ZSTD:
+      return std::make_unique<Zstd_Compressor>(compression.level);
+#endif
+    default:
+      throw runtime_error("Unsupported compression method");
+  }
+}
+
+}  // namespace
+
+optional<Compression> Compression::parse(const string &spec) {
+  Compression compression;
+  const auto colon = spec.find(':');
+  const string method = spec.substr(0, colon);
+  if ("gzip" == method) {
+    compression.method = Method::GZIP;
+  } else if ("zstd" == method) {
+    compression.method = Method::ZSTD;
+  } else if ("none" == method && colon == string::npos) {
+    return compression;
+  } else {
+    return {};
+  }
+
+  if (colon != string::npos) {
+    const string level = spec.substr(colon + 1);
+    if (level.empty() ||
+        level.find_first_not_of("0123456789") != string::npos ||
+        level.size() > 2) {
+      return {};
+    }
+    compression.level = std::stoi(level);
+    const int max_level = compression.method == Method::GZIP ? 9 : 22;
+    if (compression.level < 1 || compression.level > max_level) {
+      return {};
+    }
+  }
+  return compression;
+}
+
+bool Compression::is_supported(Method method) {
+  switch (method) {
+    case Method::NONE:
+      return true;
+    case Method::GZIP:
+#ifdef GARDENER_WITH_ZLIB
+      return true;
+#else
+      return false;
+#endif
+    case Method::ZSTD:
+#ifdef GARDENER_WITH_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+Compressing_Buffer::Compressing_Buffer(ostream &sink,
+                                       const Compression &compression,
+                                       bool sync_flush)
+    : sink(sink),
+      compressor(make_compressor(compression)),
+      current(CHUNK_SIZE),
+      sync_flush(sync_flush),
+      closed(false),
+      worker(&Compressing_Buffer::compress_loop, this) {
+  setp(current.data(), current.data() + current.size());
+}
+
+Compressing_Buffer::~Compressing_Buffer() {
+  try {
+    close();
+  } catch (...) {
+    // errors are only reported by an explicit close()
+  }
+}
+
+void Compressing_Buffer::close() {
+  if (closed) {
+    return;
+  }
+  closed = true;
+  hand_over(Compressor::Mode::FINISH);
+  worker.join();
+  sink.flush();
+  if (!error.empty()) {
+    throw runtime_error(error);
+  }
+  if (!sink) {
+    throw runtime_error("Failed to write compressed output");
+  }
+}
+
+Compressing_Buffer::int_type Compressing_Buffer::overflow(int_type ch) {
+  if (closed) {
+    return traits_type::eof();
+  }
+  hand_over(Compressor::Mode::CONTINUE);
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+int Compressing_Buffer::sync() {
+  if (!closed && pptr() != pbase()) {
+    hand_over(sync_flush ? Compressor::Mode::FLUSH
+                         : Compressor::Mode::CONTINUE);
+  }
+  return 0;
+}
+
+void Compressing_Buffer::hand_over(Compressor::Mode mode) {
+  const auto size = static_cast<size_t>(pptr() - pbase());
+  {
+    unique_lock<mutex> lck(queue_mutex);
+    queue_condition.wait(
+        lck, [this] { return pending.size() < MAX_PENDING_CHUNKS; });
+    pending.push_back(Chunk{std::move(current), size, mode});
+    if (free_chunks.empty()) {
+      current = vector<char>(CHUNK_SIZE);
+    } else {
+      current = std::move(free_chunks.back());
+      free_chunks.pop_back();
+    }
+  }
+  queue_condition.notify_all();
+  setp(current.data(), current.data() + current.size());
+}
+
+/// @details
+///   After an error, the remaining chunks are dropped but still taken from
+///   the queue, so the writing thread never blocks forever.
+void Compressing_Buffer::compress_loop() {
+  string out;
+  bool failed = false;
+  for (;;) {
+    Chunk chunk;
+    {
+      unique_lock<mutex> lck(queue_mutex);
+      queue_condition.wait(lck, [this] { return !pending.empty(); });
+      chunk = std::move(pending.front());
+      pending.pop_front();
+    }
+    queue_condition.notify_all();
+
+    if (!failed) {
+      try {
+        out.clear();
+        compressor->compress(chunk.data.data(), chunk.size, chunk.mode,
+                             &out);
+        sink.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (chunk.mode == Compressor::Mode::FLUSH) {
+          sink.flush();
+        }
+      } catch (const std::exception &e) {
+        lock_guard<mutex> lck(queue_mutex);
+        error = e.what();
+        failed = true;
+      }
+    }
+
+    if (chunk.mode == Compressor::Mode::FINISH) {
+      return;
+    }
+    lock_guard<mutex> lck(queue_mutex);
+    free_chunks.push_back(std::move(chunk.data));
+  }
+}
+
+Compressed_Ostream::Compressed_Ostream(ostream &sink,
+                                       const Compression &compression,
+                                       bool sync_flush)
+    : std::ostream(nullptr), buffer(sink, compression, sync_flush) {
+  rdbuf(&buffer);
+}
+
+void Compressed_Ostream::close() {
+  flush();
+  buffer.close();
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
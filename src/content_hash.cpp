@@ -0,0 +1,119 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "content_hash.h"
+
+#include <cstring>
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+constexpr uint64_t PRIME_1 = 11400714785074694791ULL;
+constexpr uint64_t PRIME_2 = 14029467366897019727ULL;
+constexpr uint64_t PRIME_3 = 1609587929392839161ULL;
+constexpr uint64_t PRIME_4 = 9650029242287828579ULL;
+constexpr uint64_t PRIME_5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, unsigned int r) {
+  return (x << r) | (x >> (64U - r));
+}
+
+inline uint64_t read64(const unsigned char *p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t read32(const unsigned char *p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+  acc += input * PRIME_2;
+  return rotl(acc, 31) * PRIME_1;
+}
+
+inline uint64_t merge_round(uint64_t acc, uint64_t val) {
+  acc ^= round(0, val);
+  return acc * PRIME_1 + PRIME_4;
+}
+
+}  // namespace
+
+uint64_t content_hash(const void *data, size_t size, uint64_t seed) {
+  const auto *p = static_cast<const unsigned char *>(data);
+  const unsigned char *const end = p + size;
+  uint64_t h;
+
+  if (size >= 32) {
+    uint64_t v1 = seed + PRIME_1 + PRIME_2;
+    uint64_t v2 = seed + PRIME_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME_1;
+    const unsigned char *const limit = end - 32;
+    do {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    h = merge_round(h, v4);
+  } else {
+    h = seed + PRIME_5;
+  }
+
+  h += static_cast<uint64_t>(size);
+  for (; p + 8 <= end; p += 8) {
+    h ^= round(0, read64(p));
+    h = rotl(h, 27) * PRIME_1 + PRIME_4;
+  }
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(read32(p)) * PRIME_1;
+    h = rotl(h, 23) * PRIME_2 + PRIME_3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= (*p) * PRIME_5;
+    h = rotl(h, 11) * PRIME_1;
+  }
+
+  h ^= h >> 33U;
+  h *= PRIME_2;
+  h ^= h >> 29U;
+  h *= PRIME_3;
+  h ^= h >> 32U;
+  return h;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,71 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "csr_graph.h"
+
+#include <boost/range/iterator_range.hpp>
+
+using std::size_t;
+
+namespace INCLUDE_GARDENER {
+
+Csr_Graph::Csr_Graph(const Graph &graph) {
+  const auto n_vertices = static_cast<Vertex_Id>(boost::num_vertices(graph));
+  first.reserve(n_vertices + 1);
+  targets.reserve(boost::num_edges(graph));
+  lines.reserve(boost::num_edges(graph));
+  first.push_back(0);
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+      targets.push_back(static_cast<Vertex_Id>(boost::target(e, graph)));
+      lines.push_back(graph[e].line);
+    }
+    first.push_back(targets.size());
+  }
+}
+
+Csr_Graph Csr_Graph::reversed() const {
+  const Vertex_Id n_vertices = get_n_vertices();
+  Csr_Graph r;
+  r.first.assign(n_vertices + 1, 0);
+  r.targets.resize(targets.size());
+  r.lines.resize(lines.size());
+
+  // counting sort by target
+  for (auto t : targets) {
+    ++r.first[t + 1];
+  }
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    r.first[v + 1] += r.first[v];
+  }
+  std::vector<size_t> next(r.first.begin(), r.first.end() - 1);
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    for (size_t e = first[v]; e < first[v + 1]; ++e) {
+      const size_t pos = next[targets[e]]++;
+      r.targets[pos] = v;
+      r.lines[pos] = lines[e];
+    }
+  }
+  return r;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,102 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "cycles.h"
+
+#include <algorithm>
+#include <limits>
+
+using std::size_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+constexpr size_t NO_EDGE = std::numeric_limits<size_t>::max();
+
+}  // namespace
+
+vector<Include_Cycle> find_cycles(const Csr_Graph &graph,
+                                  const Strong_Components &components) {
+  vector<Include_Cycle> cycles;
+
+  // edge over which each vertex was reached by the current search
+  vector<size_t> via(graph.get_n_vertices(), NO_EDGE);
+  vector<Vertex_Id> source(graph.get_n_vertices(), NO_VERTEX);
+  vector<Vertex_Id> queue;
+
+  for (Strong_Components::Id c = 0; c < components.size(); ++c) {
+    Vertex_Id start = NO_VERTEX;
+    for (auto i = components.get_first_member(c);
+         i < components.get_end_member(c); ++i) {
+      start = std::min(start, components.get_member(i));
+    }
+
+    // breadth-first search within c, until an edge back to start is found
+    size_t closing_edge = NO_EDGE;
+    Vertex_Id last = NO_VERTEX;
+    queue.assign(1, start);
+    for (size_t q = 0; q < queue.size() && closing_edge == NO_EDGE; ++q) {
+      const Vertex_Id v = queue[q];
+      for (auto e = graph.get_first_edge(v); e < graph.get_end_edge(v); ++e) {
+        const Vertex_Id w = graph.get_target(e);
+        if (w == start) {
+          closing_edge = e;
+          last = v;
+          break;
+        }
+        if (components.get_component(w) == c && via[w] == NO_EDGE) {
+          via[w] = e;
+          source[w] = v;
+          queue.push_back(w);
+        }
+      }
+    }
+
+    if (closing_edge != NO_EDGE) {
+      Include_Cycle cycle;
+      cycle.component_size = components.get_n_members(c);
+      cycle.vertices.push_back(last);
+      cycle.lines.push_back(graph.get_line(closing_edge));
+      for (Vertex_Id v = last; v != start; v = source[v]) {
+        cycle.vertices.push_back(source[v]);
+        cycle.lines.push_back(graph.get_line(via[v]));
+      }
+      std::reverse(cycle.vertices.begin(), cycle.vertices.end());
+      std::reverse(cycle.lines.begin(), cycle.lines.end());
+      cycles.push_back(std::move(cycle));
+    }
+
+    for (auto v : queue) {
+      via[v] = NO_EDGE;
+    }
+  }
+
+  std::sort(cycles.begin(), cycles.end(),
+            [](const Include_Cycle &a, const Include_Cycle &b) {
+              return a.vertices.front() < b.vertices.front();
+            });
+  return cycles;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
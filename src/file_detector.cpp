@@ -19,6 +19,7 @@
 // <http://www.gnu.org/licenses/>.
 //
 #include "file_detector.h"
+#include "gardener_log.h"
 #include "helper.h"
 
 #include <boost/filesystem.hpp>
@@ -38,7 +39,8 @@ File_Detector::File_Detector(const string& file_regex,
       exclude_regex(init_regex_vector(exclude_regex)),
       process_paths(move(process_paths)),
       use_exclude_regex(!exclude_regex.empty()),
-      recursive_limit(recursive_limit) {}
+      recursive_limit(recursive_limit),
+      n_other_shards(0) {}
 
 vector<regex> File_Detector::get_exclude_regex() { return exclude_regex; }
 
@@ -49,16 +51,16 @@ vector<regex> File_Detector::get_exclude_regex() { return exclude_regex; }
 ///
 bool File_Detector::use_file(const std::string& file) const {
   if (use_exclude_regex && exclude_check(file)) {
-    BOOST_LOG_TRIVIAL(trace) << "Excluding " << file;
+    GARDENER_LOG(trace) << "Excluding " << file;
     return false;
   }
 
   if (!regex_search(file, file_regex)) {
-    BOOST_LOG_TRIVIAL(trace) << "Ignoring " << file;
+    GARDENER_LOG(trace) << "Ignoring " << file;
     return false;
   }
 
-  BOOST_LOG_TRIVIAL(trace) << "Considering " << file;
+  GARDENER_LOG(trace) << "Considering " << file;
   return true;
 }
 
@@ -89,6 +91,35 @@ void File_Detector::get(Solver::Ptr solver) {
   }
 }
 
+vector<Vertex_Id> File_Detector::take_ids() {
+  vector<Vertex_Id> taken;
+  taken.swap(file_ids);
+  return taken;
+}
+
+/// @details
+///   The base directories are resolved like in get() and canonicalized,
+///   because the walk stores canonical absolute paths.
+string File_Detector::get_name(const vector<string>& process_paths,
+                               const string& abs_path) {
+  using boost::filesystem::current_path;
+  using boost::filesystem::exists;
+  using boost::filesystem::path;
+  using boost::filesystem::operator/;
+  for (const auto& p : process_paths) {
+    path base = current_path() / p;
+    if (!exists(base)) {
+      base = p;
+    }
+    boost::system::error_code ec;
+    auto prefix = canonical(base, ec).string() + "/";
+    if (!ec && abs_path.compare(0, prefix.size(), prefix) == 0) {
+      return abs_path.substr(prefix.size());
+    }
+  }
+  return abs_path;
+}
+
 /// @details
 ///   Runs through all entries. If an entry is a file,  it is processed.
 ///   In case of an directory, a recursive call is done.
@@ -134,12 +165,16 @@ bool File_Detector::walk_tree(const string& base_path,
         continue;
       }
 
-      BOOST_LOG_TRIVIAL(trace) << "(Absolute path=" << itr_path << ")";
-      solver->add_vertex(name, itr_path);
-      files.push_back(itr_path);
+      GARDENER_LOG(trace) << "(Absolute path=" << itr_path << ")";
+      const auto id = solver->add_vertex(name, itr_path);
+      if (shard.contains(name)) {
+        file_ids.push_back(id);
+      } else {
+        ++n_other_shards;
+      }
     } else {
       // ignore all other files
-      BOOST_LOG_TRIVIAL(trace) << "Ignoring " << itr_path;
+      GARDENER_LOG(trace) << "Ignoring " << itr_path;
     }
   }
   return true;
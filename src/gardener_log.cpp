@@ -0,0 +1,130 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "gardener_log.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/attributes/current_thread_id.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/block_on_overflow.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/support/date_time.hpp>
+#include <boost/log/utility/setup/common_attributes.hpp>
+
+using std::lock_guard;
+using std::mutex;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+namespace sinks = boost::log::sinks;
+
+using Backend = sinks::text_ostream_backend;
+using Async_Sink = sinks::asynchronous_sink<
+    Backend, sinks::bounded_fifo_queue<Logging::MAX_PENDING_RECORDS,
+                                       sinks::block_on_overflow>>;
+using Sync_Sink = sinks::synchronous_sink<Backend>;
+
+/// @brief Protects current_sink and async_sink.
+mutex sink_mutex;
+
+/// @brief The sink added by Logging::init (if any).
+boost::shared_ptr<sinks::sink> current_sink;
+
+/// @brief The same sink, if it is asynchronous.
+boost::shared_ptr<Async_Sink> async_sink;
+
+/// @brief Sets the record format and adds the sink to the logging core.
+template <typename Sink>
+void set_up(const boost::shared_ptr<Sink> &sink) {
+  namespace expr = boost::log::expressions;
+  sink->set_formatter(
+      expr::stream
+      << "["
+      << expr::format_date_time<boost::posix_time::ptime>(
+             "TimeStamp", "%Y-%m-%d %H:%M:%S.%f")
+      << "] ["
+      << expr::attr<boost::log::attributes::current_thread_id::value_type>(
+             "ThreadID")
+      << "] [" << boost::log::trivial::severity << "] " << expr::smessage);
+  boost::log::core::get()->add_sink(sink);
+}
+
+}  // namespace
+
+/// @details
+///   The command-line tool logs to stderr, because Boost.Log's default
+///   sink writes to stdout, which would be mixed with the graph.
+void Logging::init(bool async, std::ostream &os) {
+  shutdown();
+  auto backend = boost::make_shared<Backend>();
+  backend->add_stream(
+      boost::shared_ptr<std::ostream>(&os, boost::null_deleter()));
+  backend->auto_flush(true);
+  boost::shared_ptr<sinks::sink> sink;
+  boost::shared_ptr<Async_Sink> async_frontend;
+  if (async) {
+    async_frontend = boost::make_shared<Async_Sink>(backend);
+    set_up(async_frontend);
+    sink = async_frontend;
+    static std::once_flag registered;
+    std::call_once(registered, [] { std::atexit(&Logging::shutdown); });
+  } else {
+    auto sync_frontend = boost::make_shared<Sync_Sink>(backend);
+    set_up(sync_frontend);
+    sink = sync_frontend;
+  }
+  {
+    lock_guard<mutex> lck(sink_mutex);
+    current_sink = sink;
+    async_sink = async_frontend;
+  }
+  boost::log::add_common_attributes();
+}
+
+void Logging::shutdown() {
+  boost::shared_ptr<sinks::sink> sink;
+  boost::shared_ptr<Async_Sink> async_frontend;
+  {
+    lock_guard<mutex> lck(sink_mutex);
+    sink.swap(current_sink);
+    async_frontend.swap(async_sink);
+  }
+  if (sink) {
+    boost::log::core::get()->remove_sink(sink);
+  }
+  if (async_frontend) {
+    async_frontend->stop();
+    async_frontend->flush();
+  }
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,295 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "graph_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/range/iterator_range.hpp>
+
+using std::ostream;
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::uint32_t;
+using std::uint64_t;
+using std::unordered_map;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Rounds offset up to the next multiple of 8.
+uint64_t align(uint64_t offset) { return (offset + 7U) & ~uint64_t{7U}; }
+
+/// @brief Size of n + extra elements, UINT64_MAX if this overflows.
+uint64_t array_size(uint64_t n, uint64_t element_size, uint64_t extra = 0) {
+  const auto max_n = std::numeric_limits<uint64_t>::max() / element_size;
+  return n > max_n - extra ? std::numeric_limits<uint64_t>::max()
+                           : (n + extra) * element_size;
+}
+
+/// @brief True if the n values are in ascending order and the last one
+///        is at most max.
+bool is_ascending(const uint64_t *values, uint64_t n, uint64_t max) {
+  return std::is_sorted(values, values + n) && (n == 0 || values[n - 1] <= max);
+}
+
+/// @brief True if all n vertex ids are below n_vertices.
+bool are_vertex_ids(const uint32_t *ids, uint64_t n, uint64_t n_vertices) {
+  return std::all_of(ids, ids + n,
+                     [n_vertices](uint32_t id) { return id < n_vertices; });
+}
+
+/// @brief Writes a section and pads it to 8-byte alignment.
+template <class T>
+void write_section(ostream &os, const T *values, uint64_t n) {
+  static const char padding[8] = {};
+  auto n_bytes = n * sizeof(T);
+  if (n_bytes > 0) {
+    os.write(reinterpret_cast<const char *>(values),
+             static_cast<std::streamsize>(n_bytes));
+  }
+  os.write(padding, static_cast<std::streamsize>(align(n_bytes) - n_bytes));
+}
+
+}  // namespace
+
+/// @details
+///   Identical strings are stored only once. The key index is sorted
+///   by the byte-wise order of the keys (see Graph_File::find).
+void write_graph_file(ostream &os, const Graph &graph,
+                      const Vertex_Table &vertexes) {
+  const uint64_t n_vertices = vertexes.size();
+  const uint64_t n_edges = boost::num_edges(graph);
+
+  vector<uint64_t> string_offsets{0};
+  string string_data;
+  unordered_map<string, uint32_t> string_ids;
+  auto add_string = [&](string str) {
+    auto itr = string_ids.find(str);
+    if (itr != string_ids.end()) {
+      return itr->second;
+    }
+    auto idx = static_cast<uint32_t>(string_offsets.size() - 1);
+    string_data.append(str);
+    string_offsets.push_back(string_data.size());
+    string_ids.emplace(std::move(str), idx);
+    return idx;
+  };
+
+  vector<Graph_File_Vertex> vertex_records(n_vertices);
+  vector<uint32_t> keys(n_vertices);
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    auto &record = vertex_records[v];
+    record.name = add_string(vertexes.get_name(v));
+    auto abs_path = vertexes.get_abs_path(v);
+    record.abs_path = abs_path.empty() ? NO_STRING : add_string(abs_path);
+    keys[v] = record.abs_path == NO_STRING ? record.name : record.abs_path;
+  }
+
+  auto string_at = [&](uint32_t idx) {
+    return string_view(string_data)
+        .substr(string_offsets[idx],
+                string_offsets[idx + 1] - string_offsets[idx]);
+  };
+  vector<uint32_t> key_index(n_vertices);
+  std::iota(key_index.begin(), key_index.end(), 0U);
+  std::sort(key_index.begin(), key_index.end(), [&](uint32_t a, uint32_t b) {
+    return string_at(keys[a]) < string_at(keys[b]);
+  });
+
+  vector<uint64_t> rows;
+  vector<uint32_t> targets;
+  vector<int32_t> lines;
+  vector<uint32_t> counts;
+  rows.reserve(n_vertices + 1);
+  targets.reserve(n_edges);
+  lines.reserve(n_edges);
+  counts.reserve(n_edges);
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    rows.push_back(targets.size());
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+      targets.push_back(static_cast<uint32_t>(boost::target(e, graph)));
+      lines.push_back(graph[e].line);
+      counts.push_back(graph[e].count);
+    }
+  }
+  rows.push_back(targets.size());
+
+  Graph_File_Header header{};
+  std::memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+  header.version = GRAPH_FILE_VERSION;
+  header.endian = GRAPH_FILE_ENDIAN;
+  header.n_vertices = n_vertices;
+  header.n_edges = n_edges;
+  header.n_strings = string_offsets.size() - 1;
+  header.string_offsets = align(sizeof(header));
+  header.string_data =
+      header.string_offsets + align(string_offsets.size() * sizeof(uint64_t));
+  header.vertices = header.string_data + align(string_data.size());
+  header.key_index =
+      header.vertices + align(n_vertices * sizeof(Graph_File_Vertex));
+  header.rows = header.key_index + align(n_vertices * sizeof(uint32_t));
+  header.targets = header.rows + align(rows.size() * sizeof(uint64_t));
+  header.lines = header.targets + align(n_edges * sizeof(uint32_t));
+  header.counts = header.lines + align(n_edges * sizeof(int32_t));
+  header.file_size = header.counts + align(n_edges * sizeof(uint32_t));
+
+  write_section(os, &header, 1);
+  write_section(os, string_offsets.data(), string_offsets.size());
+  write_section(os, string_data.data(), string_data.size());
+  write_section(os, vertex_records.data(), n_vertices);
+  write_section(os, key_index.data(), n_vertices);
+  write_section(os, rows.data(), rows.size());
+  write_section(os, targets.data(), n_edges);
+  write_section(os, lines.data(), n_edges);
+  write_section(os, counts.data(), n_edges);
+}
+
+Graph_File::Graph_File(const string &path)
+    : file(path),
+      data(file.get_content().data()),
+      size(file.get_content().size()),
+      header(nullptr) {
+  if (!file.is_open()) {
+    throw runtime_error("Failed to read graph file " + path + ": " +
+                        std::strerror(errno));
+  }
+  if (size == 0) {
+    throw runtime_error("Failed to read graph file " + path);
+  }
+  header = section<Graph_File_Header>(0);
+  validate(path);
+}
+
+/// @details
+///   The header, the section bounds, the string offsets, the rows and
+///   the vertex ids of the key index and the targets are checked.
+///   String indices are checked on access (see get_string), lines and
+///   counts are plain values which need no check.
+void Graph_File::validate(const string &path) const {
+  if (size < sizeof(Graph_File_Header) ||
+      std::memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic)) !=
+          0) {
+    throw runtime_error(path + " is not a binary graph file");
+  }
+  if (header->endian != GRAPH_FILE_ENDIAN) {
+    throw runtime_error(path + " has been written with another byte order");
+  }
+  if (header->version != GRAPH_FILE_VERSION) {
+    throw runtime_error(path + " has unsupported version " +
+                        std::to_string(header->version));
+  }
+  const auto n_v = header->n_vertices;
+  const auto n_e = header->n_edges;
+  const std::pair<uint64_t, uint64_t> sections[] = {
+      {header->string_offsets,
+       array_size(header->n_strings, sizeof(uint64_t), 1)},
+      {header->vertices, array_size(n_v, sizeof(Graph_File_Vertex))},
+      {header->key_index, array_size(n_v, sizeof(uint32_t))},
+      {header->rows, array_size(n_v, sizeof(uint64_t), 1)},
+      {header->targets, array_size(n_e, sizeof(uint32_t))},
+      {header->lines, array_size(n_e, sizeof(int32_t))},
+      {header->counts, array_size(n_e, sizeof(uint32_t))}};
+  for (const auto &s : sections) {
+    if (s.first % 8 != 0 || s.first > size || s.second > size - s.first) {
+      throw runtime_error(path + " is truncated or corrupt");
+    }
+  }
+  if (header->file_size != size || header->string_data > header->vertices ||
+      !is_ascending(section<uint64_t>(header->string_offsets),
+                    header->n_strings + 1,
+                    header->vertices - header->string_data) ||
+      !is_ascending(section<uint64_t>(header->rows), n_v + 1, n_e) ||
+      section<uint64_t>(header->rows)[n_v] != n_e ||
+      !are_vertex_ids(section<uint32_t>(header->key_index), n_v, n_v) ||
+      !are_vertex_ids(section<uint32_t>(header->targets), n_e, n_v)) {
+    throw runtime_error(path + " is truncated or corrupt");
+  }
+}
+
+uint64_t Graph_File::get_n_vertices() const { return header->n_vertices; }
+
+uint64_t Graph_File::get_n_edges() const { return header->n_edges; }
+
+string_view Graph_File::get_string(uint32_t idx) const {
+  if (idx >= header->n_strings) {
+    return {};
+  }
+  const auto *offsets = section<uint64_t>(header->string_offsets);
+  return {data + header->string_data + offsets[idx],
+          offsets[idx + 1] - offsets[idx]};
+}
+
+string_view Graph_File::get_name(Vertex_Id v) const {
+  return get_string(section<Graph_File_Vertex>(header->vertices)[v].name);
+}
+
+string_view Graph_File::get_abs_path(Vertex_Id v) const {
+  return get_string(section<Graph_File_Vertex>(header->vertices)[v].abs_path);
+}
+
+string_view Graph_File::get_key(Vertex_Id v) const {
+  const auto &record = section<Graph_File_Vertex>(header->vertices)[v];
+  return get_string(record.abs_path == NO_STRING ? record.name
+                                                 : record.abs_path);
+}
+
+Vertex_Id Graph_File::find(string_view key) const {
+  const auto *first = section<uint32_t>(header->key_index);
+  const auto *last = first + header->n_vertices;
+  const auto *itr = std::lower_bound(
+      first, last, key,
+      [this](uint32_t v, string_view k) { return get_key(v) < k; });
+  return (itr != last && get_key(*itr) == key) ? *itr : NO_VERTEX;
+}
+
+uint64_t Graph_File::get_first_edge(Vertex_Id v) const {
+  return section<uint64_t>(header->rows)[v];
+}
+
+uint64_t Graph_File::get_end_edge(Vertex_Id v) const {
+  return section<uint64_t>(header->rows)[v + 1];
+}
+
+Vertex_Id Graph_File::get_target(uint64_t e) const {
+  return section<uint32_t>(header->targets)[e];
+}
+
+int Graph_File::get_line(uint64_t e) const {
+  return section<int32_t>(header->lines)[e];
+}
+
+unsigned int Graph_File::get_count(uint64_t e) const {
+  return section<uint32_t>(header->counts)[e];
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,569 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "graph_merger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+
+#include "graph_file.h"
+#include "mapped_file.h"
+
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::uint32_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief A vertex of an input graph.
+struct Input_Vertex {
+  string name;      ///< Name of the vertex
+  string abs_path;  ///< Absolute path (empty if unknown)
+};
+
+/// @brief Called for each edge of an input graph (with input vertex ids).
+using Edge_Callback =
+    std::function<void(uint32_t src, uint32_t dst, int line, unsigned count)>;
+
+/// @brief A tag of an XML document.
+struct Xml_Tag {
+  string_view name;           ///< Name of the element
+  string_view attributes;     ///< Raw attribute text
+  bool closing = false;       ///< True for </name>
+  bool self_closing = false;  ///< True for <name ... />
+};
+
+/// @brief Moves pos behind the next tag of text and returns the tag.
+/// @details Comments, processing instructions and declarations are
+///          skipped. Returns false at the end of text.
+bool next_tag(string_view text, size_t *pos, Xml_Tag *tag) {
+  for (;;) {
+    const auto start = text.find('<', *pos);
+    if (start == string_view::npos) {
+      *pos = text.size();
+      return false;
+    }
+    if (text.compare(start, 4, "<!--") == 0) {
+      const auto end = text.find("-->", start + 4);
+      *pos = end == string_view::npos ? text.size() : end + 3;
+      continue;
+    }
+    const auto end = text.find('>', start);
+    if (end == string_view::npos) {
+      throw std::runtime_error("Unterminated XML tag");
+    }
+    *pos = end + 1;
+    if (text[start + 1] == '?' || text[start + 1] == '!') {
+      continue;
+    }
+    auto inner = text.substr(start + 1, end - start - 1);
+    tag->closing = !inner.empty() && inner.front() == '/';
+    if (tag->closing) {
+      inner.remove_prefix(1);
+    }
+    tag->self_closing = !inner.empty() && inner.back() == '/';
+    if (tag->self_closing) {
+      inner.remove_suffix(1);
+    }
+    const auto name_end = std::min(inner.find_first_of(" \t\r\n"),
+                                   inner.size());
+    tag->name = inner.substr(0, name_end);
+    tag->attributes = inner.substr(name_end);
+    return true;
+  }
+}
+
+/// @brief Returns the raw value of an attribute (empty if missing).
+string_view get_attribute(string_view attributes, string_view name) {
+  size_t pos = 0;
+  for (;;) {
+    pos = attributes.find_first_not_of(" \t\r\n", pos);
+    if (pos == string_view::npos) {
+      return {};
+    }
+    const auto eq = attributes.find('=', pos);
+    if (eq == string_view::npos || eq + 1 >= attributes.size()) {
+      return {};
+    }
+    auto key = attributes.substr(pos, eq - pos);
+    key = key.substr(0, key.find_first_of(" \t\r\n"));
+    const auto quote_pos = attributes.find_first_of("\"'", eq + 1);
+    if (quote_pos == string_view::npos) {
+      return {};
+    }
+    const auto value_end = attributes.find(attributes[quote_pos],
+                                           quote_pos + 1);
+    if (value_end == string_view::npos) {
+      return {};
+    }
+    if (key == name) {
+      return attributes.substr(quote_pos + 1, value_end - quote_pos - 1);
+    }
+    pos = value_end + 1;
+  }
+}
+
+/// @brief Replaces the XML character entities of text.
+string decode_xml(string_view text) {
+  string out;
+  out.reserve(text.size());
+  size_t pos = 0;
+  while (pos < text.size()) {
+    const auto amp = text.find('&', pos);
+    const auto semi =
+        amp == string_view::npos ? string_view::npos : text.find(';', amp);
+    if (semi == string_view::npos) {
+      out.append(text.substr(pos));
+      break;
+    }
+    out.append(text.substr(pos, amp - pos));
+    const auto entity = text.substr(amp + 1, semi - amp - 1);
+    if (entity == "lt") {
+      out.push_back('<');
+    } else if (entity == "gt") {
+      out.push_back('>');
+    } else if (entity == "amp") {
+      out.push_back('&');
+    } else if (entity == "quot") {
+      out.push_back('"');
+    } else if (entity == "apos") {
+      out.push_back('\'');
+    } else if (entity.size() > 1 && entity.front() == '#') {
+      const bool hex = entity[1] == 'x' || entity[1] == 'X';
+      const string digits(entity.substr(hex ? 2 : 1));
+      const auto code = std::strtoul(digits.c_str(), nullptr, hex ? 16 : 10);
+      if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+      } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xc0U | (code >> 6U)));
+        out.push_back(static_cast<char>(0x80U | (code & 0x3fU)));
+      } else {
+        out.push_back(static_cast<char>(0xe0U | ((code >> 12U) & 0x0fU)));
+        out.push_back(static_cast<char>(0x80U | ((code >> 6U) & 0x3fU)));
+        out.push_back(static_cast<char>(0x80U | (code & 0x3fU)));
+      }
+    } else {
+      out.append(text.substr(amp, semi - amp + 1));
+    }
+    pos = semi + 1;
+  }
+  return out;
+}
+
+/// @brief Streaming reader of GraphML files.
+/// @details
+///   The file is memory-mapped; the vertices are taken from the key with
+///   attr.name "name" (and "path", if present), the edges from the keys
+///   "line" and "count" (if present).
+class Graphml_Input {
+ public:
+  explicit Graphml_Input(const string &path) : file(path), path(path) {
+    if (!file.is_open()) {
+      throw std::runtime_error("Failed to read graph file " + path);
+    }
+    text = file.get_content();
+  }
+
+  /// @brief Reads all vertices (to out, if not nullptr) and their ids.
+  void read_vertices(vector<Input_Vertex> *out) {
+    size_t pos = 0;
+    Xml_Tag tag;
+    Input_Vertex vertex;
+    bool in_node = false;
+    while (next_tag(text, &pos, &tag)) {
+      if (tag.name == "key" && !tag.closing) {
+        read_key(tag);
+      } else if (tag.name == "node") {
+        if (!tag.closing) {
+          vertex = Input_Vertex{};
+          const auto id = get_attribute(tag.attributes, "id");
+          vertex.name = string(id);
+          ids.emplace(id, static_cast<uint32_t>(ids.size()));
+          in_node = !tag.self_closing;
+        }
+        if ((tag.closing || tag.self_closing) && out != nullptr) {
+          out->push_back(vertex);
+        }
+        in_node = in_node && !tag.closing;
+      } else if (in_node && tag.name == "data" && !tag.closing) {
+        const auto data_key = get_attribute(tag.attributes, "key");
+        const auto value = text.substr(pos, text.find('<', pos) - pos);
+        if (data_key == name_key) {
+          vertex.name = decode_xml(value);
+        } else if (!path_key.empty() && data_key == path_key) {
+          vertex.abs_path = decode_xml(value);
+        }
+      }
+    }
+  }
+
+  /// @brief Calls f for each edge (read_vertices must be called first).
+  void read_edges(const Edge_Callback &f) {
+    size_t pos = 0;
+    Xml_Tag tag;
+    uint32_t src = 0;
+    uint32_t dst = 0;
+    int line = START_LINE;
+    unsigned int count = 1;
+    bool in_edge = false;
+    while (next_tag(text, &pos, &tag)) {
+      if (tag.name == "edge") {
+        if (!tag.closing) {
+          src = lookup(get_attribute(tag.attributes, "source"));
+          dst = lookup(get_attribute(tag.attributes, "target"));
+          line = START_LINE;
+          count = 1;
+          in_edge = !tag.self_closing;
+        }
+        if (tag.closing || tag.self_closing) {
+          f(src, dst, line, count);
+        }
+        in_edge = in_edge && !tag.closing;
+      } else if (in_edge && tag.name == "data" && !tag.closing) {
+        const auto key = get_attribute(tag.attributes, "key");
+        const string value(text.substr(pos, text.find('<', pos) - pos));
+        if (key == line_key) {
+          line = static_cast<int>(std::strtol(value.c_str(), nullptr, 10));
+        } else if (!count_key.empty() && key == count_key) {
+          count = static_cast<unsigned int>(
+              std::strtoul(value.c_str(), nullptr, 10));
+        }
+      }
+    }
+  }
+
+ private:
+  /// @brief Remembers the ids of the keys which are used.
+  void read_key(const Xml_Tag &tag) {
+    const auto id = get_attribute(tag.attributes, "id");
+    const auto domain = get_attribute(tag.attributes, "for");
+    const auto attr_name = get_attribute(tag.attributes, "attr.name");
+    if (domain == "node" && attr_name == "name") {
+      name_key = id;
+    } else if (domain == "node" && attr_name == "path") {
+      path_key = id;
+    } else if (domain == "edge" && attr_name == "line") {
+      line_key = id;
+    } else if (domain == "edge" && attr_name == "count") {
+      count_key = id;
+    }
+  }
+
+  /// @brief Returns the input vertex id of a node id.
+  uint32_t lookup(string_view id) const {
+    const auto it = ids.find(id);
+    if (it == ids.end()) {
+      throw std::runtime_error("Unknown node '" + string(id) + "' in " +
+                               path);
+    }
+    return it->second;
+  }
+
+  Mapped_File file;
+  const string path;
+  string_view text;
+  string_view name_key;
+  string_view path_key;
+  string_view line_key;
+  string_view count_key;
+  std::unordered_map<string_view, uint32_t> ids;
+};
+
+/// @brief Returns true if the file starts with GRAPH_FILE_MAGIC.
+bool is_graph_file(const string &path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[sizeof(GRAPH_FILE_MAGIC)] = {};
+  in.read(magic, sizeof(magic));
+  return in && std::memcmp(magic, GRAPH_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+/// @brief Reads the vertices of a graph file (binary or GraphML).
+void read_vertices(const string &path, vector<Input_Vertex> *out) {
+  if (is_graph_file(path)) {
+    const Graph_File file(path);
+    const auto n_vertices = static_cast<Vertex_Id>(file.get_n_vertices());
+    out->reserve(n_vertices);
+    for (Vertex_Id v = 0; v < n_vertices; ++v) {
+      out->push_back(Input_Vertex{string(file.get_name(v)),
+                                  string(file.get_abs_path(v))});
+    }
+  } else {
+    Graphml_Input(path).read_vertices(out);
+  }
+}
+
+/// @brief Calls f for each edge of a graph file (binary or GraphML).
+void read_edges(const string &path, const Edge_Callback &f) {
+  if (is_graph_file(path)) {
+    const Graph_File file(path);
+    const auto n_vertices = static_cast<Vertex_Id>(file.get_n_vertices());
+    for (Vertex_Id v = 0; v < n_vertices; ++v) {
+      for (auto e = file.get_first_edge(v); e < file.get_end_edge(v); ++e) {
+        f(v, file.get_target(e), file.get_line(e), file.get_count(e));
+      }
+    }
+  } else {
+    Graphml_Input input(path);
+    input.read_vertices(nullptr);
+    input.read_edges(f);
+  }
+}
+
+/// @brief Calls f(0) ... f(n-1) on up to n_threads threads.
+/// @details The first exception of f is re-thrown after all threads
+///          have finished.
+void run_parallel(size_t n, unsigned int n_threads,
+                  const std::function<void(size_t)> &f) {
+  std::atomic<size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto work = [&] {
+    for (auto i = next++; i < n; i = next++) {
+      try {
+        f(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lck(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next = n;
+      }
+    }
+  };
+  vector<std::thread> threads;
+  const auto n_workers = std::min<size_t>(n, std::max(n_threads, 1U));
+  for (size_t t = 1; t < n_workers; ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &t : threads) {
+    t.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+using Merge_Edge = Graph_Merger::Merge_Edge;
+
+/// @brief Sort order of the runs.
+bool edge_less(const Merge_Edge &a, const Merge_Edge &b) {
+  if (a.src != b.src) {
+    return a.src < b.src;
+  }
+  if (a.dst != b.dst) {
+    return a.dst < b.dst;
+  }
+  return a.line < b.line;
+}
+
+/// @brief Temporary directory which is removed with all its files.
+class Temp_Dir {
+ public:
+  Temp_Dir()
+      : path(boost::filesystem::temp_directory_path() /
+             boost::filesystem::unique_path("gardener-merge-%%%%-%%%%")) {
+    boost::filesystem::create_directories(path);
+  }
+  Temp_Dir(const Temp_Dir &other) = delete;
+  Temp_Dir &operator=(const Temp_Dir &rhs) = delete;
+  Temp_Dir(Temp_Dir &&rhs) = delete;
+  Temp_Dir &operator=(Temp_Dir &&rhs) = delete;
+  ~Temp_Dir() {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(path, ec);
+  }
+
+  const boost::filesystem::path path;
+};
+
+/// @brief Buffered sequential reader of a sorted run.
+class Run_Reader {
+ public:
+  static constexpr size_t BUFFER_SIZE = 1U << 14U;
+
+  explicit Run_Reader(const string &path)
+      : in(path, std::ios::binary), buffer(BUFFER_SIZE), pos(0), end(0) {
+    if (!in) {
+      throw std::runtime_error("Failed to open run file " + path);
+    }
+  }
+
+  /// @brief Reads the next edge, returns false at the end of the run.
+  bool next(Merge_Edge *edge) {
+    if (pos == end) {
+      in.read(reinterpret_cast<char *>(buffer.data()),
+              static_cast<std::streamsize>(buffer.size() * sizeof(Merge_Edge)));
+      end = static_cast<size_t>(in.gcount()) / sizeof(Merge_Edge);
+      pos = 0;
+      if (end == 0) {
+        return false;
+      }
+    }
+    *edge = buffer[pos++];
+    return true;
+  }
+
+ private:
+  std::ifstream in;
+  vector<Merge_Edge> buffer;
+  size_t pos;
+  size_t end;
+};
+
+}  // namespace
+
+Graph_Merger::Graph_Merger(unsigned int n_threads, size_t run_size)
+    : n_threads(std::max(n_threads, 1U)),
+      run_size(std::max<size_t>(run_size, 1)),
+      n_runs(0) {}
+
+void Graph_Merger::merge(const vector<string> &paths) {
+  // 1. vertices: read n_threads inputs in parallel, insert in input order
+  vector<vector<Vertex_Id>> to_merged(paths.size());
+  for (size_t first = 0; first < paths.size(); first += n_threads) {
+    const auto n = std::min<size_t>(n_threads, paths.size() - first);
+    vector<vector<Input_Vertex>> inputs(n);
+    run_parallel(n, n_threads, [&](size_t i) {
+      read_vertices(paths[first + i], &inputs[i]);
+    });
+    for (size_t i = 0; i < n; ++i) {
+      auto &ids = to_merged[first + i];
+      ids.reserve(inputs[i].size());
+      for (const auto &v : inputs[i]) {
+        ids.push_back(vertexes.insert(v.name, v.abs_path).first);
+      }
+    }
+  }
+  BOOST_LOG_TRIVIAL(info) << "Merging " << paths.size() << " graphs with "
+                          << vertexes.size() << " vertices";
+
+  // 2. edges: each thread writes sorted runs of run_size edges
+  const Temp_Dir dir;
+  vector<string> runs;
+  std::mutex runs_mutex;
+  auto write_run = [&](vector<Merge_Edge> *edges) {
+    std::sort(edges->begin(), edges->end(), edge_less);
+    string run;
+    {
+      std::lock_guard<std::mutex> lck(runs_mutex);
+      run = (dir.path / ("run" + std::to_string(runs.size()))).string();
+      runs.push_back(run);
+    }
+    std::ofstream out(run, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(edges->data()),
+              static_cast<std::streamsize>(edges->size() * sizeof(Merge_Edge)));
+    if (!out) {
+      throw std::runtime_error("Failed to write run file " + run);
+    }
+    edges->clear();
+  };
+  std::atomic<size_t> next_input{0};
+  run_parallel(n_threads, n_threads, [&](size_t /* thread */) {
+    vector<Merge_Edge> edges;
+    edges.reserve(std::min<size_t>(run_size, 1U << 16U));
+    for (auto i = next_input++; i < paths.size(); i = next_input++) {
+      const auto &ids = to_merged[i];
+      read_edges(paths[i], [&](uint32_t src, uint32_t dst, int line,
+                               unsigned int count) {
+        if (src >= ids.size() || dst >= ids.size()) {
+          throw std::runtime_error("Invalid edge in " + paths[i]);
+        }
+        edges.push_back(Merge_Edge{ids[src], ids[dst], line, count});
+        if (edges.size() >= run_size) {
+          write_run(&edges);
+        }
+      });
+    }
+    if (!edges.empty()) {
+      write_run(&edges);
+    }
+  });
+  n_runs = runs.size();
+
+  // 3. k-way merge of the runs, edges with equal source and target
+  //    are merged into one
+  while (boost::num_vertices(graph) < vertexes.size()) {
+    boost::add_vertex(graph);
+  }
+  vector<std::unique_ptr<Run_Reader>> readers;
+  using Head = std::pair<Merge_Edge, size_t>;
+  auto head_greater = [](const Head &a, const Head &b) {
+    return edge_less(b.first, a.first);
+  };
+  std::priority_queue<Head, vector<Head>, decltype(head_greater)> heads(
+      head_greater);
+  for (const auto &run : runs) {
+    readers.push_back(std::make_unique<Run_Reader>(run));
+    Merge_Edge edge{};
+    if (readers.back()->next(&edge)) {
+      heads.emplace(edge, readers.size() - 1);
+    }
+  }
+  bool pending = false;
+  Merge_Edge current{};
+  auto add_current = [&] {
+    auto e = boost::add_edge(current.src, current.dst, Edge(current.line),
+                             graph);
+    graph[e.first].count = current.count;
+  };
+  while (!heads.empty()) {
+    const auto [edge, reader] = heads.top();
+    heads.pop();
+    if (pending && edge.src == current.src && edge.dst == current.dst) {
+      current.count = std::max(current.count, edge.count);
+    } else {
+      if (pending) {
+        add_current();
+      }
+      current = edge;
+      pending = true;
+    }
+    Merge_Edge next{};
+    if (readers[reader]->next(&next)) {
+      heads.emplace(next, reader);
+    }
+  }
+  if (pending) {
+    add_current();
+  }
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,205 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "graph_writer.h"
+
+#include <charconv>
+
+#include <boost/range/iterator_range.hpp>
+
+#include "graph_file.h"
+#include "ndjson_stream.h"
+
+using std::ostream;
+using std::size_t;
+using std::string;
+
+namespace INCLUDE_GARDENER {
+
+Graph_Writer::Graph_Writer(const Graph &graph, const Vertex_Table &vertexes,
+                           size_t buffer_size)
+    : graph(graph), vertexes(vertexes), buffer_size(buffer_size) {
+  buffer.reserve(buffer_size + 4096);
+}
+
+void Graph_Writer::write_dot(ostream &os) {
+  buffer.append("digraph G {\n");
+  const auto n_vertices = static_cast<Vertex_Id>(vertexes.size());
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    append_number(v);
+    buffer.append("[label=\"");
+    vertexes.append_name(v, &buffer);
+    buffer.append("\"];\n");
+    flush_if_full(os);
+  }
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+      append_number(v);
+      buffer.append("->");
+      append_number(boost::target(e, graph));
+      buffer.append(" [label=\"line ");
+      append_number(graph[e].line);
+      buffer.append("\"];\n");
+      flush_if_full(os);
+    }
+  }
+  buffer.append("}\n");
+  flush(os);
+}
+
+void Graph_Writer::write_graphml(ostream &os) {
+  buffer.append(
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\" "
+      "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+      "xsi:schemaLocation=\"http://graphml.graphdrawing.org/xmlns "
+      "http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd\">\n"
+      "  <key id=\"key0\" for=\"edge\" attr.name=\"line\" "
+      "attr.type=\"int\" />\n"
+      "  <key id=\"key1\" for=\"node\" attr.name=\"name\" "
+      "attr.type=\"string\" />\n"
+      "  <graph id=\"G\" edgedefault=\"directed\" parse.nodeids=\"free\" "
+      "parse.edgeids=\"canonical\" parse.order=\"nodesfirst\">\n");
+  const auto n_vertices = static_cast<Vertex_Id>(vertexes.size());
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    buffer.append("    <node id=\"n");
+    append_number(v);
+    buffer.append("\">\n      <data key=\"key1\">");
+    append_xml_name(v);
+    buffer.append("</data>\n    </node>\n");
+    flush_if_full(os);
+  }
+  size_t edge_count = 0;
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+      buffer.append("    <edge id=\"e");
+      append_number(edge_count++);
+      buffer.append("\" source=\"n");
+      append_number(v);
+      buffer.append("\" target=\"n");
+      append_number(boost::target(e, graph));
+      buffer.append("\">\n      <data key=\"key0\">");
+      append_number(graph[e].line);
+      buffer.append("</data>\n    </edge>\n");
+      flush_if_full(os);
+    }
+  }
+  buffer.append("  </graph>\n</graphml>\n");
+  flush(os);
+}
+
+void Graph_Writer::write_ndjson(ostream &os) {
+  const auto n_vertices = static_cast<Vertex_Id>(vertexes.size());
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    Ndjson_Stream::append_vertex(v, vertexes.get_name(v),
+                                 vertexes.get_abs_path(v), &buffer);
+    flush_if_full(os);
+  }
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+      Ndjson_Stream::append_edge(
+          v, static_cast<Vertex_Id>(boost::target(e, graph)), graph[e].line,
+          &buffer);
+      flush_if_full(os);
+    }
+  }
+  flush(os);
+}
+
+void Graph_Writer::flush_if_full(ostream &os) {
+  if (buffer.size() >= buffer_size) {
+    flush(os);
+  }
+}
+
+void Graph_Writer::flush(ostream &os) {
+  os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  os.flush();
+  buffer.clear();
+}
+
+template <class T>
+void Graph_Writer::append_number(T value) {
+  char digits[24];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  buffer.append(digits, result.ptr);
+}
+
+/// @details
+///   The name is appended as it is; only if it contains a character
+///   which must be encoded, the appended part is re-written.
+void Graph_Writer::append_xml_name(Vertex_Id v) {
+  const size_t start = buffer.size();
+  vertexes.append_name(v, &buffer);
+  const size_t end = buffer.size();
+  if (start == end) {
+    return;
+  }
+
+  if (buffer.find_first_not_of(' ', start) == string::npos) {
+    buffer.replace(start, 1, "&#32;");
+    return;
+  }
+  if (buffer.find_first_of("<>&\"'", start) == string::npos) {
+    return;
+  }
+
+  const string name = buffer.substr(start);
+  buffer.resize(start);
+  for (char c : name) {
+    switch (c) {
+      case '<':
+        buffer.append("&lt;");
+        break;
+      case '>':
+        buffer.append("&gt;");
+        break;
+      case '&':
+        buffer.append("&amp;");
+        break;
+      case '"':
+        buffer.append("&quot;");
+        break;
+      case '\'':
+        buffer.append("&apos;");
+        break;
+      default:
+        buffer.push_back(c);
+        break;
+    }
+  }
+}
+
+void write_graph(const string &format, const Graph &graph,
+                 const Vertex_Table &vertexes, ostream &os) {
+  if ("dot" == format) {
+    Graph_Writer(graph, vertexes).write_dot(os);
+  } else if ("xml" == format || "graphml" == format) {
+    Graph_Writer(graph, vertexes).write_graphml(os);
+  } else if ("ndjson" == format) {
+    Graph_Writer(graph, vertexes).write_ndjson(os);
+  } else if ("bin" == format) {
+    write_graph_file(os, graph, vertexes);
+  }
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
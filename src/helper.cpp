@@ -20,7 +20,17 @@
 //
 #include "helper.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <limits>
+
 using boost::regex;
+using std::optional;
+using std::size_t;
 using std::string;
 using std::vector;
 
@@ -39,6 +49,78 @@ vector<regex> init_regex_vector(const vector<string>& string_vector) {
   return regex_vector;
 }
 
+/// @details
+///   Reads with read() into a string of the size given by fstat. Unlike
+///   a memory mapping, a file which shrinks or grows meanwhile is just
+///   read with its new size.
+bool read_file(const string& path, string* content) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  // one byte more, so the end of the file is found by the first read()
+  content->resize(static_cast<size_t>(st.st_size) + 1);
+  size_t n_read = 0;
+  for (;;) {
+    if (n_read == content->size()) {
+      content->resize(2 * content->size());
+    }
+    const auto n = ::read(fd, &(*content)[n_read], content->size() - n_read);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      ::close(fd);
+      content->clear();
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    n_read += static_cast<size_t>(n);
+  }
+  ::close(fd);
+  content->resize(n_read);
+  return true;
+}
+
+optional<size_t> parse_size(const string& spec) {
+  size_t digits = 0;
+  while (digits < spec.size() &&
+         std::isdigit(static_cast<unsigned char>(spec[digits])) != 0) {
+    ++digits;
+  }
+  if (digits == 0 || digits > 18 || spec.size() > digits + 1) {
+    return {};
+  }
+  unsigned int shift = 0;
+  if (spec.size() > digits) {
+    switch (std::toupper(static_cast<unsigned char>(spec[digits]))) {
+      case 'K':
+        shift = 10;
+        break;
+      case 'M':
+        shift = 20;
+        break;
+      case 'G':
+        shift = 30;
+        break;
+      default:
+        return {};
+    }
+  }
+  const size_t value = std::stoull(spec.substr(0, digits));
+  if (value > (std::numeric_limits<size_t>::max() >> shift)) {
+    return {};
+  }
+  return value << shift;
+}
+
 }  // namespace INCLUDE_GARDENER
 
 // vim: filetype=cpp et ts=2 sw=2 sts=2
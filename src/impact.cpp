@@ -0,0 +1,62 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "impact.h"
+
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+vector<Vertex_Id> find_affected(const Csr_Graph &reverse,
+                                const vector<Vertex_Id> &changed) {
+  vector<bool> visited(reverse.get_n_vertices(), false);
+  vector<Vertex_Id> queue;
+  queue.reserve(changed.size());
+  for (auto v : changed) {
+    if (!visited[v]) {
+      visited[v] = true;
+      queue.push_back(v);
+    }
+  }
+  for (std::size_t q = 0; q < queue.size(); ++q) {
+    const Vertex_Id v = queue[q];
+    for (auto e = reverse.get_first_edge(v); e < reverse.get_end_edge(v);
+         ++e) {
+      const Vertex_Id w = reverse.get_target(e);
+      if (!visited[w]) {
+        visited[w] = true;
+        queue.push_back(w);
+      }
+    }
+  }
+
+  vector<Vertex_Id> affected;
+  affected.reserve(queue.size());
+  for (Vertex_Id v = 0; v < reverse.get_n_vertices(); ++v) {
+    if (visited[v]) {
+      affected.push_back(v);
+    }
+  }
+  return affected;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
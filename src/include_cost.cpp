@@ -0,0 +1,101 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "include_cost.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using std::size_t;
+using std::uint32_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+Include_Cost::Include_Cost(const Csr_Graph &graph,
+                           const Transitive_Closure &closure,
+                           const Vertex_Table &vertexes,
+                           const vector<Vertex_Id> &unit_ids,
+                           unsigned int n_threads) {
+  const Vertex_Id n_vertices = graph.get_n_vertices();
+
+  units.reserve(unit_ids.size());
+  for (auto v : unit_ids) {
+    units.push_back(Unit_Cost{v, 0, 0, 0});
+  }
+
+  n_threads = std::max(n_threads, 1U);
+  vector<vector<uint32_t>> n_units(n_threads,
+                                   vector<uint32_t>(n_vertices, 0));
+  std::atomic<size_t> next(0);
+  auto work = [&](unsigned int t) {
+    auto &counts = n_units[t];
+    for (size_t i = next++; i < units.size(); i = next++) {
+      auto &cost = units[i];
+      const auto &size = vertexes.get_file_size(cost.unit);
+      cost.bytes = size.bytes;
+      cost.lines = size.lines;
+      for (auto w : closure.get_reachable(cost.unit)) {
+        if (w == cost.unit) {
+          continue;  // the unit includes itself (via a cycle)
+        }
+        const auto &header_size = vertexes.get_file_size(w);
+        cost.bytes += header_size.bytes;
+        cost.lines += header_size.lines;
+        ++cost.n_headers;
+        ++counts[w];
+      }
+    }
+  };
+  vector<std::thread> threads;
+  for (unsigned int t = 1; t < n_threads; ++t) {
+    threads.emplace_back(work, t);
+  }
+  work(0);
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  for (Vertex_Id v = 0; v < n_vertices; ++v) {
+    size_t n = 0;
+    for (const auto &counts : n_units) {
+      n += counts[v];
+    }
+    if (n > 0) {
+      const auto &size = vertexes.get_file_size(v);
+      headers.push_back(Header_Cost{v, n, n * size.bytes, n * size.lines});
+    }
+  }
+
+  std::sort(units.begin(), units.end(),
+            [](const Unit_Cost &a, const Unit_Cost &b) {
+              return a.bytes != b.bytes ? a.bytes > b.bytes : a.unit < b.unit;
+            });
+  std::sort(headers.begin(), headers.end(),
+            [](const Header_Cost &a, const Header_Cost &b) {
+              return a.bytes != b.bytes ? a.bytes > b.bytes
+                                        : a.header < b.header;
+            });
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,149 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "include_gardener.h"
+
+#include <memory>
+
+#include "analysis.h"
+#include "csr_graph.h"
+#include "solver.h"
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+/// @details The vertex names and paths are copied out of the solver.
+struct Include_Graph::Data {
+  explicit Data(Solver::Ptr solver)
+      : solver(std::move(solver)), csr(this->solver->get_graph()) {}
+
+  /// @brief The solver.
+  Solver::Ptr solver;
+
+  /// @brief The edges.
+  Csr_Graph csr;
+
+  /// @brief Name of each vertex.
+  vector<string> names;
+
+  /// @brief Absolute path of each vertex.
+  vector<string> paths;
+
+  /// @brief File size of each vertex.
+  vector<File_Size> sizes;
+};
+
+Include_Graph::Vertex Include_Graph::Vertex_Iterator::operator*() const {
+  return Vertex{id, data->names[id], data->paths[id], data->sizes[id]};
+}
+
+Include_Graph::Edge_Iterator::Edge_Iterator(const Data *data,
+                                            Vertex_Id source, size_t edge)
+    : data(data), source(source), edge(edge) {
+  skip_sources();
+}
+
+Include_Graph::Edge Include_Graph::Edge_Iterator::operator*() const {
+  return Edge{source, data->csr.get_target(edge), data->csr.get_line(edge)};
+}
+
+Include_Graph::Edge_Iterator &Include_Graph::Edge_Iterator::operator++() {
+  ++edge;
+  skip_sources();
+  return *this;
+}
+
+void Include_Graph::Edge_Iterator::skip_sources() {
+  const auto &csr = data->csr;
+  while (edge < csr.get_n_edges() && edge >= csr.get_end_edge(source)) {
+    ++source;
+  }
+}
+
+Include_Graph::Include_Graph(Solver::Ptr solver) {
+  auto snapshot = std::make_unique<Data>(std::move(solver));
+  const auto &vertexes = snapshot->solver->get_vertexes();
+  snapshot->names.reserve(vertexes.size());
+  snapshot->paths.reserve(vertexes.size());
+  snapshot->sizes.reserve(vertexes.size());
+  for (Vertex_Id v = 0; v < vertexes.size(); ++v) {
+    snapshot->names.push_back(vertexes.get_name(v));
+    snapshot->paths.push_back(vertexes.get_abs_path(v));
+    snapshot->sizes.push_back(vertexes.get_file_size(v));
+  }
+  data = std::move(snapshot);
+}
+
+Include_Graph::Include_Graph(Include_Graph &&rhs) noexcept = default;
+
+Include_Graph &Include_Graph::operator=(Include_Graph &&rhs) noexcept =
+    default;
+
+Include_Graph::~Include_Graph() = default;
+
+size_t Include_Graph::get_n_vertices() const { return data->names.size(); }
+
+size_t Include_Graph::get_n_edges() const { return data->csr.get_n_edges(); }
+
+Include_Graph::Vertex Include_Graph::get_vertex(Vertex_Id id) const {
+  return *Vertex_Iterator(data.get(), id);
+}
+
+Include_Graph::Range<Include_Graph::Vertex_Iterator> Include_Graph::vertices()
+    const {
+  return {Vertex_Iterator(data.get(), 0),
+          Vertex_Iterator(data.get(),
+                          static_cast<Vertex_Id>(data->names.size()))};
+}
+
+Include_Graph::Range<Include_Graph::Edge_Iterator> Include_Graph::edges()
+    const {
+  return {Edge_Iterator(data.get(), 0, 0),
+          Edge_Iterator(data.get(), 0, data->csr.get_n_edges())};
+}
+
+Include_Graph::Range<Include_Graph::Edge_Iterator> Include_Graph::out_edges(
+    Vertex_Id id) const {
+  return {Edge_Iterator(data.get(), id, data->csr.get_first_edge(id)),
+          Edge_Iterator(data.get(), id, data->csr.get_end_edge(id))};
+}
+
+Vertex_Id Include_Graph::find(const string &file) const {
+  return data->solver->find_file(file);
+}
+
+void Include_Graph::write(const string &format, std::ostream &os) const {
+  data->solver->write_graph(format, os);
+}
+
+size_t Include_Graph::report_cycles() const {
+  return data->solver->report_cycles();
+}
+
+Include_Graph analyze(const Analysis_Options &options) {
+  return analyze(make_solver(options), options);
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -19,49 +19,121 @@
 // <http://www.gnu.org/licenses/>.
 //
 #include <fstream>
+#include <memory>
 
 #include <boost/log/core.hpp>
 #include <boost/log/expressions.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/program_options.hpp>
 
-#include "file_detector.h"
+#include "analysis.h"
+#include "compressed_ostream.h"
+#include "gardener_log.h"
+#include "graph_merger.h"
+#include "graph_writer.h"
+#include "helper.h"
+#include "include_gardener.h"
+#include "query_server.h"
+#include "run_stats.h"
+#include "shard.h"
 #include "solver_c.h"
 #include "solver_py.h"
 #include "statement_detector.h"
+#include "trace.h"
+#include "worker_controller.h"
 
 using std::cerr;
 using std::cout;
 using std::exception;
 using std::make_shared;
+using std::make_unique;
 using std::ofstream;
+using std::ostream;
+using std::size_t;
 using std::string;
 using std::vector;
 
-using INCLUDE_GARDENER::File_Detector;
+using INCLUDE_GARDENER::Compressed_Ostream;
+using INCLUDE_GARDENER::Analysis_Options;
+using INCLUDE_GARDENER::build_graph;
+using INCLUDE_GARDENER::Compression;
+using INCLUDE_GARDENER::Graph_Merger;
+using INCLUDE_GARDENER::Logging;
+using INCLUDE_GARDENER::Ndjson_Stream;
+using INCLUDE_GARDENER::parse_size;
+using INCLUDE_GARDENER::Query_Server;
+using INCLUDE_GARDENER::Run_Stats;
+using INCLUDE_GARDENER::Shard;
 using INCLUDE_GARDENER::Solver;
 using INCLUDE_GARDENER::Statement_Detector;
+using INCLUDE_GARDENER::Trace;
+using INCLUDE_GARDENER::Worker_Controller;
 
 namespace po = boost::program_options;
 
 // Note: use "dot -Tsvg graph.dot > graph.svg" to create svg.
 
+// Number of io_uring operations in flight (if --io-uring has no value).
+constexpr unsigned int DEFAULT_URING_DEPTH = 256;
+
+// Number of listed units and headers (if --cost has no value).
+constexpr size_t DEFAULT_COST_TOP = 20;
+
 struct Options {
    int n_threads;
+   bool auto_threads;
    int recursive_limit;
+   size_t queue_capacity;
+   size_t max_memory;
+   unsigned int uring_depth;
+   unsigned int n_resolvers;
+   Shard shard;
    string language;
    string format;
    string out_file;
+   Compression compression;
+   bool stream;
+   bool closure;
+   size_t cost_top;
+   size_t pch_budget;
+   bool report_cycles;
+   bool stats;
+   vector<string> affected_by;
+   string socket_path;
+   string cache_file;
+   string trace_file;
    vector<string> process_paths;
    vector<string> exclude;
    // default options
    Options()
-       : n_threads{1}, recursive_limit{-1}, language("c"), format("dot") {}
+       : n_threads{1},
+         auto_threads{false},
+         recursive_limit{-1},
+         queue_capacity{0},
+         max_memory{0},
+         uring_depth{0},
+         n_resolvers{0},
+         language("c"),
+         format("dot"),
+         stream{false},
+         closure{false},
+         cost_top{0},
+         pch_budget{0},
+         report_cycles{true},
+         stats{false} {}
 };
 
 Solver::Ptr init_options(int argc, char* argv[], Options* opts);
 
+void write_trace(const string& trace_file);
+
+int merge_main(int argc, char* argv[]);
+
 int main(int argc, char* argv[]) {
+   // "include_gardener merge ..." combines graph files
+   if (argc > 1 && string(argv[1]) == "merge") {
+      return merge_main(argc - 1, argv + 1);
+   }
    try {
       // global options
       Options opts;
@@ -72,35 +144,116 @@ int main(int argc, char* argv[]) {
          return -1;
       }
 
-      // Create a file detector ...
-      auto input_files =
-          make_shared<File_Detector>(solver->get_file_regex(), opts.exclude,
-                                     opts.process_paths, opts.recursive_limit);
+      // The output goes to a file or cout, ...
+      ofstream of;
+      ostream* out = &cout;
+      if (opts.out_file.length() > 0) {
+         BOOST_LOG_TRIVIAL(info) << "Writing graph to " << opts.out_file;
+         of.open(opts.out_file, ofstream::binary);
+         out = &of;
+      } else {
+         BOOST_LOG_TRIVIAL(info) << "Writing graph to stdout";
+      }
 
-      // ... and get all files.
-      input_files->get(solver);
+      // ... optionally compressed, ...
+      std::unique_ptr<Compressed_Ostream> compressed;
+      if (opts.compression.method != Compression::Method::NONE) {
+         // in stream mode, each batch of records is readable at once
+         compressed = make_unique<Compressed_Ostream>(*out, opts.compression,
+                                                      opts.stream);
+         out = compressed.get();
+      }
 
-      // Then, create a statement detector ...
-      Statement_Detector s_detector =
-          Statement_Detector(solver, opts.n_threads);
+      // ... and in stream mode, each vertex and edge is written as soon
+      // as it is added.
+      Ndjson_Stream::Ptr stream;
+      if (opts.stream) {
+         stream = make_shared<Ndjson_Stream>(*out);
+         solver->set_stream(stream);
+      }
 
-      // iterate over all files in detector and add them to job queue
-      for (const auto& i : *input_files) {
-         s_detector.add_job(i);
+      // With --stats, the duration of each phase is reported, with
+      // --trace, the phases and the worker activity are recorded.
+      if (opts.stats) {
+         Run_Stats::enable();
+      }
+      if (opts.trace_file.length() > 0) {
+         Trace::enable();
+      }
+      Run_Stats::set_thread_name("main");
+
+      // Scan all files and build the graph.
+      Analysis_Options analysis;
+      analysis.process_paths = opts.process_paths;
+      analysis.exclude = opts.exclude;
+      analysis.recursive_limit = opts.recursive_limit;
+      analysis.n_threads = opts.auto_threads ? Statement_Detector::AUTO_WORKERS
+                                             : opts.n_threads;
+      analysis.cache_file = opts.cache_file;
+      analysis.queue_capacity = opts.queue_capacity;
+      analysis.max_memory = opts.max_memory;
+      analysis.uring_depth = opts.uring_depth;
+      analysis.n_resolvers = opts.n_resolvers;
+      analysis.shard = opts.shard;
+      build_graph(solver, analysis);
+
+      auto phase_start = Run_Stats::Clock::now();
+      auto end_phase = [&phase_start](const char* name) {
+         const auto now = Run_Stats::Clock::now();
+         Run_Stats::add_phase(name, now - phase_start);
+         Trace::record(name, phase_start, now);
+         phase_start = now;
+      };
+
+      // Report include cycles (if not disabled) ...
+      // (a shard has only a part of the edges, so cycles are not reported)
+      if (opts.report_cycles && !opts.shard.is_partial()) {
+         solver->report_cycles();
+         end_phase("cycles");
       }
 
-      // and wait until all jobs are done!
-      s_detector.wait_for_workers();
+      // In server mode, the graph is kept and queries are answered until
+      // a shutdown request is received.
+      if (opts.socket_path.length() > 0) {
+         if (opts.stats) {
+            Run_Stats::write_report(cerr);
+         }
+         write_trace(opts.trace_file);
+         // the report is written, so the rescans are not recorded
+         Run_Stats::disable();
+         Trace::disable();
+         Query_Server(solver, opts.n_threads, opts.process_paths)
+               .serve(opts.socket_path);
+         return 0;
+      }
 
-      // Finally, write the graph somewhere to a file or cout.
-      if (opts.out_file.length() > 0) {
-         BOOST_LOG_TRIVIAL(info) << "Writing graph to " << opts.out_file;
-         auto of = ofstream(opts.out_file);
-         solver->write_graph(opts.format, of);
+      // Finally, write the graph (or the rest of the stream, or the
+      // transitive closure).
+      if (stream) {
+         stream->close();
+      } else if (!opts.affected_by.empty()) {
+         solver->write_affected(*out, opts.affected_by);
+      } else if (opts.closure) {
+         solver->write_closure(*out,
+                               static_cast<unsigned int>(opts.n_threads));
+      } else if (opts.cost_top > 0) {
+         solver->write_include_cost(
+             *out, static_cast<unsigned int>(opts.n_threads), opts.cost_top);
+      } else if (opts.pch_budget > 0) {
+         solver->write_pch(*out, static_cast<unsigned int>(opts.n_threads),
+                           opts.pch_budget);
       } else {
-         BOOST_LOG_TRIVIAL(info) << "Writing graph to stdout";
-         solver->write_graph(opts.format, cout);
+         solver->write_graph(opts.format, *out);
       }
+      if (compressed) {
+         compressed->close();
+      }
+      end_phase("output");
+
+      if (opts.stats) {
+         Run_Stats::write_report(cerr);
+      }
+      write_trace(opts.trace_file);
 
    } catch (const exception& e) {
       cerr << e.what() << "\n";
@@ -124,11 +277,56 @@ Solver::Ptr init_options(int argc, char* argv[], Options* opts) {
        "verbose,V", "sets verbosity")("out-file,o", po::value<string>(),
                                       "output file")(
        "format,f", po::value<string>(),
-       "output format (suported formats: dot, xml/graphml)")(
+       "output format (suported formats: dot, xml/graphml, ndjson, bin)")(
+       "stream", "writes each vertex and edge while scanning (ndjson only)")(
+       "closure",
+       "writes the transitive include set of each translation unit "
+       "instead of the graph")(
+       "cost", po::value<size_t>()->implicit_value(DEFAULT_COST_TOP),
+       "writes the given number (default=20) of translation units with the "
+       "most (transitively) included bytes and lines, and of headers which "
+       "add the most bytes to all units, instead of the graph")(
+       "pch", po::value<string>(),
+       "writes the headers which are recommended for a precompiled header "
+       "of the given size (e.g. 64M), instead of the graph")(
+       "no-cycles", "disables the report of include cycles")(
+       "stats",
+       "writes timing and throughput statistics of each phase and thread "
+       "to stderr")(
+       "trace", po::value<string>(),
+       "writes a timeline of all phases and threads to the given file "
+       "(Chrome trace format, for chrome://tracing or Perfetto)")(
+       "serve", po::value<string>(),
+       "keeps the graph and answers queries via the given unix socket "
+       "instead of writing the graph")(
+       "cache", po::value<string>(),
+       "caches the include statements of all files in the given file; "
+       "unchanged files are not scanned again")(
+       "compress,z", po::value<string>(),
+       "compresses the output (gzip[:LEVEL] or zstd[:LEVEL])")(
        "recursive-limit,L", po::value<int>(),
        "limits recursive processing (default=-1 = unlimited)")(
-       "threads,j", po::value<int>(),
-       "defines number of worker threads (default=2)")(
+       "threads,j", po::value<string>(),
+       "defines number of worker threads, or 'auto' to adapt it to the CPU "
+       "quota and the measured throughput (default=1)")(
+       "queue-capacity", po::value<size_t>(),
+       "limits the number of files waiting for a worker thread, and for "
+       "each stage with --resolve-threads (default=0 = unlimited / 1024)")(
+       "io-uring",
+       po::value<unsigned int>()->implicit_value(DEFAULT_URING_DEPTH),
+       "reads the files via io_uring with the given number of operations "
+       "in flight (default=256), if supported by the system")(
+       "resolve-threads", po::value<unsigned int>(),
+       "resolves the include statements on the given number of separate "
+       "threads, while the worker threads scan further files "
+       "(default=0 = resolved by the worker threads)")(
+       "max-memory", po::value<string>(),
+       "throttles the scan while the resident memory exceeds the given "
+       "size (e.g. 512M or 2G): the files are handed over in batches of "
+       "one per worker")(
+       "shard", po::value<string>(),
+       "scans only the files of shard i of N (given as i/N, the files are "
+       "assigned by the hash of their name) and writes a partial graph")(
        "language,l", po::value<string>(), "selects the language (default=c)");
 
    po::positional_options_description pos;
@@ -150,6 +348,8 @@ Solver::Ptr init_options(int argc, char* argv[], Options* opts) {
       exit(0);
    }
 
+   Logging::init();
+
    // Sets log level to warning if verbose is not set.
    // This must be done bevore useing any BOOST_LOG_TRIVIAL statement.
    //
@@ -176,7 +376,11 @@ Solver::Ptr init_options(int argc, char* argv[], Options* opts) {
                       po::value<vector<string> >()->composing(),
                       "path which is processed")(
        "exclude,e", po::value<vector<string> >()->composing(),
-       "regular expressions to exclude specific files");
+       "regular expressions to exclude specific files")(
+       "affected-by", po::value<vector<string> >()->composing(),
+       "writes the translation units which include the given file "
+       "(directly or indirectly) instead of the graph; can be given "
+       "multiple times");
 
    // Add language-specific options
    solver->add_options(&desc);
@@ -221,7 +425,18 @@ Solver::Ptr init_options(int argc, char* argv[], Options* opts) {
    }
 
    if (vm.count("threads") > 0) {
-      opts->n_threads = vm["threads"].as<int>();
+      const auto threads = vm["threads"].as<string>();
+      if ("auto" == threads) {
+         opts->auto_threads = true;
+         opts->n_threads =
+             static_cast<int>(Worker_Controller::get_cpu_budget());
+      } else if (threads.empty() || threads.size() > 6 ||
+                 threads.find_first_not_of("0123456789") != string::npos) {
+         cerr << "Error: Invalid number of threads: " << threads << "\n";
+         return nullptr;
+      } else {
+         opts->n_threads = std::stoi(threads);
+      }
       if (opts->n_threads == 0) {
          cerr << "Error: Number of threads is set to 0, which is not allowed."
               << "\n"
@@ -235,35 +450,297 @@ Solver::Ptr init_options(int argc, char* argv[], Options* opts) {
       opts->recursive_limit = vm["recursive-limit"].as<int>();
    }
 
+   if (vm.count("queue-capacity") > 0) {
+      opts->queue_capacity = vm["queue-capacity"].as<size_t>();
+   }
+
+   if (vm.count("io-uring") > 0) {
+      opts->uring_depth = vm["io-uring"].as<unsigned int>();
+      if (opts->uring_depth == 0) {
+         cerr << "Error: --io-uring requires at least one operation in flight"
+              << "\n";
+         return nullptr;
+      }
+   }
+
+   if (vm.count("resolve-threads") > 0) {
+      opts->n_resolvers = vm["resolve-threads"].as<unsigned int>();
+   }
+
+   if (vm.count("max-memory") > 0) {
+      const auto spec = vm["max-memory"].as<string>();
+      const auto max_memory = parse_size(spec);
+      if (!max_memory || *max_memory == 0) {
+         cerr << "Error: Invalid memory limit: " << spec << "\n";
+         return nullptr;
+      }
+      opts->max_memory = *max_memory;
+   }
+
    if (!(opts->format.empty() || "dot" == opts->format ||
-         "xml" == opts->format || "graphml" == opts->format)) {
+         "xml" == opts->format || "graphml" == opts->format ||
+         "ndjson" == opts->format || "bin" == opts->format)) {
       cerr << "Unrecognized format: " << opts->format << "\n"
            << "\n"
            << desc << "\n";
       return nullptr;
    }
 
+   if (vm.count("compress") > 0) {
+      const auto spec = vm["compress"].as<string>();
+      const auto compression = Compression::parse(spec);
+      if (!compression) {
+         cerr << "Unrecognized compression: " << spec << "\n"
+              << "\n"
+              << desc << "\n";
+         return nullptr;
+      }
+      if (!Compression::is_supported(compression->method)) {
+         cerr << "Error: Compression " << spec
+              << " is not supported by this build."
+              << "\n";
+         return nullptr;
+      }
+      opts->compression = *compression;
+   }
+
+   if (vm.count("no-cycles") > 0) {
+      opts->report_cycles = false;
+   }
+
+   if (vm.count("stats") > 0) {
+      opts->stats = true;
+   }
+
+   if (vm.count("trace") > 0) {
+      opts->trace_file = vm["trace"].as<string>();
+   }
+
+   if (vm.count("serve") > 0) {
+      opts->socket_path = vm["serve"].as<string>();
+   }
+
+   if (vm.count("cache") > 0) {
+      opts->cache_file = vm["cache"].as<string>();
+   }
+
+   if (vm.count("closure") > 0) {
+      opts->closure = true;
+   }
+
+   if (vm.count("cost") > 0) {
+      if (opts->closure) {
+         cerr << "Error: --cost can't be combined with --closure"
+              << "\n";
+         return nullptr;
+      }
+      opts->cost_top = vm["cost"].as<size_t>();
+      if (opts->cost_top == 0) {
+         cerr << "Error: --cost requires at least one entry"
+              << "\n";
+         return nullptr;
+      }
+   }
+
+   if (vm.count("pch") > 0) {
+      const auto spec = vm["pch"].as<string>();
+      const auto budget = parse_size(spec);
+      if (!budget || *budget == 0) {
+         cerr << "Error: Invalid PCH size: " << spec << "\n";
+         return nullptr;
+      }
+      if (opts->closure || opts->cost_top > 0) {
+         cerr << "Error: --pch can't be combined with --closure or --cost"
+              << "\n";
+         return nullptr;
+      }
+      opts->pch_budget = *budget;
+   }
+
+   if (vm.count("affected-by") > 0) {
+      if (opts->closure || opts->cost_top > 0 || opts->pch_budget > 0) {
+         cerr << "Error: --affected-by can't be combined with --closure, "
+                 "--cost or --pch"
+              << "\n";
+         return nullptr;
+      }
+      opts->affected_by = vm["affected-by"].as<vector<string> >();
+   }
+
+   if (vm.count("stream") > 0) {
+      if ("ndjson" != opts->format) {
+         cerr << "Error: --stream requires --format=ndjson"
+              << "\n";
+         return nullptr;
+      }
+      if (opts->closure || !opts->affected_by.empty() || opts->cost_top > 0 ||
+          opts->pch_budget > 0) {
+         cerr << "Error: --stream can't be combined with --closure, "
+                 "--affected-by, --cost or --pch"
+              << "\n";
+         return nullptr;
+      }
+      opts->stream = true;
+   }
+
+   if (vm.count("shard") > 0) {
+      const auto shard = Shard::parse(vm["shard"].as<string>());
+      if (!shard) {
+         cerr << "Error: invalid --shard " << vm["shard"].as<string>()
+              << " (expected i/N with 1 <= i <= N)"
+              << "\n";
+         return nullptr;
+      }
+      if (opts->closure || !opts->affected_by.empty() ||
+          !opts->socket_path.empty() || opts->cost_top > 0 ||
+          opts->pch_budget > 0) {
+         cerr << "Error: --shard can't be combined with --closure, "
+                 "--affected-by, --cost, --pch or --serve"
+              << "\n";
+         return nullptr;
+      }
+      opts->shard = *shard;
+   }
+
    opts->process_paths = vm["process-path"].as<vector<string> >();
 
    if (vm.count("out-file") > 0) {
       opts->out_file = vm["out-file"].as<string>();
    }
 
-   BOOST_LOG_TRIVIAL(trace) << "n_threads:      " << opts->n_threads;
-   BOOST_LOG_TRIVIAL(trace) << "recursive_limit: " << opts->recursive_limit;
-   BOOST_LOG_TRIVIAL(trace) << "language:        " << opts->language;
-   BOOST_LOG_TRIVIAL(trace) << "format:          " << opts->format;
-   BOOST_LOG_TRIVIAL(trace) << "out_file:        " << opts->out_file;
-   BOOST_LOG_TRIVIAL(trace) << "process_paths:   ";
+   GARDENER_LOG(trace) << "n_threads:      " << opts->n_threads;
+   GARDENER_LOG(trace) << "recursive_limit: " << opts->recursive_limit;
+   GARDENER_LOG(trace) << "language:        " << opts->language;
+   GARDENER_LOG(trace) << "format:          " << opts->format;
+   GARDENER_LOG(trace) << "out_file:        " << opts->out_file;
+   GARDENER_LOG(trace) << "process_paths:   ";
    for (const auto& p : opts->process_paths) {
-      BOOST_LOG_TRIVIAL(trace) << "    " << p;
+      GARDENER_LOG(trace) << "    " << p;
    }
-   BOOST_LOG_TRIVIAL(trace) << "exclude:         ";
+   GARDENER_LOG(trace) << "exclude:         ";
    for (const auto& e : opts->exclude) {
-      BOOST_LOG_TRIVIAL(trace) << "    " << e;
+      GARDENER_LOG(trace) << "    " << e;
    }
 
    return solver;
 }
 
+// Writes the recorded timeline (if --trace is given).
+void write_trace(const string& trace_file) {
+   if (trace_file.empty()) {
+      return;
+   }
+   ofstream of(trace_file, ofstream::binary);
+   Trace::write(of);
+   of.close();
+   if (!of) {
+      BOOST_LOG_TRIVIAL(warning) << "Failed to write the trace " << trace_file;
+   }
+}
+
+// Merges graph files (binary or GraphML), see Graph_Merger.
+int merge_main(int argc, char* argv[]) {
+   po::options_description desc("Options of merge");
+   desc.add_options()("help,h", "displays this help message and exit")(
+       "verbose,V", "sets verbosity")("out-file,o", po::value<string>(),
+                                      "output file")(
+       "format,f", po::value<string>(),
+       "output format (suported formats: dot, xml/graphml, ndjson, bin)")(
+       "compress,z", po::value<string>(),
+       "compresses the output (gzip[:LEVEL] or zstd[:LEVEL])")(
+       "threads,j", po::value<unsigned int>(),
+       "number of threads which read and sort the inputs (default=1)")(
+       "input", po::value<vector<string> >()->composing(),
+       "graph file (binary or GraphML)");
+   po::positional_options_description pos;
+   pos.add("input", -1);
+
+   try {
+      po::variables_map vm;
+      po::store(po::command_line_parser(argc, argv)
+                    .options(desc)
+                    .positional(pos)
+                    .run(),
+                vm);
+      po::notify(vm);
+
+      if (vm.count("help") > 0) {
+         cout << "Usage: include_gardener merge [options] graph...\n\n"
+              << desc << "\n";
+         return 0;
+      }
+
+      Logging::init();
+      if (vm.count("verbose") == 0) {
+         boost::log::core::get()->set_filter(boost::log::trivial::severity >=
+                                             boost::log::trivial::warning);
+      }
+
+      if (vm.count("input") == 0) {
+         cerr << "No input provided!"
+              << "\n"
+              << "\n"
+              << desc << "\n";
+         return -1;
+      }
+
+      string format = "dot";
+      if (vm.count("format") > 0) {
+         format = vm["format"].as<string>();
+      }
+      if (!("dot" == format || "xml" == format || "graphml" == format ||
+            "ndjson" == format || "bin" == format)) {
+         cerr << "Unrecognized format: " << format << "\n"
+              << "\n"
+              << desc << "\n";
+         return -1;
+      }
+
+      Compression compression;
+      if (vm.count("compress") > 0) {
+         const auto spec = vm["compress"].as<string>();
+         const auto parsed = Compression::parse(spec);
+         if (!parsed || !Compression::is_supported(parsed->method)) {
+            cerr << "Error: Unsupported compression: " << spec << "\n";
+            return -1;
+         }
+         compression = *parsed;
+      }
+
+      unsigned int n_threads = 1;
+      if (vm.count("threads") > 0) {
+         n_threads = vm["threads"].as<unsigned int>();
+         if (n_threads == 0) {
+            cerr << "Error: Please use at least one thread."
+                 << "\n";
+            return -1;
+         }
+      }
+
+      Graph_Merger merger(n_threads);
+      merger.merge(vm["input"].as<vector<string> >());
+
+      ofstream of;
+      ostream* out = &cout;
+      if (vm.count("out-file") > 0) {
+         of.open(vm["out-file"].as<string>(), ofstream::binary);
+         out = &of;
+      }
+      std::unique_ptr<Compressed_Ostream> compressed;
+      if (compression.method != Compression::Method::NONE) {
+         compressed = make_unique<Compressed_Ostream>(*out, compression);
+         out = compressed.get();
+      }
+      INCLUDE_GARDENER::write_graph(format, merger.get_graph(),
+                                    merger.get_vertexes(), *out);
+      if (compressed) {
+         compressed->close();
+      }
+   } catch (const exception& e) {
+      cerr << e.what() << "\n";
+      return -1;
+   }
+   return 0;
+}
+
 // vim: filetype=cpp et ts=3 sw=3 sts=3
@@ -0,0 +1,85 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "memory_guard.h"
+
+#include <unistd.h>
+
+#include <fstream>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using std::ifstream;
+using std::size_t;
+
+namespace INCLUDE_GARDENER {
+
+Memory_Guard::Memory_Guard(size_t max_bytes)
+    : max_bytes(max_bytes),
+      resume_bytes(max_bytes / 100 * RESUME_PERCENT),
+      n_calls(0),
+      exceeded(false) {}
+
+/// @details
+///   The second field of /proc/self/statm is the number of resident pages.
+size_t Memory_Guard::get_rss() {
+  ifstream statm("/proc/self/statm");
+  size_t n_total = 0;
+  size_t n_resident = 0;
+  if (!(statm >> n_total >> n_resident)) {
+    return 0;
+  }
+  const long page_size = sysconf(_SC_PAGESIZE);
+  return page_size > 0 ? n_resident * static_cast<size_t>(page_size) : 0;
+}
+
+bool Memory_Guard::is_exceeded() {
+  if (max_bytes == 0) {
+    return false;
+  }
+  if (n_calls.fetch_add(1, std::memory_order_relaxed) % CHECK_INTERVAL != 0) {
+    return exceeded.load(std::memory_order_relaxed);
+  }
+  return check();
+}
+
+bool Memory_Guard::check() {
+  if (max_bytes == 0) {
+    return false;
+  }
+  const size_t threshold =
+      exceeded.load(std::memory_order_relaxed) ? resume_bytes : max_bytes;
+  size_t rss = get_rss();
+#ifdef __GLIBC__
+  if (rss > threshold) {
+    malloc_trim(0);
+    rss = get_rss();
+  }
+#endif
+  const bool result = rss > threshold;
+  exceeded.store(result, std::memory_order_relaxed);
+  return result;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
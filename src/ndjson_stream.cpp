@@ -0,0 +1,195 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "ndjson_stream.h"
+
+#include <charconv>
+
+using std::ostream;
+using std::string;
+using std::string_view;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief The writer hands its buffer to the stream at this size.
+constexpr std::size_t BUFFER_SIZE = 1U << 16U;
+
+template <class T>
+void append_number(T value, string *out) {
+  char digits[24];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out->append(digits, result.ptr);
+}
+
+}  // namespace
+
+Ndjson_Stream::Ndjson_Stream(ostream &os)
+    : os(os),
+      closing(false),
+      n_pushed(0),
+      writer_waiting(false),
+      writer(&Ndjson_Stream::write_loop, this) {}
+
+Ndjson_Stream::~Ndjson_Stream() { close(); }
+
+void Ndjson_Stream::push_vertex(Vertex_Id id, const string &name,
+                                const string &abs_path) {
+  Record record;
+  record.src = id;
+  record.name = name;
+  record.abs_path = abs_path;
+  records.push(std::move(record));
+  notify_writer();
+}
+
+void Ndjson_Stream::push_edge(Vertex_Id src, Vertex_Id dst, int line) {
+  Record record;
+  record.is_edge = true;
+  record.src = src;
+  record.dst = dst;
+  record.line = line;
+  records.push(std::move(record));
+  notify_writer();
+}
+
+void Ndjson_Stream::close() {
+  if (writer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lck(wake_mutex);
+      closing = true;
+    }
+    wake_condition.notify_one();
+    writer.join();
+  }
+}
+
+/// @details
+///   n_pushed is incremented before writer_waiting is read, and the
+///   writer sets writer_waiting before it checks n_pushed: either the
+///   writer sees the new record or the pusher sees the waiting writer.
+void Ndjson_Stream::notify_writer() {
+  n_pushed.fetch_add(1);
+  if (writer_waiting) {
+    std::lock_guard<std::mutex> lck(wake_mutex);
+    wake_condition.notify_one();
+  }
+}
+
+/// @details
+///   The buffer is written whenever the queue runs empty, so consumers
+///   of the stream get the records without much delay (with a
+///   compressed output, this is where the compressor is flushed).
+///   All pushes happen before close() sets closing, therefore the writer
+///   can stop if the queue is empty after closing has been seen.
+void Ndjson_Stream::write_loop() {
+  string buffer;
+  buffer.reserve(BUFFER_SIZE + 4096);
+  Record record;
+  std::size_t n_popped = 0;
+  for (;;) {
+    const bool done = closing;
+    while (buffer.size() < BUFFER_SIZE && records.pop(&record)) {
+      ++n_popped;
+      if (record.is_edge) {
+        append_edge(record.src, record.dst, record.line, &buffer);
+      } else {
+        append_vertex(record.src, record.name, record.abs_path, &buffer);
+      }
+    }
+    if (!buffer.empty()) {
+      os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      os.flush();
+      buffer.clear();
+    } else if (done) {
+      return;
+    } else if (n_pushed == n_popped) {
+      std::unique_lock<std::mutex> lck(wake_mutex);
+      writer_waiting = true;
+      wake_condition.wait(lck,
+                          [&] { return n_pushed != n_popped || closing; });
+      writer_waiting = false;
+    } else {
+      // a push is still in progress and hides the pushed records
+      std::this_thread::yield();
+    }
+  }
+}
+
+void Ndjson_Stream::append_vertex(Vertex_Id id, string_view name,
+                                  string_view abs_path, string *out) {
+  out->append("{\"type\":\"vertex\",\"id\":");
+  append_number(id, out);
+  out->append(",\"name\":");
+  append_string(name, out);
+  out->append(",\"path\":");
+  append_string(abs_path, out);
+  out->append("}\n");
+}
+
+void Ndjson_Stream::append_edge(Vertex_Id src, Vertex_Id dst, int line,
+                                string *out) {
+  out->append("{\"type\":\"edge\",\"source\":");
+  append_number(src, out);
+  out->append(",\"target\":");
+  append_number(dst, out);
+  out->append(",\"line\":");
+  append_number(line, out);
+  out->append("}\n");
+}
+
+void Ndjson_Stream::append_string(string_view s, string *out) {
+  static const char HEX[] = "0123456789abcdef";
+  out->push_back('"');
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      case '\t':
+        out->append("\\t");
+        break;
+      case '\r':
+        out->append("\\r");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20U) {
+          out->append("\\u00");
+          out->push_back(HEX[static_cast<unsigned char>(c) >> 4U]);
+          out->push_back(HEX[static_cast<unsigned char>(c) & 0xfU]);
+        } else {
+          out->push_back(c);
+        }
+        break;
+    }
+  }
+  out->push_back('"');
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,132 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "path_table.h"
+
+using std::string;
+using std::string_view;
+using std::uint64_t;
+
+namespace INCLUDE_GARDENER {
+
+Path_Table::Path_Table() : parents{NONE}, components{NONE} {}
+
+/// @details
+///   Walks the components of path from the root and creates all
+///   missing components and nodes on the way.
+Path_Table::Id Path_Table::insert(string_view path) {
+  Id node = ROOT;
+  size_t start = 0;
+  while (true) {
+    size_t end = path.find('/', start);
+    auto part = path.substr(start, end == string_view::npos ? string_view::npos
+                                                            : end - start);
+    Id component;
+    auto c_itr = component_ids.find(part);
+    if (c_itr == component_ids.end()) {
+      component = static_cast<Id>(component_strings.size());
+      component_strings.emplace_back(part);
+      component_ids.emplace(component_strings.back(), component);
+    } else {
+      component = c_itr->second;
+    }
+
+    Id child = find_child(node, component);
+    if (child == NONE) {
+      child = static_cast<Id>(parents.size());
+      parents.push_back(node);
+      components.push_back(component);
+      children.emplace(child_key(node, component), child);
+    }
+    node = child;
+
+    if (end == string_view::npos) {
+      return node;
+    }
+    start = end + 1;
+  }
+}
+
+Path_Table::Id Path_Table::find(string_view path) const {
+  Id node = ROOT;
+  size_t start = 0;
+  while (true) {
+    size_t end = path.find('/', start);
+    auto part = path.substr(start, end == string_view::npos ? string_view::npos
+                                                            : end - start);
+    auto c_itr = component_ids.find(part);
+    if (c_itr == component_ids.end()) {
+      return NONE;
+    }
+    node = find_child(node, c_itr->second);
+    if (node == NONE || end == string_view::npos) {
+      return node;
+    }
+    start = end + 1;
+  }
+}
+
+string Path_Table::get(Id id) const {
+  string result;
+  append(id, &result);
+  return result;
+}
+
+/// @details
+///   The first walk up to the root sums up the length of the path, the
+///   second one copies the components from the back to the front.
+void Path_Table::append(Id id, string *out) const {
+  if (id == ROOT || id >= parents.size()) {
+    return;
+  }
+  size_t length = 0;
+  for (Id n = id; n != ROOT; n = parents[n]) {
+    length += component_strings[components[n]].size() + 1;
+  }
+  size_t pos = out->size() + length - 1;
+  out->resize(pos);
+  for (Id n = id; n != ROOT; n = parents[n]) {
+    const string &component = component_strings[components[n]];
+    pos -= component.size();
+    component.copy(&(*out)[pos], component.size());
+    if (parents[n] != ROOT) {
+      (*out)[--pos] = '/';
+    }
+  }
+}
+
+size_t Path_Table::size() const { return parents.size(); }
+
+size_t Path_Table::get_n_components() const {
+  return component_strings.size();
+}
+
+Path_Table::Id Path_Table::find_child(Id parent, Id component) const {
+  auto itr = children.find(child_key(parent, component));
+  return itr == children.end() ? NONE : itr->second;
+}
+
+uint64_t Path_Table::child_key(Id parent, Id component) {
+  return (static_cast<uint64_t>(parent) << 32U) | component;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
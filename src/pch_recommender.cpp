@@ -0,0 +1,106 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "pch_recommender.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using std::size_t;
+using std::uint64_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+Pch_Recommender::Pch_Recommender(const Transitive_Closure &closure,
+                                 const Vertex_Table &vertexes,
+                                 const Include_Cost &cost, uint64_t budget,
+                                 unsigned int n_threads)
+    : selected_bytes(0) {
+  for (const auto &h : cost.get_headers()) {
+    if (h.n_units >= MIN_UNITS) {
+      candidates.push_back(Pch_Candidate{h.header, h.n_units, 0, 0});
+    }
+  }
+
+  // transitive bytes of each candidate
+  n_threads = std::max(n_threads, 1U);
+  std::atomic<size_t> next(0);
+  auto work = [&] {
+    for (size_t i = next++; i < candidates.size(); i = next++) {
+      auto &c = candidates[i];
+      c.bytes = vertexes.get_file_size(c.header).bytes;
+      for (auto w : closure.get_reachable(c.header)) {
+        if (w != c.header) {
+          c.bytes += vertexes.get_file_size(w).bytes;
+        }
+      }
+      c.score = c.n_units * c.bytes;
+    }
+  };
+  vector<std::thread> threads;
+  for (unsigned int t = 1; t < n_threads; ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &t : threads) {
+    t.join();
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Pch_Candidate &a, const Pch_Candidate &b) {
+              return a.score != b.score ? a.score > b.score
+                                        : a.header < b.header;
+            });
+
+  // greedy selection within the budget
+  vector<bool> in_pch(vertexes.size(), false);
+  vector<Vertex_Id> files;
+  for (const auto &c : candidates) {
+    if (c.score == 0) {
+      break;  // only headers which were not scanned follow
+    }
+    if (in_pch[c.header]) {
+      continue;
+    }
+    files = closure.get_reachable(c.header);
+    if (!closure.reaches(c.header, c.header)) {
+      files.push_back(c.header);
+    }
+    uint64_t added = 0;
+    for (auto w : files) {
+      if (!in_pch[w]) {
+        added += vertexes.get_file_size(w).bytes;
+      }
+    }
+    if (selected_bytes + added > budget) {
+      continue;
+    }
+    for (auto w : files) {
+      in_pch[w] = true;
+    }
+    selected_bytes += added;
+    selected.push_back(c);
+  }
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,370 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "query_server.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include "file_detector.h"
+#include "gardener_log.h"
+#include "statement_detector.h"
+
+using std::deque;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Time after which a blocked reply to a client is given up.
+const timeval SEND_TIMEOUT{5, 0};
+
+string error_reply(const string &message) {
+  return "ERROR " + message + "\n\n";
+}
+
+runtime_error system_error(const string &what) {
+  return runtime_error(what + ": " + std::strerror(errno));
+}
+
+/// @brief Writes all data to fd.
+/// @details Returns false if the client is gone (EPIPE is returned instead
+///          of raising SIGPIPE).
+bool write_all(int fd, const string &data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    auto n = ::send(fd, data.data() + written, data.size() - written,
+                    MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    written += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+/// @brief Removes a stale socket at path.
+/// @details Other files are never removed: if path exists and is not a
+///          socket, std::runtime_error is thrown.
+void remove_stale_socket(const string &path) {
+  struct stat st {};
+  if (::lstat(path.c_str(), &st) != 0) {
+    if (errno == ENOENT) {
+      return;
+    }
+    throw system_error("Failed to check " + path);
+  }
+  if (!S_ISSOCK(st.st_mode)) {
+    throw runtime_error("Failed to listen on " + path +
+                        ": path exists and is not a socket");
+  }
+  ::unlink(path.c_str());
+}
+
+/// @brief Removes the socket at path if it is still the one with the
+///        given device and inode (i.e. the one created by this process).
+void remove_own_socket(const string &path, const struct stat &own) {
+  struct stat st {};
+  if (::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode) &&
+      st.st_dev == own.st_dev && st.st_ino == own.st_ino) {
+    ::unlink(path.c_str());
+  }
+}
+
+}  // namespace
+
+Query_Server::Query_Server(Solver::Ptr solver, int n_workers,
+                           vector<string> process_paths)
+    : solver(std::move(solver)),
+      n_workers(n_workers),
+      process_paths(std::move(process_paths)),
+      shut_down(false) {}
+
+void Query_Server::serve(const string &socket_path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    throw runtime_error("Socket path is too long: " + socket_path);
+  }
+  std::strncpy(address.sun_path, socket_path.c_str(),
+               sizeof(address.sun_path) - 1);
+
+  remove_stale_socket(socket_path);
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw system_error("Failed to create socket");
+  }
+  if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) !=
+      0) {
+    auto error = system_error("Failed to listen on " + socket_path);
+    ::close(fd);
+    throw error;
+  }
+  struct stat own {};
+  if (::lstat(socket_path.c_str(), &own) != 0 ||
+      ::listen(fd, SOMAXCONN) != 0) {
+    auto error = system_error("Failed to listen on " + socket_path);
+    ::close(fd);
+    ::unlink(socket_path.c_str());
+    throw error;
+  }
+  BOOST_LOG_TRIVIAL(info) << "Listening on " << socket_path;
+
+  // Clients and their received, not yet complete request lines.
+  std::map<int, string> clients;
+  auto close_all = [&] {
+    for (const auto &client : clients) {
+      ::close(client.first);
+    }
+    ::close(fd);
+    remove_own_socket(socket_path, own);
+  };
+  while (!shut_down) {
+    vector<pollfd> fds{{fd, POLLIN, 0}};
+    for (const auto &client : clients) {
+      fds.push_back({client.first, POLLIN, 0});
+    }
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto error = system_error("Failed to wait for a connection");
+      close_all();
+      throw error;
+    }
+    for (size_t i = 1; i < fds.size() && !shut_down; ++i) {
+      const int client = fds[i].fd;
+      if (fds[i].revents != 0 && !serve_client(client, &clients[client])) {
+        ::close(client);
+        clients.erase(client);
+      }
+    }
+    if (fds[0].revents != 0 && !shut_down) {
+      const int client = ::accept(fd, nullptr, nullptr);
+      if (client >= 0) {
+        // A client which does not read its replies is dropped instead of
+        // blocking the others.
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &SEND_TIMEOUT,
+                     sizeof(SEND_TIMEOUT));
+        clients.emplace(client, string());
+      } else if (errno != EINTR && errno != ECONNABORTED) {
+        auto error = system_error("Failed to accept a connection");
+        close_all();
+        throw error;
+      }
+    }
+  }
+  close_all();
+}
+
+/// @details Reads what is available (the socket is readable, so read()
+///          does not block) and answers each complete request line.
+bool Query_Server::serve_client(int fd, string *pending) {
+  char buffer[4096];
+  ssize_t n;
+  do {
+    n = ::read(fd, buffer, sizeof(buffer));
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return false;
+  }
+  pending->append(buffer, static_cast<size_t>(n));
+  for (auto pos = pending->find('\n'); pos != string::npos && !shut_down;
+       pos = pending->find('\n')) {
+    const string request = pending->substr(0, pos);
+    pending->erase(0, pos + 1);
+    if (!write_all(fd, handle(request))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+string Query_Server::handle(const string &request) {
+  std::istringstream is(request);
+  string command;
+  vector<string> args;
+  is >> command;
+  for (string arg; is >> arg;) {
+    args.push_back(arg);
+  }
+  GARDENER_LOG(debug) << "Request: " << request;
+
+  if (command == "shutdown" && args.empty()) {
+    shut_down = true;
+    return "OK\n\n";
+  }
+  if (command == "rescan" && !args.empty()) {
+    return rescan(args);
+  }
+
+  vector<Vertex_Id> files;
+  for (const auto &arg : args) {
+    files.push_back(solver->find_file(arg));
+    if (files.back() == NO_VERTEX) {
+      return error_reply("unknown file " + arg);
+    }
+  }
+  if (command == "deps" && files.size() == 1) {
+    return get_dependencies(files[0]);
+  }
+  if (command == "rdeps" && files.size() == 1) {
+    return get_dependents(files[0]);
+  }
+  if (command == "path" && files.size() == 2) {
+    return get_path(files[0], files[1]);
+  }
+  return error_reply("invalid request: " + request);
+}
+
+void Query_Server::append_key(Vertex_Id v, string *reply) const {
+  const auto &vertexes = solver->get_vertexes();
+  const auto size = reply->size();
+  vertexes.append_abs_path(v, reply);
+  if (reply->size() == size) {
+    vertexes.append_name(v, reply);
+  }
+}
+
+const Csr_Graph &Query_Server::get_reverse() {
+  if (!reverse) {
+    reverse =
+        std::make_unique<Csr_Graph>(Csr_Graph(solver->get_graph()).reversed());
+  }
+  return *reverse;
+}
+
+string Query_Server::get_dependencies(Vertex_Id v) {
+  const auto &graph = solver->get_graph();
+  string reply = "OK\n";
+  for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+    append_key(static_cast<Vertex_Id>(boost::target(e, graph)), &reply);
+    reply.push_back('\n');
+  }
+  reply.push_back('\n');
+  return reply;
+}
+
+string Query_Server::get_dependents(Vertex_Id v) {
+  const auto &r = get_reverse();
+  string reply = "OK\n";
+  for (auto e = r.get_first_edge(v); e < r.get_end_edge(v); ++e) {
+    append_key(r.get_target(e), &reply);
+    reply.push_back('\n');
+  }
+  reply.push_back('\n');
+  return reply;
+}
+
+/// @details Breadth-first search from the first file, so the chain is a
+///          shortest one.
+string Query_Server::get_path(Vertex_Id from, Vertex_Id to) {
+  const auto &graph = solver->get_graph();
+  const auto n_vertices = static_cast<Vertex_Id>(boost::num_vertices(graph));
+  vector<Vertex_Id> parent(n_vertices, NO_VERTEX);
+  vector<int> line(n_vertices, START_LINE);
+  deque<Vertex_Id> queue{from};
+  parent[from] = from;
+  while (!queue.empty() && parent[to] == NO_VERTEX) {
+    const Vertex_Id v = queue.front();
+    queue.pop_front();
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph))) {
+      const auto w = static_cast<Vertex_Id>(boost::target(e, graph));
+      if (parent[w] == NO_VERTEX) {
+        parent[w] = v;
+        line[w] = graph[e].line;
+        queue.push_back(w);
+      }
+    }
+  }
+  if (parent[to] == NO_VERTEX) {
+    return error_reply("no path");
+  }
+
+  vector<Vertex_Id> chain{to};
+  while (chain.back() != from) {
+    chain.push_back(parent[chain.back()]);
+  }
+  string reply = "OK\n";
+  for (auto i = chain.size() - 1; i > 0; --i) {
+    append_key(chain[i], &reply);
+    reply += ":" + std::to_string(line[chain[i - 1]]) + "\n";
+  }
+  append_key(to, &reply);
+  reply += "\n\n";
+  return reply;
+}
+
+/// @details
+///   The old edges of the files are removed, then the files are processed
+///   like in the initial scan. Unknown files are added as new vertices,
+///   named like the walk of the initial scan would name them.
+string Query_Server::rescan(const vector<string> &files) {
+  vector<string> paths;
+  for (const auto &file : files) {
+    boost::system::error_code ec;
+    auto path = boost::filesystem::canonical(file, ec);
+    if (ec || !boost::filesystem::is_regular_file(path)) {
+      return error_reply("can't read " + file);
+    }
+    paths.push_back(path.string());
+  }
+
+  for (const auto &path : paths) {
+    auto v = solver->find_file(path);
+    if (v == NO_VERTEX) {
+      v = solver->add_vertex(File_Detector::get_name(process_paths, path),
+                             path);
+    }
+    solver->remove_out_edges(v);
+  }
+  Statement_Detector detector(solver, n_workers);
+  for (const auto &path : paths) {
+    detector.add_job(path);
+  }
+  detector.wait_for_workers();
+  reverse.reset();
+  return "OK\n" + std::to_string(paths.size()) + " files rescanned\n\n";
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,219 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "run_stats.h"
+
+#include "trace.h"
+
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using std::deque;
+using std::lock_guard;
+using std::mutex;
+using std::ostream;
+using std::pair;
+using std::setw;
+using std::string;
+using std::uint64_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief All registered threads and phases.
+struct Registry {
+  mutex registry_mutex;
+  deque<Thread_Stats> threads;  // a deque never moves its elements
+  vector<pair<string, Run_Stats::Clock::duration>> phases;
+  vector<pair<string, Queue_Stats>> queues;
+};
+
+Registry &registry() {
+  static Registry r;
+  return r;
+}
+
+/// @brief The statistics of the calling thread (registered at first use
+///        while the statistics or the trace are enabled).
+thread_local Thread_Stats *current = nullptr;
+
+/// @brief Returns true if the statistics of the threads are reported.
+bool is_recording() { return Run_Stats::is_enabled() || Trace::is_enabled(); }
+
+double to_ms(uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+double to_seconds(Run_Stats::Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+}  // namespace
+
+std::atomic<bool> Run_Stats::enabled{false};
+
+void Run_Stats::enable() { enabled = true; }
+
+void Run_Stats::disable() { enabled = false; }
+
+/// @details
+///   While neither the statistics nor the trace are enabled, the counters
+///   of a thread are not registered, so threads of repeated runs (e.g. of
+///   the library or of a rescan in --serve) don't grow the registry.
+Thread_Stats &Run_Stats::local() {
+  if (current == nullptr) {
+    if (!is_recording()) {
+      thread_local Thread_Stats unregistered;
+      return unregistered;
+    }
+    auto &r = registry();
+    lock_guard<mutex> lck(r.registry_mutex);
+    r.threads.emplace_back();
+    current = &r.threads.back();
+    current->id = static_cast<unsigned int>(r.threads.size() - 1);
+    current->name = "thread " + std::to_string(r.threads.size() - 1);
+  }
+  return *current;
+}
+
+void Run_Stats::set_thread_name(const string &name) {
+  auto &stats = local();
+  lock_guard<mutex> lck(registry().registry_mutex);
+  stats.name = name;
+}
+
+void Run_Stats::add_phase(const string &name, Clock::duration duration) {
+  if (!is_enabled()) {
+    return;
+  }
+  auto &r = registry();
+  lock_guard<mutex> lck(r.registry_mutex);
+  r.phases.emplace_back(name, duration);
+}
+
+void Run_Stats::add_queue(const string &name, const Queue_Stats &stats) {
+  if (!is_enabled()) {
+    return;
+  }
+  auto &r = registry();
+  lock_guard<mutex> lck(r.registry_mutex);
+  r.queues.emplace_back(name, stats);
+}
+
+void Run_Stats::for_each_thread(
+    const std::function<void(const Thread_Stats &)> &fn) {
+  auto &r = registry();
+  lock_guard<mutex> lck(r.registry_mutex);
+  for (const auto &t : r.threads) {
+    fn(t);
+  }
+}
+
+/// @details
+///   The rates refer to the wall time of the "scan" phase (if any).
+void Run_Stats::write_report(ostream &os) {
+  auto &r = registry();
+  lock_guard<mutex> lck(r.registry_mutex);
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+
+  os << "Phases:\n";
+  double scan_seconds = 0;
+  for (const auto &p : r.phases) {
+    os << "  " << std::left << setw(16) << p.first << std::right << setw(12)
+       << to_seconds(p.second) * 1e3 << " ms\n";
+    if ("scan" == p.first) {
+      scan_seconds += to_seconds(p.second);
+    }
+  }
+
+  uint64_t files = 0;
+  uint64_t bytes = 0;
+  uint64_t lines = 0;
+  uint64_t regex_calls = 0;
+  uint64_t regex_matches = 0;
+  uint64_t probes = 0;
+  uint64_t probe_hits = 0;
+  for (const auto &t : r.threads) {
+    files += t.n_files.get();
+    bytes += t.n_bytes.get();
+    lines += t.n_lines.get();
+    regex_calls += t.n_regex_calls.get();
+    regex_matches += t.n_regex_matches.get();
+    probes += t.n_probes.get();
+    probe_hits += t.n_probe_hits.get();
+  }
+  os << "Scan:\n"
+     << "  files:             " << files << "\n"
+     << "  bytes:             " << bytes << "\n"
+     << "  lines:             " << lines << "\n";
+  if (scan_seconds > 0) {
+    os << "  MB/s:              "
+       << static_cast<double>(bytes) / 1e6 / scan_seconds << "\n"
+       << "  lines/s:           " << static_cast<double>(lines) / scan_seconds
+       << "\n";
+  }
+  os << "  regex calls:       " << regex_calls << "\n"
+     << "  regex matches:     " << regex_matches << "\n"
+     << "Resolution:\n"
+     << "  probes:            " << probes << "\n"
+     << "  hits:              " << probe_hits << "\n";
+
+  if (!r.queues.empty()) {
+    os << "Queues:\n"
+       << "  " << std::left << setw(12) << "queue" << std::right << setw(10)
+       << "capacity" << setw(10) << "pushes" << setw(12) << "mean depth"
+       << setw(10) << "max depth" << setw(8) << "full" << setw(8) << "empty"
+       << "\n";
+  }
+  for (const auto &q : r.queues) {
+    const auto &stats = q.second;
+    const double mean =
+        stats.n_pushes == 0 ? 0.0
+                            : static_cast<double>(stats.depth_sum) /
+                                  static_cast<double>(stats.n_pushes);
+    os << "  " << std::left << setw(12) << q.first << std::right << setw(10)
+       << stats.capacity << setw(10) << stats.n_pushes << setw(12) << mean
+       << setw(10) << stats.max_depth << setw(8) << stats.n_full << setw(8)
+       << stats.n_empty << "\n";
+  }
+
+  os << "Threads:\n"
+     << "  " << std::left << setw(12) << "thread" << std::right << setw(8)
+     << "files" << setw(12) << "bytes" << setw(12) << "busy ms" << setw(14)
+     << "graph wait ms" << setw(14) << "queue wait ms"
+     << "\n";
+  for (const auto &t : r.threads) {
+    os << "  " << std::left << setw(12) << t.name << std::right << setw(8)
+       << t.n_files.get() << setw(12) << t.n_bytes.get() << setw(12)
+       << to_ms(t.busy_ns.get()) << setw(14) << to_ms(t.graph_wait_ns.get())
+       << setw(14) << to_ms(t.job_queue_wait_ns.get()) << "\n";
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,292 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "scan_cache.h"
+
+#include <sys/stat.h>
+
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "content_hash.h"
+#include "helper.h"
+
+using std::ifstream;
+using std::int64_t;
+using std::lock_guard;
+using std::mutex;
+using std::ofstream;
+using std::optional;
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Identifies the cache file format (and its version).
+constexpr char MAGIC[8] = {'I', 'G', 'C', 'A', 'C', 'H', 'E', '2'};
+
+/// @brief Detects cache files of machines with a different byte order.
+constexpr uint32_t ENDIAN_CHECK = 0x01020304U;
+
+/// @brief Returns size and mtime of a file.
+bool stat_file(const string &path, uint64_t *size, int64_t *mtime) {
+  struct stat st {};
+  if (::stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  *size = static_cast<uint64_t>(st.st_size);
+  *mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+           st.st_mtim.tv_nsec;
+  return true;
+}
+
+template <class T>
+void write_value(ofstream &of, T value) {
+  of.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void write_string(ofstream &of, const string &s) {
+  write_value(of, static_cast<uint32_t>(s.size()));
+  of.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+template <class T>
+bool read_value(ifstream &ifs, T *value) {
+  return static_cast<bool>(
+      ifs.read(reinterpret_cast<char *>(value), sizeof(*value)));
+}
+
+bool read_string(ifstream &ifs, uint64_t file_size, string *s) {
+  uint32_t size;
+  if (!read_value(ifs, &size)) {
+    return false;
+  }
+  // a broken length must not allocate more than the file can hold
+  const auto pos = ifs.tellg();
+  if (pos < 0 || size > file_size - static_cast<uint64_t>(pos)) {
+    return false;
+  }
+  s->resize(size);
+  return static_cast<bool>(ifs.read(&(*s)[0], size));
+}
+
+}  // namespace
+
+Scan_Cache::Scan_Cache(string cache_path,
+                       const vector<string> &statement_regex)
+    : cache_path(std::move(cache_path)), regex_hash(0), n_hits(0), n_misses(0) {
+  for (const auto &r : statement_regex) {
+    regex_hash = content_hash(r.data(), r.size(), regex_hash + 1);
+  }
+  if (!load()) {
+    entries.clear();
+  }
+}
+
+/// @details
+///   If only the mtime changed, the file is read and hashed without holding
+///   the lock; the entry is re-checked afterwards.
+optional<vector<Detected_Statement>> Scan_Cache::lookup(
+    const string &abs_path, optional<string> *content, File_Size *file_size) {
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  const bool exists = stat_file(abs_path, &size, &mtime);
+
+  auto miss = [&](Entry &entry) {
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.valid = false;
+    entry.statements.clear();
+    ++n_misses;
+  };
+
+  uint64_t hash;
+  {
+    lock_guard<mutex> lck(entries_mutex);
+    auto &entry = entries[abs_path];
+    entry.used = true;
+    if (!exists || !entry.valid || entry.size != size) {
+      miss(entry);
+      return {};
+    }
+    if (file_size != nullptr) {
+      // only used by the caller on a hit
+      *file_size = File_Size{entry.size, entry.lines};
+    }
+    if (entry.mtime == mtime) {
+      ++n_hits;
+      return entry.statements;
+    }
+    hash = entry.hash;
+  }
+
+  // touched, but maybe not modified: compare the content
+  string data;
+  const bool read = read_file(abs_path, &data) && data.size() == size;
+  const bool same = read && content_hash(data.data(), data.size()) == hash;
+
+  lock_guard<mutex> lck(entries_mutex);
+  auto &entry = entries[abs_path];
+  if (same && entry.valid && entry.size == size && entry.hash == hash) {
+    entry.mtime = mtime;
+    ++n_hits;
+    return entry.statements;
+  }
+  if (read) {
+    *content = std::move(data);
+  }
+  miss(entry);
+  return {};
+}
+
+/// @details
+///   The size and mtime, taken by lookup() before the file was read, are
+///   kept: if the file is modified while it is scanned, the entry is
+///   outdated at the next lookup. If the size doesn't match the content,
+///   the file was modified before it was read and the entry stays invalid.
+void Scan_Cache::store(const string &abs_path, uint64_t size, uint64_t hash,
+                       vector<Detected_Statement> statements, uint32_t lines) {
+  lock_guard<mutex> lck(entries_mutex);
+  auto &entry = entries[abs_path];
+  entry.used = true;
+  if (entry.size != size) {
+    return;
+  }
+  entry.hash = hash;
+  entry.lines = lines;
+  entry.statements = std::move(statements);
+  entry.valid = true;
+}
+
+bool Scan_Cache::load() {
+  ifstream ifs(cache_path, ifstream::binary);
+  if (!ifs) {
+    return false;
+  }
+  ifs.seekg(0, ifstream::end);
+  const auto end = ifs.tellg();
+  ifs.seekg(0, ifstream::beg);
+  if (end < 0) {
+    return false;
+  }
+  const auto file_size = static_cast<uint64_t>(end);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t endian_check;
+  uint64_t file_regex_hash;
+  uint64_t n_entries;
+  if (!ifs.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !read_value(ifs, &endian_check) || endian_check != ENDIAN_CHECK ||
+      !read_value(ifs, &file_regex_hash) || file_regex_hash != regex_hash ||
+      !read_value(ifs, &n_entries)) {
+    return false;
+  }
+
+  for (uint64_t i = 0; i < n_entries; ++i) {
+    string path;
+    Entry entry;
+    uint32_t n_statements;
+    if (!read_string(ifs, file_size, &path) ||
+        !read_value(ifs, &entry.size) || !read_value(ifs, &entry.mtime) ||
+        !read_value(ifs, &entry.hash) ||
+        !read_value(ifs, &entry.lines) || !read_value(ifs, &n_statements)) {
+      return false;
+    }
+    for (uint32_t k = 0; k < n_statements; ++k) {
+      Detected_Statement s;
+      if (!read_string(ifs, file_size, &s.statement) ||
+          !read_value(ifs, &s.idx) || !read_value(ifs, &s.line_no)) {
+        return false;
+      }
+      entry.statements.push_back(std::move(s));
+    }
+    entry.valid = true;
+    entries.emplace(std::move(path), std::move(entry));
+  }
+  return true;
+}
+
+/// @details
+///   The entries are written to a temporary file, which then replaces the
+///   cache file, so an interrupted run never leaves a broken cache.
+bool Scan_Cache::save() {
+  lock_guard<mutex> lck(entries_mutex);
+  const string tmp_path = cache_path + ".tmp";
+  {
+    ofstream of(tmp_path, ofstream::binary | ofstream::trunc);
+    if (!of) {
+      return false;
+    }
+    uint64_t n_entries = 0;
+    for (const auto &e : entries) {
+      n_entries += (e.second.valid && e.second.used) ? 1U : 0U;
+    }
+    of.write(MAGIC, sizeof(MAGIC));
+    write_value(of, ENDIAN_CHECK);
+    write_value(of, regex_hash);
+    write_value(of, n_entries);
+    for (const auto &e : entries) {
+      const auto &entry = e.second;
+      if (!entry.valid || !entry.used) {
+        continue;
+      }
+      write_string(of, e.first);
+      write_value(of, entry.size);
+      write_value(of, entry.mtime);
+      write_value(of, entry.hash);
+      write_value(of, entry.lines);
+      write_value(of, static_cast<uint32_t>(entry.statements.size()));
+      for (const auto &s : entry.statements) {
+        write_string(of, s.statement);
+        write_value(of, s.idx);
+        write_value(of, s.line_no);
+      }
+    }
+    of.flush();
+    if (!of) {
+      return false;
+    }
+  }
+  boost::system::error_code ec;
+  boost::filesystem::rename(tmp_path, cache_path, ec);
+  return !ec;
+}
+
+size_t Scan_Cache::get_n_hits() const {
+  lock_guard<mutex> lck(entries_mutex);
+  return n_hits;
+}
+
+size_t Scan_Cache::get_n_misses() const {
+  lock_guard<mutex> lck(entries_mutex);
+  return n_misses;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
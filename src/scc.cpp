@@ -0,0 +1,105 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "scc.h"
+
+#include <algorithm>
+#include <limits>
+
+using std::size_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+constexpr std::uint32_t UNVISITED = std::numeric_limits<std::uint32_t>::max();
+
+/// @brief A vertex on the DFS stack and its next out-edge.
+struct Frame {
+  Vertex_Id v;
+  size_t next_edge;
+};
+
+}  // namespace
+
+Strong_Components::Strong_Components(const Csr_Graph &graph) {
+  const Vertex_Id n_vertices = graph.get_n_vertices();
+  component.assign(n_vertices, UNVISITED);
+  members.reserve(n_vertices);
+  first_member.push_back(0);
+
+  vector<std::uint32_t> index(n_vertices, UNVISITED);
+  vector<std::uint32_t> low_link(n_vertices, 0);
+  vector<Vertex_Id> tarjan_stack;
+  vector<Frame> dfs_stack;
+  std::uint32_t next_index = 0;
+
+  auto visit = [&](Vertex_Id v) {
+    index[v] = low_link[v] = next_index++;
+    tarjan_stack.push_back(v);
+    dfs_stack.push_back(Frame{v, graph.get_first_edge(v)});
+  };
+
+  for (Vertex_Id root = 0; root < n_vertices; ++root) {
+    if (index[root] != UNVISITED) {
+      continue;
+    }
+    visit(root);
+    while (!dfs_stack.empty()) {
+      auto &frame = dfs_stack.back();
+      const Vertex_Id v = frame.v;
+      if (frame.next_edge < graph.get_end_edge(v)) {
+        const Vertex_Id w = graph.get_target(frame.next_edge++);
+        if (index[w] == UNVISITED) {
+          visit(w);  // invalidates frame
+        } else if (component[w] == UNVISITED) {
+          // w is on the Tarjan stack
+          low_link[v] = std::min(low_link[v], index[w]);
+        }
+        continue;
+      }
+
+      // all successors are done
+      dfs_stack.pop_back();
+      if (!dfs_stack.empty()) {
+        const Vertex_Id parent = dfs_stack.back().v;
+        low_link[parent] = std::min(low_link[parent], low_link[v]);
+      }
+      if (low_link[v] != index[v]) {
+        continue;
+      }
+      // v is the root of a component
+      const auto c = static_cast<Id>(first_member.size() - 1);
+      Vertex_Id w;
+      do {
+        w = tarjan_stack.back();
+        tarjan_stack.pop_back();
+        component[w] = c;
+        members.push_back(w);
+      } while (w != v);
+      first_member.push_back(members.size());
+    }
+  }
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,70 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "shard.h"
+
+#include "content_hash.h"
+
+using std::optional;
+using std::string;
+using std::string_view;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Parses a positive decimal number (without sign).
+optional<unsigned int> parse_number(const string &s) {
+  if (s.empty() || s.size() > 9 ||
+      s.find_first_not_of("0123456789") != string::npos) {
+    return {};
+  }
+  const auto value = std::stoul(s);
+  if (value == 0) {
+    return {};
+  }
+  return static_cast<unsigned int>(value);
+}
+
+}  // namespace
+
+optional<Shard> Shard::parse(const string &spec) {
+  const auto slash = spec.find('/');
+  if (slash == string::npos) {
+    return {};
+  }
+  const auto index = parse_number(spec.substr(0, slash));
+  const auto count = parse_number(spec.substr(slash + 1));
+  if (!index || !count || *index > *count) {
+    return {};
+  }
+  return Shard{*index, *count};
+}
+
+bool Shard::contains(string_view name) const {
+  if (count <= 1) {
+    return true;
+  }
+  return content_hash(name.data(), name.size()) % count == index - 1;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -20,45 +20,102 @@
 //
 #include "solver.h"
 
+#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <tuple>
 
+#include <boost/filesystem.hpp>
 #include <boost/graph/graphml.hpp>
 #include <boost/graph/graphviz.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/property_map/transform_value_property_map.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/regex.hpp>
 
+#include "csr_graph.h"
+#include "cycles.h"
+#include "gardener_log.h"
+#include "graph_writer.h"
+#include "impact.h"
+#include "include_cost.h"
+#include "pch_recommender.h"
+#include "run_stats.h"
+#include "trace.h"
 #include "solver_c.h"
 #include "solver_py.h"
 #include "solver_rb.h"
+#include "transitive_closure.h"
 
-using std::make_shared;
+using std::pair;
 using std::string;
+using std::vector;
 
 namespace INCLUDE_GARDENER {
 
-void Solver::add_vertex(const std::string& name, const std::string& abs_path) {
-  using std::pair;
-  using std::string;
-  // if abs_path is empty, take the name as key!
-  const string& key = abs_path.length() == 0 ? name : abs_path;
-
-  if (vertexes.find(key) != vertexes.end()) {
-    BOOST_LOG_TRIVIAL(trace) << "No need to add a new vertex, "
-                             << "vertex already exists: "
-                             << "\n"
-                             << "    key = " << key << ", "
-                             << "\n"
-                             << "    abs_path = " << abs_path << "\n"
-                             << "    name = " << name;
+Vertex_Id Solver::add_vertex(const std::string& name,
+                             const std::string& abs_path) {
+  Vertex_Id id;
+  bool added;
+  std::tie(id, added) = vertexes.insert(name, abs_path);
 
+  if (!added) {
+    GARDENER_LOG(trace) << "No need to add a new vertex, "
+                        << "vertex already exists: "
+                        << "\n"
+                        << "    key = "
+                        << (abs_path.empty() ? name : abs_path) << ", "
+                        << "\n"
+                        << "    abs_path = " << abs_path << "\n"
+                        << "    name = " << name;
   } else {
-    auto v = make_shared<Vertex>(name, abs_path);
-    vertexes.insert(pair<string, Vertex::Ptr>(key, v));
-    boost::add_vertex(key, graph);
-    graph[key] = v;
+    boost::add_vertex(graph);
+    if (stream) {
+      stream->push_vertex(id, name, abs_path);
+    }
   }
+  return id;
+}
+
+Vertex_Id Solver::find_or_add_vertex(const std::string& key) {
+  auto id = vertexes.find(key);
+  if (id == NO_VERTEX) {
+    id = add_vertex(key, "");
+  }
+  return id;
+}
+
+namespace {
+std::uint64_t edge_key(Vertex_Id src, Vertex_Id dst) {
+  return (static_cast<std::uint64_t>(src) << 32U) | dst;
+}
+}  // namespace
+
+bool Solver::insert_unique_edge(Vertex_Id src, Vertex_Id dst,
+                                unsigned int line_no) {
+  auto key = edge_key(src, dst);
+  auto itr = edge_index.find(key);
+  if (itr != edge_index.end()) {
+    graph[itr->second].count++;
+    return false;
+  }
+  auto edge =
+      boost::add_edge(src, dst, Edge{static_cast<int>(line_no)}, graph).first;
+  edge_index.emplace(key, edge);
+  if (stream) {
+    stream->push_edge(src, dst, static_cast<int>(line_no));
+  }
+  return true;
+}
+
+bool Solver::count_edge(Vertex_Id src, Vertex_Id dst) {
+  auto itr = edge_index.find(edge_key(src, dst));
+  if (itr == edge_index.end()) {
+    return false;
+  }
+  graph[itr->second].count++;
+  return true;
 }
 
 Solver::Ptr Solver::get_solver(const std::string& name) {
@@ -75,10 +132,274 @@ Solver::Ptr Solver::get_solver(const std::string& name) {
 }
 
 void Solver::write_graph(const string& format, ostream& os) {
+  INCLUDE_GARDENER::write_graph(format, graph, vertexes, os);
+}
+
+void Solver::write_closure(ostream& os, unsigned int n_threads) {
+  const Csr_Graph csr(graph);
+  const Transitive_Closure closure(csr, n_threads);
+
+  string line;
+  for (auto v : find_units(csr)) {
+    line.clear();
+    vertexes.append_name(v, &line);
+    line.push_back(':');
+    for (auto w : closure.get_reachable(v)) {
+      line.push_back(' ');
+      vertexes.append_name(w, &line);
+    }
+    line.push_back('\n');
+    os.write(line.data(), static_cast<std::streamsize>(line.size()));
+  }
+  os.flush();
+}
+
+/// @details
+///   Header costs are the summed up costs over all units, e.g. a header
+///   of 1000 bytes, included by 10 units, costs 10000 bytes.
+void Solver::write_include_cost(ostream& os, unsigned int n_threads,
+                                std::size_t n_top) {
+  const Csr_Graph csr(graph);
+  const Transitive_Closure closure(csr, n_threads);
+  const Include_Cost cost(csr, closure, vertexes, find_units(csr),
+                          n_threads);
+  const auto& units = cost.get_units();
+  const auto& headers = cost.get_headers();
+  std::uint64_t total_bytes = 0;
+  std::uint64_t total_lines = 0;
+  for (const auto& u : units) {
+    total_bytes += u.bytes;
+    total_lines += u.lines;
+  }
+
+  using std::setw;
+  const auto flags = os.flags();
+  os << "Translation units: " << units.size() << ", bytes: " << total_bytes
+     << ", lines: " << total_lines << "\n"
+     << "Most expensive translation units:\n"
+     << std::right << setw(14) << "bytes" << setw(12) << "lines" << setw(10)
+     << "headers"
+     << "  unit\n";
+  for (std::size_t i = 0; i < std::min(n_top, units.size()); ++i) {
+    os << setw(14) << units[i].bytes << setw(12) << units[i].lines
+       << setw(10) << units[i].n_headers << "  "
+       << vertexes.get_name(units[i].unit) << "\n";
+  }
+  os << "Headers with the largest contribution:\n"
+     << setw(14) << "bytes" << setw(12) << "lines" << setw(10) << "units"
+     << "  header\n";
+  for (std::size_t i = 0; i < std::min(n_top, headers.size()); ++i) {
+    os << setw(14) << headers[i].bytes << setw(12) << headers[i].lines
+       << setw(10) << headers[i].n_units << "  "
+       << vertexes.get_name(headers[i].header) << "\n";
+  }
+  os.flags(flags);
+  os.flush();
+}
+
+void Solver::write_pch(ostream& os, unsigned int n_threads,
+                       std::uint64_t budget) {
+  const Csr_Graph csr(graph);
+  const Transitive_Closure closure(csr, n_threads);
+  const Include_Cost cost(csr, closure, vertexes, find_units(csr),
+                          n_threads);
+  const Pch_Recommender pch(closure, vertexes, cost, budget, n_threads);
+
+  using std::setw;
+  const auto flags = os.flags();
+  os << "PCH: " << pch.get_selected().size() << " of "
+     << pch.get_candidates().size() << " candidates, "
+     << pch.get_selected_bytes() << " of " << budget << " bytes\n"
+     << std::right << setw(16) << "score" << setw(10) << "units" << setw(12)
+     << "bytes"
+     << "  header\n";
+  for (const auto& c : pch.get_selected()) {
+    os << setw(16) << c.score << setw(10) << c.n_units << setw(12) << c.bytes
+       << "  " << vertexes.get_name(c.header) << "\n";
+  }
+  os.flags(flags);
+  os.flush();
+}
+
+string Solver::get_abs_path(Vertex_Id id) {
+  auto glck = lock_graph();
+  return vertexes.get_abs_path(id);
+}
+
+Vertex_Id Solver::find_file(const string& file) const {
+  auto v = NO_VERTEX;
+  boost::system::error_code ec;
+  auto path = boost::filesystem::canonical(file, ec);
+  if (!ec) {
+    v = vertexes.find(path.string());
+  }
+  if (v == NO_VERTEX) {
+    v = vertexes.find(file);
+  }
+  return v;
+}
+
+void Solver::add_edge(const string& src_path, const string& statement,
+                      unsigned int idx, unsigned int line_no) {
+  vector<Resolved_Edge> edges;
+  if (resolve_edge(src_path, statement, idx, line_no, &edges)) {
+    insert_edges(edges);
+  }
+}
+
+bool Solver::resolve_edge(const string& /*src_path*/,
+                          const string& /*statement*/, unsigned int /*idx*/,
+                          unsigned int /*line_no*/,
+                          vector<Resolved_Edge>* /*edges*/) {
+  return false;
+}
+
+void Solver::insert_edges(const vector<Resolved_Edge>& edges) {
+  if (edges.empty()) {
+    return;
+  }
+  auto glck = lock_graph();
+  for (const auto& e : edges) {
+    insert_edge(e.src_path, e.dst_path, e.name, e.line_no);
+  }
+}
+
+void Solver::insert_edge(const string& src_path, const string& dst_path,
+                         const string& name, unsigned int line_no) {
+  auto dst = add_vertex(name, dst_path);
+  auto src = find_or_add_vertex(src_path);
+  GARDENER_LOG(trace) << "insert_edge: " << src_path << " -> "
+                      << (dst_path.empty() ? name : dst_path);
+  if (!insert_unique_edge(src, dst, line_no)) {
+    GARDENER_LOG(trace) << "   |>> Duplicate edge (counted)";
+  }
+}
+
+std::unique_lock<std::mutex> Solver::lock_graph() {
+  const Scoped_Timer timer(&Run_Stats::local().graph_wait_ns);
+  const Trace_Span span("graph_mutex wait");
+  return std::unique_lock<std::mutex>(graph_mutex);
+}
+
+bool Solver::probe(const boost::filesystem::path& p) {
+  auto& stats = Run_Stats::local();
+  stats.n_probes.add(1);
+  if (boost::filesystem::exists(p)) {
+    stats.n_probe_hits.add(1);
+    return true;
+  }
+  return false;
+}
+
+void Solver::set_file_sizes(const vector<pair<string, File_Size>>& sizes) {
+  auto glck = lock_graph();
+  for (const auto& s : sizes) {
+    const auto v = vertexes.find(s.first);
+    if (v != NO_VERTEX) {
+      vertexes.set_file_size(v, s.second);
+    }
+  }
+}
+
+void Solver::remove_out_edges(Vertex_Id src) {
+  auto glck = lock_graph();
+  for (auto e : boost::make_iterator_range(boost::out_edges(src, graph))) {
+    edge_index.erase(
+        edge_key(src, static_cast<Vertex_Id>(boost::target(e, graph))));
+  }
+  boost::clear_out_edges(src, graph);
+}
+
+void Solver::write_affected(ostream& os, const vector<string>& changed_files) {
+  vector<Vertex_Id> changed;
+  for (const auto& file : changed_files) {
+    const auto v = find_file(file);
+    if (v == NO_VERTEX) {
+      BOOST_LOG_TRIVIAL(warning) << "Unknown file: " << file;
+      continue;
+    }
+    changed.push_back(v);
+  }
+
+  const Csr_Graph csr(graph);
+  vector<bool> is_unit(csr.get_n_vertices(), false);
+  for (auto v : find_units(csr)) {
+    is_unit[v] = true;
+  }
+  const auto reverse = csr.reversed();
+  string line;
+  for (auto v : find_affected(reverse, changed)) {
+    if (!is_unit[v]) {
+      continue;
+    }
+    line.clear();
+    vertexes.append_name(v, &line);
+    line.push_back('\n');
+    os.write(line.data(), static_cast<std::streamsize>(line.size()));
+  }
+  os.flush();
+}
+
+/// @details
+///   The regex is searched like the file regex (see File_Detector), but in
+///   the name, because unresolved includes have no absolute path.
+vector<Vertex_Id> Solver::find_units(const Csr_Graph& graph) const {
+  vector<Vertex_Id> units;
+  const auto unit_regex = get_unit_regex();
+  if (unit_regex.empty()) {
+    vector<bool> has_in_edge(graph.get_n_vertices(), false);
+    for (std::size_t e = 0; e < graph.get_n_edges(); ++e) {
+      has_in_edge[graph.get_target(e)] = true;
+    }
+    for (Vertex_Id v = 0; v < graph.get_n_vertices(); ++v) {
+      if (!has_in_edge[v]) {
+        units.push_back(v);
+      }
+    }
+    return units;
+  }
+  const boost::regex regex(unit_regex);
+  string name;
+  for (Vertex_Id v = 0; v < graph.get_n_vertices(); ++v) {
+    name.clear();
+    vertexes.append_name(v, &name);
+    if (boost::regex_search(name, regex)) {
+      units.push_back(v);
+    }
+  }
+  return units;
+}
+
+std::size_t Solver::report_cycles() {
+  const Csr_Graph csr(graph);
+  const Strong_Components components(csr);
+  const auto cycles = find_cycles(csr, components);
+  for (const auto& cycle : cycles) {
+    string text;
+    for (std::size_t i = 0; i < cycle.vertices.size(); ++i) {
+      vertexes.append_name(cycle.vertices[i], &text);
+      text += ":" + std::to_string(cycle.lines[i]) + " -> ";
+    }
+    vertexes.append_name(cycle.vertices.front(), &text);
+    BOOST_LOG_TRIVIAL(warning) << "Include cycle: " << text << " ("
+                               << cycle.component_size
+                               << " files in this strongly connected "
+                                  "component)";
+  }
+  return cycles.size();
+}
+
+void Solver::set_stream(Ndjson_Stream::Ptr stream) {
+  this->stream = std::move(stream);
+}
+
+void Solver::write_graph_boost(const string& format, ostream& os) {
   // prepare the name-map for graphviz output generation
   auto name_map = boost::make_transform_value_property_map(
-      [](const Vertex::Ptr & v) { return v->get_name(); },
-      get(boost::vertex_bundle, graph));
+      [this](Vertex_Descriptor v) {
+        return vertexes.get_name(static_cast<Vertex_Id>(v));
+      },
+      get(boost::vertex_index, graph));
 
   if ("dot" == format) {
     write_graphviz(os, graph, make_vertex_writer(name_map),
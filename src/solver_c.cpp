@@ -26,12 +26,12 @@
 #include <boost/filesystem.hpp>
 #include <boost/log/trivial.hpp>
 
+#include "gardener_log.h"
+
 namespace INCLUDE_GARDENER {
 
 namespace po = boost::program_options;
-using std::mutex;
 using std::string;
-using std::unique_lock;
 using std::vector;
 
 vector<string> Solver_C::get_statement_regex() const {
@@ -45,82 +45,63 @@ string Solver_C::get_file_regex() const { return string("(.*)\\.(c|h)$"); }
 void Solver_C::add_options(po::options_description *options) const {
   options->add_options()("c-include-path,I",
                          po::value<vector<string> >()->composing(),
-                         "c-include path");
+                         "c-include path")(
+      "c-unit-regex", po::value<string>(),
+      "regex of the translation units (default: source files), used by "
+      "--closure, --cost, --pch and --affected-by");
 }
 
 void Solver_C::extract_options(const po::variables_map &vm) {
   if (vm.count("c-include-path") != 0U) {
     include_paths = vm["c-include-path"].as<vector<string> >();
   }
-  BOOST_LOG_TRIVIAL(trace) << "c-include-paths:   ";
+  if (vm.count("c-unit-regex") != 0U) {
+    unit_regex = vm["c-unit-regex"].as<string>();
+  }
+  GARDENER_LOG(trace) << "c-include-paths:   ";
   for (const auto &p : include_paths) {
-    BOOST_LOG_TRIVIAL(trace) << "    " << p;
+    GARDENER_LOG(trace) << "    " << p;
   }
 }
 
-void Solver_C::add_edge(const string &src_path, const string &statement,
-                        unsigned int idx, unsigned int line_no) {
+bool Solver_C::resolve_edge(const string &src_path, const string &statement,
+                            unsigned int idx, unsigned int line_no,
+                            vector<Resolved_Edge> *edges) {
   using boost::filesystem::path;
   using boost::filesystem::operator/;
-  unique_lock<mutex> glck(graph_mutex);
-  BOOST_LOG_TRIVIAL(trace) << "add_edge: " << src_path << " -> " << statement
-                           << ", idx = " << idx << ", line_no = " << line_no;
+  GARDENER_LOG(trace) << "resolve_edge: " << src_path << " -> " << statement
+                      << ", idx = " << idx << ", line_no = " << line_no;
 
   if (0 == idx) {
     // construct relative path from the same directory as
     // the file that contains the #include statement.
     path base = path(src_path).parent_path();
     path dst_path = base / statement;
-    if (exists(dst_path)) {
+    if (probe(dst_path)) {
       dst_path = canonical(dst_path);
-      BOOST_LOG_TRIVIAL(trace) << "   |>> Relative Edge";
-      insert_edge(src_path, dst_path.string(), statement, line_no);
-      return;
+      GARDENER_LOG(trace) << "   |>> Relative Edge";
+      edges->push_back(
+          Resolved_Edge{src_path, dst_path.string(), statement, line_no});
+      return true;
     }
   }
 
   // search in preconfigured list of standard system directories
   for (const auto &i_path : include_paths) {
     path dst_path = i_path / statement;
-    if (exists(dst_path)) {
+    if (probe(dst_path)) {
       dst_path = canonical(dst_path);
-      BOOST_LOG_TRIVIAL(trace) << "   |>> Absolute Edge";
-      insert_edge(src_path, dst_path.string(), statement, line_no);
-      return;
+      GARDENER_LOG(trace) << "   |>> Absolute Edge";
+      edges->push_back(
+          Resolved_Edge{src_path, dst_path.string(), statement, line_no});
+      return true;
     }
   }
 
   // if non of the cases above found a file:
   // -> add an dummy entry
-  insert_edge(src_path, "", statement, line_no);
-}
-
-void Solver_C::insert_edge(const std::string &src_path,
-                           const std::string &dst_path, const std::string &name,
-                           unsigned int line_no) {
-  add_vertex(name, dst_path);
-  string key;
-
-  Edge_Descriptor edge;
-  bool b;
-
-  if (0 == dst_path.length()) {
-    BOOST_LOG_TRIVIAL(trace) << "insert_edge: "
-                             << "\n"
-                             << "   src = " << src_path << "\n"
-                             << "   dst = " << name << "\n"
-                             << "   name = " << name;
-    boost::tie(edge, b) = boost::add_edge_by_label(src_path, name, graph);
-  } else {
-    BOOST_LOG_TRIVIAL(trace) << "insert_edge: "
-                             << "\n"
-                             << "   src = " << src_path << "\n"
-                             << "   dst = " << dst_path << "\n"
-                             << "   name = " << name;
-    boost::tie(edge, b) = boost::add_edge_by_label(src_path, dst_path, graph);
-  }
-
-  graph[edge] = Edge{static_cast<int>(line_no)};
+  edges->push_back(Resolved_Edge{src_path, "", statement, line_no});
+  return true;
 }
 
 }  // namespace INCLUDE_GARDENER
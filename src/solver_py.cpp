@@ -30,13 +30,13 @@
 #include <boost/log/trivial.hpp>
 #include <boost/range/algorithm_ext/erase.hpp>
 
+#include "gardener_log.h"
+
 namespace INCLUDE_GARDENER {
 
 namespace po = boost::program_options;
 using boost::filesystem::path;
-using std::mutex;
 using std::string;
-using std::unique_lock;
 using std::vector;
 
 vector<string> Solver_Py::get_statement_regex() const {
@@ -53,7 +53,7 @@ string Solver_Py::get_file_regex() const {
 
 void Solver_Py::add_options(po::options_description *options
                             __attribute__((unused))) const {
-  BOOST_LOG_TRIVIAL(trace)
+  GARDENER_LOG(trace)
       << "add_options in Solver_Py has not been implemented";
 }
 
@@ -63,19 +63,20 @@ void Solver_Py::extract_options(const po::variables_map &vm) {
   }
 }
 
-void Solver_Py::add_edge(const string &src_path, const string &statement,
-                         unsigned int idx, unsigned int line_no) {
+bool Solver_Py::resolve_edge(const string &src_path, const string &statement,
+                             unsigned int idx, unsigned int line_no,
+                             vector<Resolved_Edge> *edges) {
   using boost::filesystem::operator/;
 
-  BOOST_LOG_TRIVIAL(trace) << "add_edge: " << src_path << " -> " << statement
-                           << ", idx = " << idx << ", line_no = " << line_no;
+  GARDENER_LOG(trace) << "resolve_edge: " << src_path << " -> " << statement
+                      << ", idx = " << idx << ", line_no = " << line_no;
 
   Statement_Py py_statement(src_path, statement, idx, line_no);
 
   if (py_statement.contained_multiple_imports()) {
     vector<Statement_Py> child_statements = py_statement.get_child_statements();
-    add_edges(child_statements);
-    return;
+    resolve_edges(child_statements, edges);
+    return true;
   }
 
   path parent_directory;
@@ -96,8 +97,6 @@ void Solver_Py::add_edge(const string &src_path, const string &statement,
   string likely_module_name = likely_path.stem().string();
   path likely_module_parent_path = likely_path.parent_path();
 
-  unique_lock<mutex> glck(graph_mutex);
-
   for (const string &file_extension : file_extensions) {
     string module_with_file_extension = likely_module_name;
     module_with_file_extension.append(".");
@@ -105,71 +104,64 @@ void Solver_Py::add_edge(const string &src_path, const string &statement,
 
     path dst_path = likely_module_parent_path / module_with_file_extension;
 
-    if (exists(dst_path)) {
+    if (probe(dst_path)) {
       dst_path = canonical(dst_path);
-      insert_edge(src_path, dst_path.string(), possible_path, line_no);
-      return;
+      edges->push_back(
+          Resolved_Edge{src_path, dst_path.string(), possible_path, line_no});
+      return true;
     }
 
     if (is_package((likely_module_parent_path / likely_module_name).string())) {
       possible_path += "/__init__.py";
-      insert_edge(src_path,
-                  canonical((likely_module_parent_path / likely_module_name /
-                             "__init__.py"))
-                      .string(),
-                  possible_path, line_no);
-      return;
+      edges->push_back(Resolved_Edge{
+          src_path,
+          canonical((likely_module_parent_path / likely_module_name /
+                     "__init__.py"))
+              .string(),
+          possible_path, line_no});
+      return true;
     }
   }
 
   // if none of the cases above found a file:
   // -> add a dummy entry
   string dummy_name = py_statement.extract_dummy_node_name(statement);
-  insert_edge(src_path, "", dummy_name, line_no);
+  edges->push_back(Resolved_Edge{src_path, "", dummy_name, line_no});
+  return true;
 }
 
 void Solver_Py::insert_edge(const string &src_path, const string &dst_path,
                             const string &name, unsigned int line_no) {
-  add_vertex(name, dst_path);
-  string key;
-
-  Edge_Descriptor edge;
-  bool b;
-
-  // Does the same edge already exist?
-  if (boost::edge_by_label(src_path, name, graph).second ||
-      boost::edge_by_label(src_path, dst_path, graph).second) {
-    BOOST_LOG_TRIVIAL(trace) << "Duplicate in insert_edge: "
-                             << "\n"
-                             << "   src = " << src_path << "\n"
-                             << "   dst = " << name << "\n"
-                             << "   name = " << name;
+  auto dst = add_vertex(name, dst_path);
+  auto src = find_or_add_vertex(src_path);
+
+  // Does the same edge already exist (either to the resolved file
+  // or to the dummy entry with the same name)?
+  auto by_name = vertexes.find(name);
+  if ((by_name != NO_VERTEX && by_name != dst && count_edge(src, by_name)) ||
+      !insert_unique_edge(src, dst, line_no)) {
+    GARDENER_LOG(trace) << "Duplicate in insert_edge: "
+                        << "\n"
+                        << "   src = " << src_path << "\n"
+                        << "   dst = " << name << "\n"
+                        << "   name = " << name;
     return;
   }
 
-  if (0 == dst_path.length()) {
-    BOOST_LOG_TRIVIAL(trace) << "insert_edge: "
-                             << "\n"
-                             << "   src = " << src_path << "\n"
-                             << "   dst = " << name << "\n"
-                             << "   name = " << name;
-    boost::tie(edge, b) = boost::add_edge_by_label(src_path, name, graph);
-  } else {
-    BOOST_LOG_TRIVIAL(trace) << "insert_edge: "
-                             << "\n"
-                             << "   src = " << src_path << "\n"
-                             << "   dst = " << dst_path << "\n"
-                             << "   name = " << name;
-    boost::tie(edge, b) = boost::add_edge_by_label(src_path, dst_path, graph);
-  }
-
-  graph[edge] = Edge{static_cast<int>(line_no)};
+  GARDENER_LOG(trace) << "insert_edge: "
+                      << "\n"
+                      << "   src = " << src_path << "\n"
+                      << "   dst = "
+                      << (dst_path.empty() ? name : dst_path) << "\n"
+                      << "   name = " << name;
 }
 
-void Solver_Py::add_edges(const vector<Statement_Py> &statements) {
+void Solver_Py::resolve_edges(const vector<Statement_Py> &statements,
+                              vector<Resolved_Edge> *edges) {
   for (auto &statement : statements) {
-    add_edge(statement.get_source_path(), statement.get_modified_statement(),
-             statement.get_regex_idx(), statement.get_line_number());
+    resolve_edge(statement.get_source_path(),
+                 statement.get_modified_statement(), statement.get_regex_idx(),
+                 statement.get_line_number(), edges);
   }
 }
 
@@ -187,7 +179,7 @@ bool Solver_Py::is_module(const std::string &path_string) {
     module_with_file_extension.append(file_extension);
     path dst_path = likely_module_parent_path / module_with_file_extension;
 
-    if (exists(dst_path)) {
+    if (probe(dst_path)) {
       return true;
     }
   }
@@ -201,7 +193,7 @@ bool Solver_Py::is_package(const std::string &path_string) {
 
   path as_path = path(path_string);
   path init_file = path("__init__.py");
-  return is_directory(as_path) && exists(as_path / init_file);
+  return is_directory(as_path) && probe(as_path / init_file);
 }
 
 }  // namespace INCLUDE_GARDENER
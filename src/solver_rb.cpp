@@ -25,12 +25,12 @@
 #include <boost/filesystem.hpp>
 #include <boost/log/trivial.hpp>
 
+#include "gardener_log.h"
+
 namespace INCLUDE_GARDENER {
 
 namespace po = boost::program_options;
-using std::mutex;
 using std::string;
-using std::unique_lock;
 using std::vector;
 
 vector<string> Solver_Rb::get_statement_regex() const {
@@ -51,20 +51,20 @@ void Solver_Rb::extract_options(const po::variables_map &vm) {
    if (vm.count("ruby-include-path") != 0U) {
       include_paths = vm["ruby-include-path"].as<vector<string> >();
    }
-   BOOST_LOG_TRIVIAL(trace) << "ruby-include-paths:   ";
+   GARDENER_LOG(trace) << "ruby-include-paths:   ";
    for (const auto &p : include_paths) {
-      BOOST_LOG_TRIVIAL(trace) << "    " << p;
+      GARDENER_LOG(trace) << "    " << p;
    }
 }
 
-void Solver_Rb::add_edge(const std::string &src_path,
-                         const std::string &statement, unsigned int idx,
-                         unsigned int line_no) {
+bool Solver_Rb::resolve_edge(const std::string &src_path,
+                             const std::string &statement, unsigned int idx,
+                             unsigned int line_no,
+                             std::vector<Resolved_Edge> *edges) {
    using boost::filesystem::path;
    using boost::filesystem::operator/;
-   unique_lock<mutex> glck(graph_mutex);
-   BOOST_LOG_TRIVIAL(trace) << "add_edge: " << src_path << " -> " << statement
-                            << ", idx = " << idx << ", line_no = " << line_no;
+   GARDENER_LOG(trace) << "resolve_edge: " << src_path << " -> " << statement
+                       << ", idx = " << idx << ", line_no = " << line_no;
 
    static const path RB_EXT = ".rb";
 
@@ -75,11 +75,12 @@ void Solver_Rb::add_edge(const std::string &src_path,
       path dst_path = base / statement;
       dst_path.replace_extension(RB_EXT);
 
-      if (exists(dst_path)) {
+      if (probe(dst_path)) {
          dst_path = canonical(dst_path);
-         BOOST_LOG_TRIVIAL(trace) << "   |>> Relative Edge";
-         insert_edge(src_path, dst_path.string(), statement, line_no);
-         return;
+         GARDENER_LOG(trace) << "   |>> Relative Edge";
+         edges->push_back(
+             Resolved_Edge{src_path, dst_path.string(), statement, line_no});
+         return true;
       }
    } else if (1 == idx) {
       // require
@@ -95,11 +96,12 @@ void Solver_Rb::add_edge(const std::string &src_path,
          path dst_path = base / statement;
          dst_path.replace_extension(RB_EXT);
 
-         if (exists(dst_path)) {
+         if (probe(dst_path)) {
             dst_path = canonical(dst_path);
-            BOOST_LOG_TRIVIAL(trace) << "   |>> Relative Edge";
-            insert_edge(src_path, dst_path.string(), statement, line_no);
-            return;
+            GARDENER_LOG(trace) << "   |>> Relative Edge";
+            edges->push_back(
+                Resolved_Edge{src_path, dst_path.string(), statement, line_no});
+            return true;
          }
       }
 
@@ -108,46 +110,20 @@ void Solver_Rb::add_edge(const std::string &src_path,
          path dst_path = i_path / statement;
          dst_path.replace_extension(RB_EXT);
 
-         if (exists(dst_path)) {
+         if (probe(dst_path)) {
             dst_path = canonical(dst_path);
-            BOOST_LOG_TRIVIAL(trace) << "   |>> Absolute Edge";
-            insert_edge(src_path, dst_path.string(), statement, line_no);
-            return;
+            GARDENER_LOG(trace) << "   |>> Absolute Edge";
+            edges->push_back(
+                Resolved_Edge{src_path, dst_path.string(), statement, line_no});
+            return true;
          }
       }
    }
 
    // if non of the cases above found a file:
    // -> add an dummy entry
-   insert_edge(src_path, "", statement, line_no);
-}
-
-void Solver_Rb::insert_edge(const std::string &src_path,
-                            const std::string &dst_path,
-                            const std::string &name, unsigned int line_no) {
-   add_vertex(name, dst_path);
-   string key;
-
-   Edge_Descriptor edge;
-   bool b;
-
-   if (0 == dst_path.length()) {
-      BOOST_LOG_TRIVIAL(trace) << "insert_edge: "
-                               << "\n"
-                               << "   src = " << src_path << "\n"
-                               << "   dst = " << name << "\n"
-                               << "   name = " << name;
-      boost::tie(edge, b) = boost::add_edge_by_label(src_path, name, graph);
-   } else {
-      BOOST_LOG_TRIVIAL(trace) << "insert_edge: "
-                               << "\n"
-                               << "   src = " << src_path << "\n"
-                               << "   dst = " << dst_path << "\n"
-                               << "   name = " << name;
-      boost::tie(edge, b) = boost::add_edge_by_label(src_path, dst_path, graph);
-   }
-
-   graph[edge] = Edge{static_cast<int>(line_no)};
+   edges->push_back(Resolved_Edge{src_path, "", statement, line_no});
+   return true;
 }
 
 }  // namespace INCLUDE_GARDENER
@@ -20,40 +20,156 @@
 //
 #include "statement_detector.h"
 
-#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <streambuf>
 
 #include <boost/log/trivial.hpp>
 
+#include "content_hash.h"
+#include "gardener_log.h"
 #include "helper.h"
+#include "run_stats.h"
+#include "trace.h"
 
 using boost::regex;
 using boost::smatch;
 
-using std::ifstream;
 using std::istream;
+using std::lock_guard;
+using std::make_shared;
 using std::mutex;
 using std::optional;
 using std::pair;
+using std::size_t;
 using std::string;
+using std::string_view;
 using std::thread;
 using std::unique_lock;
 using std::vector;
 
 namespace INCLUDE_GARDENER {
 
-Statement_Detector::Statement_Detector(const Solver::Ptr& solver, int n_workers)
+namespace {
+
+/// @brief Read-only stream buffer over a string_view (avoids a copy).
+class View_Buffer : public std::streambuf {
+ public:
+  explicit View_Buffer(string_view view) {
+    // the get area is never written
+    auto *begin = const_cast<char *>(view.data());
+    setg(begin, begin, begin + view.size());
+  }
+};
+
+/// @brief Counts a push to a queue with the given depth (after the push).
+void count_push(Queue_Stats* stats, size_t depth) {
+  ++stats->n_pushes;
+  stats->depth_sum += depth;
+  stats->max_depth = std::max(stats->max_depth, depth);
+}
+
+}  // namespace
+
+Statement_Detector::Statement_Detector(const Solver::Ptr& solver, int n_workers,
+                                       Scan_Cache::Ptr cache,
+                                       size_t queue_capacity,
+                                       size_t max_memory,
+                                       unsigned int uring_depth,
+                                       unsigned int n_resolvers)
     : statements(init_regex_vector(solver->get_statement_regex())),
-      workers(n_workers),
+      queue_capacity(queue_capacity),
+      memory_guard(max_memory),
+      n_throttled(0),
+      n_batch_left(0),
+      n_pending(0),
+      n_active_workers(std::numeric_limits<unsigned int>::max()),
       all_work_done(false),
-      solver(solver) {
+      uring_depth(uring_depth),
+      reading_done(false),
+      solver(solver),
+      cache(std::move(cache)),
+      n_reused(0) {
+  if (uring_depth > 0 && this->cache) {
+    BOOST_LOG_TRIVIAL(info) << "io_uring is not used together with the cache";
+  } else if (uring_depth > 0) {
+    try {
+      reader = std::make_unique<Uring_Reader>(uring_depth);
+      reader_thread = thread(&Statement_Detector::read_loop, this);
+    } catch (const std::runtime_error& e) {
+      BOOST_LOG_TRIVIAL(info) << e.what() << ", reading without io_uring";
+    }
+  }
+  job_queue_stats.capacity = queue_capacity;
+  read_queue_stats.capacity = uring_depth;
+  if (n_resolvers > 0) {
+    const auto capacity =
+        queue_capacity > 0 ? queue_capacity : PIPELINE_QUEUE_CAPACITY;
+    resolve_queue = std::make_unique<Bounded_Queue<Resolve_Job>>(capacity);
+    insert_queue = std::make_unique<
+        Bounded_Queue<vector<Solver::Resolved_Edge>>>(capacity);
+    for (unsigned int i = 0; i < n_resolvers; ++i) {
+      resolvers.emplace_back(&Statement_Detector::resolve_loop, this, i);
+    }
+    inserter = thread(&Statement_Detector::insert_loop, this);
+  }
+  if (n_workers == AUTO_WORKERS) {
+    const auto n_cpus = Worker_Controller::get_cpu_budget();
+    controller = std::make_unique<Worker_Controller>(n_cpus, 2 * n_cpus);
+    n_workers = static_cast<int>(2 * n_cpus);
+    n_active_workers = controller->get_n_active();
+    BOOST_LOG_TRIVIAL(info) << "CPU budget: " << n_cpus << ", starting "
+                            << n_workers << " adaptive workers";
+  }
+  file_sizes.resize(static_cast<size_t>(n_workers));
   for (int i = 0; i < n_workers; ++i) {
-    workers[i] = thread(&Statement_Detector::do_work, this, i);
+    workers.emplace_back(&Statement_Detector::do_work, this, i);
   }
 }
 
-void Statement_Detector::add_job(const string& abs_path) {
+/// @details
+///   While the memory limit is exceeded, the jobs are handed over in
+///   batches of one job per worker (so all workers stay busy). Before the
+///   next batch, add_job() waits until all jobs are processed; meanwhile,
+///   the memory is measured every MEMORY_RECHECK, and the hand-over
+///   resumes as soon as it dropped below the resume threshold.
+void Statement_Detector::add_job(string abs_path) {
+  bool throttled = memory_guard.is_exceeded();
   unique_lock<mutex> lck(job_queue_mutex);
-  job_queue.push_front(abs_path);
+  if (!throttled) {
+    n_batch_left = 0;
+  } else if (n_batch_left == 0) {
+    if (n_throttled == 0) {
+      BOOST_LOG_TRIVIAL(info)
+          << "Memory limit of " << memory_guard.get_max_bytes()
+          << " bytes exceeded, pausing the hand-over of files";
+    }
+    const Trace_Span span("memory limit");
+    while (throttled && n_pending > 0) {
+      job_queue_condition.wait_for(lck, MEMORY_RECHECK,
+                                   [this]() { return n_pending == 0; });
+      lck.unlock();
+      throttled = memory_guard.check();
+      lck.lock();
+    }
+    n_batch_left = throttled ? std::max<size_t>(workers.size(), 1) : 0;
+  }
+  if (throttled) {
+    --n_batch_left;
+    ++n_throttled;
+  }
+  auto has_space = [this]() {
+    return queue_capacity == 0 || job_queue.size() < queue_capacity;
+  };
+  if (!has_space()) {
+    const Trace_Span span("job_queue full");
+    ++job_queue_stats.n_full;
+    job_queue_condition.wait(lck, has_space);
+  }
+  job_queue.push_front(std::move(abs_path));
+  ++n_pending;
+  count_push(&job_queue_stats, job_queue.size());
   job_queue_condition.notify_all();
 }
 
@@ -61,12 +177,15 @@ vector<regex> Statement_Detector::get_statements() const { return statements; }
 
 optional<pair<string, unsigned int>> Statement_Detector::detect(
     const string& line) const {
+  auto& stats = Run_Stats::local();
   smatch match;
   for (size_t i = 0; i < statements.size(); i++) {
     auto s = statements[i];
+    stats.n_regex_calls.add(1);
     if (regex_search(line, match, s)) {
       if (!match.empty()) {
-        BOOST_LOG_TRIVIAL(trace)
+        stats.n_regex_matches.add(1);
+        GARDENER_LOG(trace)
             << "Statement matched: " << match[match.size() - 1];
         return pair<string, unsigned int>(match[match.size() - 1], i);
       }
@@ -75,8 +194,9 @@ optional<pair<string, unsigned int>> Statement_Detector::detect(
   return {};
 }
 
-void Statement_Detector::process_stream(istream& input,
-                                        const string& input_path) {
+unsigned int Statement_Detector::process_stream(
+    istream& input, const string& input_path,
+    vector<Detected_Statement>* found) {
   string multi_line;
   string line;
   bool found_multi_line = false;
@@ -88,8 +208,7 @@ void Statement_Detector::process_stream(istream& input,
       // if we previously got a multi-line statement: process it!
       if (found_multi_line) {
         if (detect(multi_line)) {
-          solver->add_edge(input_path, statement->first, statement->second,
-                           line_cnt);
+          add_statement(input_path, *statement, line_cnt, found);
         }
         found_multi_line = false;
         multi_line = "";
@@ -105,16 +224,14 @@ void Statement_Detector::process_stream(istream& input,
         multi_line.append(line);
         statement = detect(multi_line);
         if (statement) {
-          solver->add_edge(input_path, statement->first, statement->second,
-                           line_cnt);
+          add_statement(input_path, *statement, line_cnt, found);
         }
         found_multi_line = false;
         multi_line = "";
       } else {
         statement = detect(line);
         if (statement) {
-          solver->add_edge(input_path, statement->first, statement->second,
-                           line_cnt);
+          add_statement(input_path, *statement, line_cnt, found);
         }
       }
     }
@@ -134,36 +251,386 @@ void Statement_Detector::process_stream(istream& input,
                                << "\n";
     statement = detect(multi_line);
     if (statement) {
-      solver->add_edge(input_path, statement->first, statement->second,
-                       line_cnt);
+      add_statement(input_path, *statement, line_cnt, found);
     }
   }
+  Run_Stats::local().n_lines.add(line_cnt - 1);
+  return line_cnt - 1;
 }
 
 void Statement_Detector::do_work(int id) {
-  BOOST_LOG_TRIVIAL(debug) << "Started worker [" << id << "]";
+  GARDENER_LOG(debug) << "Started worker [" << id << "]";
+  Run_Stats::set_thread_name("worker " + std::to_string(id));
+  auto& stats = Run_Stats::local();
 
   while (true) {
-    unique_lock<mutex> lck(job_queue_mutex);
-    job_queue_condition.wait(
-        lck, [this]() { return (!job_queue.empty()) || all_work_done; });
+    unique_lock<mutex> lck(job_queue_mutex, std::defer_lock);
+    {
+      const Scoped_Timer wait_timer(&stats.job_queue_wait_ns);
+      const Trace_Span span("job_queue wait");
+      lck.lock();
+      auto has_work = [this, id]() {
+        const bool has_entry =
+            reader ? !read_queue.empty() : !job_queue.empty();
+        return (has_entry &&
+                static_cast<unsigned int>(id) < n_active_workers) ||
+               all_work_done;
+      };
+      if (!has_work()) {
+        ++(reader ? read_queue_stats : job_queue_stats).n_empty;
+        job_queue_condition.wait(lck, has_work);
+      }
+    }
     if (all_work_done) {
-      BOOST_LOG_TRIVIAL(debug) << "[" << id << "] All work is done";
+      GARDENER_LOG(debug) << "[" << id << "] All work is done";
       return;
     }
 
-    auto entry = job_queue.back();
-    job_queue.pop_back();
+    string entry;
+    optional<string> content;
+    if (reader) {
+      entry = std::move(read_queue.back().path);
+      content = std::move(read_queue.back().content);
+      read_queue.pop_back();
+    } else {
+      entry = std::move(job_queue.back());
+      job_queue.pop_back();
+    }
     lck.unlock();
     job_queue_condition.notify_all();
 
-    BOOST_LOG_TRIVIAL(debug) << "[" << id << "]"
-                             << " processing" << entry;
-    ifstream ifs(entry, ifstream::in);
-    process_stream(ifs, entry);
+    GARDENER_LOG(debug) << "[" << id << "]"
+                        << " processing" << entry;
+    const Scoped_Timer busy_timer(&stats.busy_ns);
+    const auto job_start = Trace::is_enabled() ? Run_Stats::Clock::now()
+                                               : Run_Stats::Clock::time_point();
+    const auto bytes_before = stats.n_bytes.get();
+    const auto wall_start = controller ? Worker_Controller::Clock::now()
+                                       : Worker_Controller::Clock::time_point();
+    const auto cpu_start =
+        controller ? Worker_Controller::get_thread_cpu_ns() : 0;
+    stats.n_files.add(1);
+    if (content) {
+      stats.n_bytes.add(content->size());
+      process_content(id, entry, *content,
+                      content_hash(content->data(), content->size()));
+    } else if (cache) {
+      process_cached(id, entry);
+    } else {
+      // also if the io_uring reader couldn't read the file
+      process_file(id, entry);
+    }
+    if (controller) {
+      adapt_workers(wall_start, cpu_start);
+    }
+    if (Trace::is_enabled()) {
+      Trace::record("job", job_start, Run_Stats::Clock::now(), entry,
+                    stats.n_bytes.get() - bytes_before);
+    }
+    finish_job();
+  }
+}
+
+void Statement_Detector::finish_job() {
+  {
+    lock_guard<mutex> lck(job_queue_mutex);
+    --n_pending;
+  }
+  job_queue_condition.notify_all();
+}
+
+/// @details
+///   New files are only taken while fewer than uring_depth read files wait
+///   for a worker. After an error, the remaining jobs are dropped (but
+///   still taken, so add_job never blocks forever); wait_for_workers()
+///   reports the error.
+void Statement_Detector::read_loop() {
+  Run_Stats::set_thread_name("io_uring reader");
+  vector<Uring_Reader::Result> done;
+  bool failed = false;
+  for (;;) {
+    {
+      unique_lock<mutex> lck(job_queue_mutex);
+      if (failed || reader->get_n_in_flight() == 0) {
+        const Trace_Span span("job_queue wait");
+        if (!failed && read_queue.size() >= uring_depth) {
+          ++read_queue_stats.n_full;
+        }
+        job_queue_condition.wait(lck, [this, failed]() {
+          return (!job_queue.empty() &&
+                  (failed || read_queue.size() < uring_depth)) ||
+                 reading_done;
+        });
+        if (job_queue.empty() && reading_done) {
+          return;
+        }
+      }
+      while (!job_queue.empty() &&
+             (failed ||
+              (reader->has_space() && read_queue.size() < uring_depth))) {
+        if (!failed) {
+          reader->add(std::move(job_queue.back()));
+        } else {
+          --n_pending;
+        }
+        job_queue.pop_back();
+      }
+    }
+    job_queue_condition.notify_all();
+    if (failed) {
+      continue;
+    }
+
+    try {
+      const Trace_Span span("io_uring wait");
+      reader->run(&done);
+    } catch (const std::exception& e) {
+      lock_guard<mutex> lck(job_queue_mutex);
+      read_error = e.what();
+      failed = true;
+    }
+    if (!done.empty()) {
+      {
+        lock_guard<mutex> lck(job_queue_mutex);
+        for (auto& result : done) {
+          read_queue.push_front(std::move(result));
+          count_push(&read_queue_stats, read_queue.size());
+        }
+      }
+      done.clear();
+      job_queue_condition.notify_all();
+    }
   }
 }
 
+/// @details
+///   The edges of a file are passed on as one batch. A solver without
+///   resolve_edge() support adds the edges itself (via add_edge).
+void Statement_Detector::resolve_loop(int id) {
+  Run_Stats::set_thread_name("resolver " + std::to_string(id));
+  auto& stats = Run_Stats::local();
+  Resolve_Job job;
+  for (;;) {
+    {
+      const Scoped_Timer wait_timer(&stats.job_queue_wait_ns);
+      const Trace_Span span("resolve_queue wait");
+      if (!resolve_queue->pop(&job)) {
+        return;
+      }
+    }
+    const Scoped_Timer busy_timer(&stats.busy_ns);
+    vector<Solver::Resolved_Edge> edges;
+    for (const auto& s : *job.statements) {
+      const Trace_Span span("resolve", s.statement);
+      if (!solver->resolve_edge(job.path, s.statement, s.idx, s.line_no,
+                                &edges)) {
+        solver->add_edge(job.path, s.statement, s.idx, s.line_no);
+      }
+    }
+    if (!edges.empty()) {
+      insert_queue->push(std::move(edges));
+    }
+  }
+}
+
+void Statement_Detector::insert_loop() {
+  Run_Stats::set_thread_name("inserter");
+  auto& stats = Run_Stats::local();
+  vector<Solver::Resolved_Edge> edges;
+  for (;;) {
+    {
+      const Scoped_Timer wait_timer(&stats.job_queue_wait_ns);
+      const Trace_Span span("insert_queue wait");
+      if (!insert_queue->pop(&edges)) {
+        return;
+      }
+    }
+    const Scoped_Timer busy_timer(&stats.busy_ns);
+    const Trace_Span span("insert", edges.front().src_path);
+    solver->insert_edges(edges);
+  }
+}
+
+vector<pair<string, Queue_Stats>> Statement_Detector::get_queue_stats() const {
+  vector<pair<string, Queue_Stats>> result;
+  {
+    lock_guard<mutex> lck(job_queue_mutex);
+    result.emplace_back("jobs", job_queue_stats);
+    if (reader) {
+      result.emplace_back("read", read_queue_stats);
+    }
+  }
+  if (resolve_queue) {
+    result.emplace_back("resolve", resolve_queue->get_stats());
+    result.emplace_back("insert", insert_queue->get_stats());
+  }
+  return result;
+}
+
+void Statement_Detector::process_file(int id, const string& input_path) {
+  string content;
+  if (!read_file(input_path, &content)) {
+    GARDENER_LOG(debug) << "Failed to read " << input_path;
+    return;
+  }
+  Run_Stats::local().n_bytes.add(content.size());
+  process_content(id, input_path, content,
+                  content_hash(content.data(), content.size()));
+}
+
+/// @details
+///   On a cache hit, the statements are passed to the solver without
+///   opening the file. Otherwise the file is read once (unless the cache
+///   already read it), scanned, and the statements are stored in the cache.
+void Statement_Detector::process_cached(int id, const string& input_path) {
+  optional<string> read_content;
+  File_Size size;
+  auto cached = cache->lookup(input_path, &read_content, &size);
+  if (cached) {
+    GARDENER_LOG(trace) << "Cache hit: " << input_path;
+    file_sizes[static_cast<size_t>(id)].emplace_back(input_path, size);
+    add_edges(input_path, make_shared<const vector<Detected_Statement>>(
+                              std::move(*cached)));
+    return;
+  }
+  string data;
+  string_view content;
+  if (read_content) {
+    content = *read_content;
+  } else if (read_file(input_path, &data)) {
+    content = data;
+  } else {
+    GARDENER_LOG(debug) << "Failed to read " << input_path;
+    return;
+  }
+  Run_Stats::local().n_bytes.add(content.size());
+  const auto hash = content_hash(content.data(), content.size());
+  unsigned int lines = 0;
+  const auto statements =
+      process_content(id, input_path, content, hash, &lines);
+  cache->store(input_path, content.size(), hash, *statements, lines);
+}
+
+/// @details
+///   Only the hash and size of a content are kept after the first scan,
+///   so the memory doesn't grow with the statements of all files. When
+///   the content is seen the second time, it is scanned again and its
+///   statements are kept for all further files with this content.
+///   Two threads may scan the same content at the same time; then both
+///   results are equal and the first one is kept. The size is compared as
+///   well, so a hash collision of different-sized files is harmless.
+Statement_Detector::Statements Statement_Detector::process_content(
+    int id, const string& input_path, string_view content, std::uint64_t hash,
+    unsigned int* lines) {
+  Statements statements;
+  unsigned int n_lines = 0;
+  bool is_duplicate = false;
+  {
+    lock_guard<mutex> lck(scanned_mutex);
+    auto dup = duplicates.find(hash);
+    if (dup != duplicates.end() && dup->second.size == content.size()) {
+      statements = dup->second.statements;
+      n_lines = dup->second.lines;
+      ++n_reused;
+    } else {
+      auto it = scanned.emplace(hash, content.size());
+      is_duplicate = !it.second && dup == duplicates.end() &&
+                     it.first->second == content.size();
+    }
+  }
+  const bool reused = static_cast<bool>(statements);
+  if (reused) {
+    GARDENER_LOG(trace) << "Content already scanned: " << input_path;
+  } else {
+    vector<Detected_Statement> found;
+    View_Buffer buffer(content);
+    istream input(&buffer);
+    n_lines = process_stream(input, input_path, &found);
+    statements =
+        make_shared<const vector<Detected_Statement>>(std::move(found));
+  }
+  if (is_duplicate) {
+    lock_guard<mutex> lck(scanned_mutex);
+    duplicates.emplace(hash, Duplicate{content.size(), n_lines, statements});
+    scanned.erase(hash);
+  }
+  file_sizes[static_cast<size_t>(id)].emplace_back(
+      input_path, File_Size{content.size(), n_lines});
+  if (lines != nullptr) {
+    *lines = n_lines;
+  }
+  // without resolver threads, process_stream passed the statements of a
+  // scanned content already
+  if (reused || resolve_queue) {
+    add_edges(input_path, statements);
+  }
+  return statements;
+}
+
+void Statement_Detector::add_edges(const string& input_path,
+                                   const Statements& statements) {
+  if (resolve_queue) {
+    if (!statements->empty()) {
+      resolve_queue->push(Resolve_Job{input_path, statements});
+    }
+    return;
+  }
+  for (const auto& s : *statements) {
+    add_edge(input_path, s.statement, s.idx, s.line_no);
+  }
+}
+
+void Statement_Detector::add_edge(const string& input_path,
+                                  const string& statement, unsigned int idx,
+                                  unsigned int line_no) {
+  const Trace_Span span("resolve", statement);
+  solver->add_edge(input_path, statement, idx, line_no);
+}
+
+size_t Statement_Detector::get_n_reused() const {
+  lock_guard<mutex> lck(scanned_mutex);
+  return n_reused;
+}
+
+void Statement_Detector::add_statement(
+    const string& input_path, const pair<string, unsigned int>& statement,
+    unsigned int line_no, vector<Detected_Statement>* found) {
+  if (!resolve_queue || found == nullptr) {
+    add_edge(input_path, statement.first, statement.second, line_no);
+  }
+  if (found != nullptr) {
+    found->push_back(
+        Detected_Statement{statement.first, statement.second, line_no});
+  }
+}
+
+/// @details
+///   Only workers with an id below n_active_workers take jobs; the others
+///   wait on job_queue_condition until they are activated again.
+void Statement_Detector::adapt_workers(
+    Worker_Controller::Clock::time_point wall_start, std::uint64_t cpu_start) {
+  const auto now = Worker_Controller::Clock::now();
+  const auto wall_ns = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - wall_start)
+          .count());
+  const auto cpu_ns = Worker_Controller::get_thread_cpu_ns() - cpu_start;
+  if (!controller->add_job(now, wall_ns, cpu_ns)) {
+    return;
+  }
+  const auto n_active = controller->get_n_active();
+  GARDENER_LOG(debug) << "Active workers: " << n_active;
+  {
+    lock_guard<mutex> lck(job_queue_mutex);
+    n_active_workers = n_active;
+  }
+  job_queue_condition.notify_all();
+}
+
+size_t Statement_Detector::get_n_throttled() const {
+  lock_guard<mutex> lck(job_queue_mutex);
+  return n_throttled;
+}
+
 /// @details
 ///   It first waits until the job-queue is empty. If this is the case,
 ///   the done flag is set and join() is called on all threads to wait
@@ -177,6 +644,18 @@ void Statement_Detector::wait_for_workers() {
     job_queue_condition.notify_all();
   }
 
+  // with io_uring: wait until all files are read and scanned
+  if (reader) {
+    {
+      lock_guard<mutex> lck(job_queue_mutex);
+      reading_done = true;
+    }
+    job_queue_condition.notify_all();
+    reader_thread.join();
+    unique_lock<mutex> lck(job_queue_mutex);
+    job_queue_condition.wait(lck, [this]() { return read_queue.empty(); });
+  }
+
   // set the done flag
   {
     unique_lock<mutex> lck(job_queue_mutex);
@@ -188,7 +667,34 @@ void Statement_Detector::wait_for_workers() {
   for (auto& worker : workers) {
     worker.join();
   }
-  BOOST_LOG_TRIVIAL(debug) << "All threads are done";
+
+  // the workers don't add statements anymore: drain the pipeline
+  if (resolve_queue) {
+    resolve_queue->close();
+    for (auto& resolver : resolvers) {
+      resolver.join();
+    }
+    insert_queue->close();
+    inserter.join();
+  }
+  GARDENER_LOG(debug) << "All threads are done";
+
+  for (auto& sizes : file_sizes) {
+    solver->set_file_sizes(sizes);
+    sizes.clear();
+  }
+
+  for (const auto& q : get_queue_stats()) {
+    GARDENER_LOG(debug) << "Queue " << q.first << ": " << q.second.n_pushes
+                        << " pushes, max. depth " << q.second.max_depth;
+    if (Run_Stats::is_enabled()) {
+      Run_Stats::add_queue(q.first, q.second);
+    }
+  }
+  if (!read_error.empty()) {
+    throw std::runtime_error("Failed to read files via io_uring: " +
+                             read_error);
+  }
 }
 
 }  // namespace INCLUDE_GARDENER
@@ -0,0 +1,114 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "trace.h"
+
+#include "ndjson_stream.h"
+
+using std::ostream;
+using std::string;
+using std::uint64_t;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Appends a duration in microseconds (the unit of the format).
+void append_us(uint64_t ns, string *out) {
+  *out += std::to_string(ns / 1000);
+  *out += '.';
+  const auto fraction = std::to_string(ns % 1000);
+  out->append(3 - fraction.size(), '0');
+  *out += fraction;
+}
+
+}  // namespace
+
+std::atomic<bool> Trace::enabled{false};
+
+Run_Stats::Clock::time_point Trace::start;
+
+void Trace::enable() {
+  start = Run_Stats::Clock::now();
+  enabled = true;
+}
+
+void Trace::disable() { enabled = false; }
+
+void Trace::record(const char *name, Run_Stats::Clock::time_point begin,
+                   Run_Stats::Clock::time_point end, string detail,
+                   uint64_t size) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  if (!is_enabled()) {
+    return;
+  }
+  const auto offset = begin < start ? nanoseconds(0)
+                                    : duration_cast<nanoseconds>(begin - start);
+  const auto duration = duration_cast<nanoseconds>(end - begin);
+  Run_Stats::local().events.push_back(
+      Trace_Event{name, std::move(detail), size,
+                  static_cast<uint64_t>(offset.count()),
+                  static_cast<uint64_t>(duration.count())});
+}
+
+/// @details
+///   All spans are complete events ("ph":"X") of process 1; the thread
+///   names are added as metadata events.
+void Trace::write(ostream &os) {
+  string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  Run_Stats::for_each_thread([&out, &os, &first](const Thread_Stats &t) {
+    const string tid = std::to_string(t.id);
+    out += first ? "\n" : ",\n";
+    first = false;
+    out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid +
+           ",\"args\":{\"name\":";
+    Ndjson_Stream::append_string(t.name, &out);
+    out += "}}";
+    for (const auto &e : t.events) {
+      out += ",\n{\"name\":\"";
+      out += e.name;
+      out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+      append_us(e.start_ns, &out);
+      out += ",\"dur\":";
+      append_us(e.duration_ns, &out);
+      if (!e.detail.empty()) {
+        out += ",\"args\":{\"detail\":";
+        Ndjson_Stream::append_string(e.detail, &out);
+        if (e.size > 0) {
+          out += ",\"size\":" + std::to_string(e.size);
+        }
+        out += '}';
+      }
+      out += '}';
+      if (out.size() > (1U << 16U)) {
+        os << out;
+        out.clear();
+      }
+    }
+  });
+  out += "\n]}\n";
+  os << out;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
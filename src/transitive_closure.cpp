@@ -0,0 +1,206 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "transitive_closure.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using std::size_t;
+using std::to_string;
+using std::uint64_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+using Id = Strong_Components::Id;
+
+constexpr Id NO_COMPONENT = std::numeric_limits<Id>::max();
+
+/// @brief Levels with less work (words to OR) are computed by one thread.
+constexpr size_t MIN_PARALLEL_WORDS = 1U << 16U;
+
+}  // namespace
+
+Transitive_Closure::Transitive_Closure(const Csr_Graph &graph,
+                                       unsigned int n_threads,
+                                       size_t max_bytes)
+    : graph(graph), components(graph) {
+  const Id n_components = components.size();
+  // whole blocks of 4 words, so the OR loop needs no remainder handling
+  words_per_row = ((graph.get_n_vertices() + 255U) / 256U) * 4U;
+  const size_t n_words = static_cast<size_t>(n_components) * words_per_row;
+  if (max_bytes == 0) {
+    max_bytes = get_physical_memory();
+  }
+  if (max_bytes > 0 && n_words > max_bytes / sizeof(uint64_t)) {
+    throw std::runtime_error(
+        "The transitive closure of " + to_string(graph.get_n_vertices()) +
+        " files (" + to_string(n_components) + " components) needs " +
+        to_string(n_words * sizeof(uint64_t)) + " bytes, more than the " +
+        to_string(max_bytes) + " bytes of memory");
+  }
+  bits.assign(n_words, 0);
+
+  // level of each component, successors always have lower ids
+  vector<Id> level(n_components, 0);
+  Id n_levels = n_components > 0 ? 1 : 0;
+  for (Id c = 0; c < n_components; ++c) {
+    for (auto i = components.get_first_member(c);
+         i < components.get_end_member(c); ++i) {
+      const Vertex_Id v = components.get_member(i);
+      for (auto e = graph.get_first_edge(v); e < graph.get_end_edge(v); ++e) {
+        const Id d = components.get_component(graph.get_target(e));
+        if (d != c) {
+          level[c] = std::max(level[c], level[d] + 1);
+        }
+      }
+    }
+    n_levels = std::max(n_levels, level[c] + 1);
+  }
+
+  // components, grouped by level (counting sort)
+  vector<size_t> level_start(n_levels + 1, 0);
+  for (auto l : level) {
+    ++level_start[l + 1];
+  }
+  for (Id l = 0; l < n_levels; ++l) {
+    level_start[l + 1] += level_start[l];
+  }
+  vector<Id> by_level(n_components);
+  {
+    vector<size_t> next(level_start.begin(), level_start.end() - 1);
+    for (Id c = 0; c < n_components; ++c) {
+      by_level[next[level[c]]++] = c;
+    }
+  }
+
+  n_threads = std::max(n_threads, 1U);
+  vector<vector<Id>> stamps(n_threads, vector<Id>(n_components, NO_COMPONENT));
+  for (Id l = 0; l < n_levels; ++l) {
+    const size_t begin = level_start[l];
+    const size_t end = level_start[l + 1];
+    if (n_threads == 1 || (end - begin) * words_per_row < MIN_PARALLEL_WORDS) {
+      for (size_t i = begin; i < end; ++i) {
+        compute_row(by_level[i], &stamps[0]);
+      }
+      continue;
+    }
+    std::atomic<size_t> next(begin);
+    auto work = [&](unsigned int t) {
+      for (size_t i = next++; i < end; i = next++) {
+        compute_row(by_level[i], &stamps[t]);
+      }
+    };
+    vector<std::thread> threads;
+    for (unsigned int t = 1; t < n_threads; ++t) {
+      threads.emplace_back(work, t);
+    }
+    work(0);
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+}
+
+/// @details
+///   The row of c is the union of the rows of all successor components
+///   plus the successors themselves. Each successor component is merged
+///   only once per row (see stamp).
+void Transitive_Closure::compute_row(Id c, vector<Id> *stamp) {
+  uint64_t *row = &bits[c * words_per_row];
+  bool cyclic = components.get_n_members(c) > 1;
+  for (auto i = components.get_first_member(c);
+       i < components.get_end_member(c); ++i) {
+    const Vertex_Id v = components.get_member(i);
+    for (auto e = graph.get_first_edge(v); e < graph.get_end_edge(v); ++e) {
+      const Vertex_Id w = graph.get_target(e);
+      const Id d = components.get_component(w);
+      if (d == c) {
+        cyclic = true;
+        continue;
+      }
+      row[w / 64U] |= uint64_t{1} << (w % 64U);
+      if ((*stamp)[d] == c) {
+        continue;
+      }
+      (*stamp)[d] = c;
+      const uint64_t *src = get_row(d);
+      for (size_t k = 0; k < words_per_row; ++k) {
+        row[k] |= src[k];
+      }
+    }
+  }
+  if (cyclic) {
+    for (auto i = components.get_first_member(c);
+         i < components.get_end_member(c); ++i) {
+      const Vertex_Id v = components.get_member(i);
+      row[v / 64U] |= uint64_t{1} << (v % 64U);
+    }
+  }
+}
+
+size_t Transitive_Closure::get_physical_memory() {
+  const long n_pages = sysconf(_SC_PHYS_PAGES);
+  const long page_size = sysconf(_SC_PAGESIZE);
+  if (n_pages <= 0 || page_size <= 0) {
+    return 0;
+  }
+  return static_cast<size_t>(n_pages) * static_cast<size_t>(page_size);
+}
+
+bool Transitive_Closure::reaches(Vertex_Id src, Vertex_Id dst) const {
+  const uint64_t *row = get_row(components.get_component(src));
+  return ((row[dst / 64U] >> (dst % 64U)) & 1U) != 0U;
+}
+
+vector<Vertex_Id> Transitive_Closure::get_reachable(Vertex_Id v) const {
+  vector<Vertex_Id> result;
+  const uint64_t *row = get_row(components.get_component(v));
+  for (size_t k = 0; k < words_per_row; ++k) {
+    for (uint64_t word = row[k]; word != 0; word &= word - 1) {
+      std::bitset<64> lower((word & -word) - 1);
+      result.push_back(static_cast<Vertex_Id>(k * 64U + lower.count()));
+    }
+  }
+  return result;
+}
+
+size_t Transitive_Closure::count_reachable(Vertex_Id v) const {
+  const uint64_t *row = get_row(components.get_component(v));
+  size_t n = 0;
+  for (size_t k = 0; k < words_per_row; ++k) {
+    n += std::bitset<64>(row[k]).count();
+  }
+  return n;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
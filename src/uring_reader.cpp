@@ -0,0 +1,332 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "uring_reader.h"
+
+#ifdef GARDENER_WITH_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+using std::uint8_t;
+using std::vector;
+
+namespace INCLUDE_GARDENER {
+
+#ifdef GARDENER_WITH_IO_URING
+
+namespace {
+
+/// @brief Marks the user data of a close operation (the rest is the fd).
+constexpr uint64_t CLOSE_TAG = uint64_t{1} << 63U;
+
+int io_uring_setup(unsigned int entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                   unsigned int flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+/// @brief Returns a pointer at offset bytes into a mapping.
+template <typename T>
+T *at(void *base, uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+void *map_ring(int fd, size_t size, off_t offset) {
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, offset);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+}  // namespace
+
+Uring_Reader::Uring_Reader(unsigned int depth)
+    : depth(depth == 0 ? 1 : depth),
+      ring_fd(-1),
+      sq_ring(nullptr),
+      sq_ring_size(0),
+      cq_ring(nullptr),
+      cq_ring_size(0),
+      sqes(nullptr),
+      sqes_size(0),
+      sq_head(nullptr),
+      sq_tail(nullptr),
+      sq_mask(nullptr),
+      sq_array(nullptr),
+      cq_head(nullptr),
+      cq_tail(nullptr),
+      cq_mask(nullptr),
+      cqes(nullptr),
+      n_to_submit(0),
+      n_in_flight(0),
+      slots(this->depth) {
+  io_uring_params params{};
+  ring_fd = io_uring_setup(this->depth, &params);
+  if (ring_fd < 0) {
+    throw runtime_error(string("io_uring_setup failed: ") +
+                        std::strerror(errno));
+  }
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+  }
+  sq_ring = map_ring(ring_fd, sq_ring_size, IORING_OFF_SQ_RING);
+  cq_ring = single_mmap ? sq_ring
+                        : map_ring(ring_fd, cq_ring_size, IORING_OFF_CQ_RING);
+  sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  sqes = map_ring(ring_fd, sqes_size, IORING_OFF_SQES);
+  if (sq_ring == nullptr || cq_ring == nullptr || sqes == nullptr) {
+    const string error = std::strerror(errno);
+    release();
+    throw runtime_error("Failed to map the io_uring: " + error);
+  }
+
+  sq_head = at<uint32_t>(sq_ring, params.sq_off.head);
+  sq_tail = at<uint32_t>(sq_ring, params.sq_off.tail);
+  sq_mask = at<uint32_t>(sq_ring, params.sq_off.ring_mask);
+  sq_array = at<uint32_t>(sq_ring, params.sq_off.array);
+  cq_head = at<uint32_t>(cq_ring, params.cq_off.head);
+  cq_tail = at<uint32_t>(cq_ring, params.cq_off.tail);
+  cq_mask = at<uint32_t>(cq_ring, params.cq_off.ring_mask);
+  cqes = at<void>(cq_ring, params.cq_off.cqes);
+
+  free_slots.reserve(this->depth);
+  for (size_t i = this->depth; i > 0; --i) {
+    free_slots.push_back(i - 1);
+  }
+}
+
+/// @details
+///   The kernel may still write into the buffers of the operations in
+///   flight, so they are completed first.
+Uring_Reader::~Uring_Reader() {
+  vector<Result> ignored;
+  try {
+    while (n_in_flight > 0) {
+      run(&ignored);
+      ignored.clear();
+    }
+  } catch (...) {
+    // the ring is released anyway
+  }
+  release();
+}
+
+void Uring_Reader::release() {
+  for (auto &slot : slots) {
+    if (slot.fd >= 0) {
+      close(slot.fd);
+      slot.fd = -1;
+    }
+  }
+  if (sqes != nullptr) {
+    munmap(sqes, sqes_size);
+  }
+  if (cq_ring != nullptr && cq_ring != sq_ring) {
+    munmap(cq_ring, cq_ring_size);
+  }
+  if (sq_ring != nullptr) {
+    munmap(sq_ring, sq_ring_size);
+  }
+  if (ring_fd >= 0) {
+    close(ring_fd);
+  }
+  sqes = cq_ring = sq_ring = nullptr;
+  ring_fd = -1;
+}
+
+void Uring_Reader::add(string path) {
+  const auto index = free_slots.back();
+  free_slots.pop_back();
+  auto &slot = slots[index];
+  slot.state = State::OPENING;
+  slot.path = std::move(path);
+  slot.size = 0;
+  slot.fd = -1;
+  push(IORING_OP_OPENAT, AT_FDCWD,
+       reinterpret_cast<uint64_t>(slot.path.c_str()), 0, 0,
+       O_RDONLY | O_CLOEXEC, index);
+}
+
+void Uring_Reader::push(uint8_t opcode, int fd, uint64_t addr, uint32_t len,
+                        uint64_t offset, uint32_t flags, uint64_t user_data) {
+  const uint32_t tail = *sq_tail;
+  const uint32_t index = tail & *sq_mask;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes) + index;
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->open_flags = flags;
+  sqe->user_data = user_data;
+  sq_array[index] = index;
+  __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+  n_to_submit++;
+  n_in_flight++;
+}
+
+void Uring_Reader::push_read(size_t index) {
+  auto &slot = slots[index];
+  if (slot.size == slot.buffer.size()) {
+    slot.buffer.resize(slot.buffer.empty() ? INITIAL_BUFFER_SIZE
+                                           : 2 * slot.buffer.size());
+  }
+  push(IORING_OP_READ, slot.fd,
+       reinterpret_cast<uint64_t>(&slot.buffer[slot.size]),
+       static_cast<uint32_t>(slot.buffer.size() - slot.size), slot.size, 0,
+       index);
+}
+
+void Uring_Reader::push_close(int fd) {
+  push(IORING_OP_CLOSE, fd, 0, 0, 0, 0,
+       CLOSE_TAG | static_cast<uint32_t>(fd));
+}
+
+void Uring_Reader::run(vector<Result> *done) {
+  if (n_in_flight == 0) {
+    return;
+  }
+  int entered;
+  do {
+    entered = io_uring_enter(ring_fd, n_to_submit, 1, IORING_ENTER_GETEVENTS);
+  } while (entered < 0 &&
+           (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+  if (entered < 0) {
+    throw runtime_error(string("io_uring_enter failed: ") +
+                        std::strerror(errno));
+  }
+  n_to_submit -= std::min(n_to_submit, static_cast<unsigned int>(entered));
+
+  uint32_t head = *cq_head;
+  const uint32_t tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+  while (head != tail) {
+    const auto &cqe = static_cast<io_uring_cqe *>(cqes)[head & *cq_mask];
+    const uint64_t user_data = cqe.user_data;
+    const int result = cqe.res;
+    head++;
+    n_in_flight--;
+    complete(user_data, result, done);
+  }
+  __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+
+/// @details
+///   A short read ends the file (regular files are read completely
+///   otherwise), a full buffer is doubled and the read continues.
+void Uring_Reader::complete(uint64_t user_data, int result,
+                            vector<Result> *done) {
+  if ((user_data & CLOSE_TAG) != 0) {
+    return;
+  }
+  const auto index = static_cast<size_t>(user_data);
+  auto &slot = slots[index];
+  if (result < 0) {
+    finish(index, false, done);
+    return;
+  }
+  if (slot.state == State::OPENING) {
+    slot.fd = result;
+    slot.state = State::READING;
+    push_read(index);
+    return;
+  }
+  const auto requested = slot.buffer.size() - slot.size;
+  slot.size += static_cast<size_t>(result);
+  if (static_cast<size_t>(result) == requested && result > 0) {
+    push_read(index);
+  } else {
+    finish(index, true, done);
+  }
+}
+
+void Uring_Reader::finish(size_t index, bool ok, vector<Result> *done) {
+  auto &slot = slots[index];
+  if (slot.fd >= 0) {
+    push_close(slot.fd);
+    slot.fd = -1;
+  }
+  Result result{std::move(slot.path), {}};
+  if (ok) {
+    slot.buffer.resize(slot.size);
+    result.content = std::move(slot.buffer);
+  }
+  done->push_back(std::move(result));
+  slot = Slot();
+  free_slots.push_back(index);
+}
+
+#else
+
+Uring_Reader::Uring_Reader(unsigned int depth)
+    : depth(depth),
+      ring_fd(-1),
+      sq_ring(nullptr),
+      sq_ring_size(0),
+      cq_ring(nullptr),
+      cq_ring_size(0),
+      sqes(nullptr),
+      sqes_size(0),
+      sq_head(nullptr),
+      sq_tail(nullptr),
+      sq_mask(nullptr),
+      sq_array(nullptr),
+      cq_head(nullptr),
+      cq_tail(nullptr),
+      cq_mask(nullptr),
+      cqes(nullptr),
+      n_to_submit(0),
+      n_in_flight(0) {
+  throw runtime_error("io_uring support is not compiled in");
+}
+
+Uring_Reader::~Uring_Reader() = default;
+
+void Uring_Reader::add(string /*path*/) {}
+
+void Uring_Reader::run(vector<Result> * /*done*/) {}
+
+#endif
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
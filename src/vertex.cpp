@@ -22,14 +22,65 @@
 
 namespace INCLUDE_GARDENER {
 
+using std::pair;
 using std::string;
 
-Vertex::Vertex(string name, string abs_path)
-    : name(move(name)), abs_path(move(abs_path)) {}
+/// @details
+///   If abs_path is empty, the name is taken as key.
+pair<Vertex_Id, bool> Vertex_Table::insert(const string &name,
+                                           const string &abs_path) {
+  const string &key = abs_path.empty() ? name : abs_path;
+  auto key_node = paths.insert(key);
+  if (key_node < vertex_by_node.size() &&
+      vertex_by_node[key_node] != NO_VERTEX) {
+    return {vertex_by_node[key_node], false};
+  }
 
-string Vertex::get_name() const { return name; }
+  auto id = static_cast<Vertex_Id>(names.size());
+  names.push_back(abs_path.empty() ? key_node : paths.insert(name));
+  abs_paths.push_back(abs_path.empty() ? Path_Table::NONE : key_node);
+  file_sizes.emplace_back();
+  if (vertex_by_node.size() < paths.size()) {
+    vertex_by_node.resize(paths.size(), NO_VERTEX);
+  }
+  vertex_by_node[key_node] = id;
+  return {id, true};
+}
 
-string Vertex::get_abs_path() const { return abs_path; }
+Vertex_Id Vertex_Table::find(const string &key) const {
+  auto key_node = paths.find(key);
+  if (key_node == Path_Table::NONE || key_node >= vertex_by_node.size()) {
+    return NO_VERTEX;
+  }
+  return vertex_by_node[key_node];
+}
+
+string Vertex_Table::get_name(Vertex_Id id) const {
+  return paths.get(names[id]);
+}
+
+string Vertex_Table::get_abs_path(Vertex_Id id) const {
+  return abs_paths[id] == Path_Table::NONE ? string()
+                                           : paths.get(abs_paths[id]);
+}
+
+void Vertex_Table::append_name(Vertex_Id id, string *out) const {
+  paths.append(names[id], out);
+}
+
+void Vertex_Table::append_abs_path(Vertex_Id id, string *out) const {
+  if (abs_paths[id] != Path_Table::NONE) {
+    paths.append(abs_paths[id], out);
+  }
+}
+
+size_t Vertex_Table::size() const { return names.size(); }
+
+const Path_Table &Vertex_Table::get_paths() const { return paths; }
+
+void Vertex_Table::set_file_size(Vertex_Id id, const File_Size &size) {
+  file_sizes[id] = size;
+}
 
 }  // namespace INCLUDE_GARDENER
 
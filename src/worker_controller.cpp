@@ -0,0 +1,271 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "worker_controller.h"
+
+#include <sched.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using std::ifstream;
+using std::istringstream;
+using std::lock_guard;
+using std::optional;
+using std::string;
+using std::uint64_t;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Reads the first line of a file (empty if it can't be read).
+string read_line(const string &path) {
+  ifstream ifs(path);
+  string line;
+  std::getline(ifs, line);
+  return line;
+}
+
+/// @brief Returns the cgroup v1 CPU quota (cpu.cfs_quota_us / period) of
+///        a cgroup directory.
+optional<double> get_cfs_quota(const string &dir) {
+  istringstream quota_is(read_line(dir + "/cpu.cfs_quota_us"));
+  istringstream period_is(read_line(dir + "/cpu.cfs_period_us"));
+  long quota = 0;
+  long period = 0;
+  if (!(quota_is >> quota) || !(period_is >> period) || quota <= 0 ||
+      period <= 0) {
+    return {};
+  }
+  return static_cast<double>(quota) / static_cast<double>(period);
+}
+
+/// @brief Returns the smallest CPU quota of a cgroup and its ancestors.
+/// @details
+///   The limit of a parent applies to its children as well. Directories
+///   which don't exist (e.g. the cgroup of the host, if only the cgroup
+///   of a container is mounted) have no quota.
+/// @param root Mount point of the cgroup hierarchy.
+/// @param path Path of the cgroup within the hierarchy ("/a/b").
+/// @param read_quota Returns the quota of a cgroup directory.
+template <typename Read_Quota>
+optional<double> get_min_quota(const string &root, string path,
+                               Read_Quota read_quota) {
+  if (path == "/") {
+    path.clear();
+  }
+  optional<double> result;
+  while (true) {
+    const auto quota = read_quota(root + path);
+    if (quota && (!result || *quota < *result)) {
+      result = quota;
+    }
+    const auto slash = path.rfind('/');
+    if (slash == string::npos) {
+      return result;
+    }
+    path.erase(slash);
+  }
+}
+
+/// @brief Returns the number of CPUs in the affinity mask.
+unsigned int get_affinity_cpus() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    const int count = CPU_COUNT(&set);
+    if (count > 0) {
+      return static_cast<unsigned int>(count);
+    }
+  }
+  return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+}  // namespace
+
+Worker_Controller::Worker_Controller(unsigned int n_cpus,
+                                     unsigned int max_workers)
+    : n_cpus(std::max(n_cpus, 1U)),
+      max_workers(std::max(max_workers, 1U)),
+      n_active(std::min(this->n_cpus, this->max_workers)),
+      last_step(0),
+      last_throughput(0.0),
+      n_jobs(0),
+      wall_ns(0),
+      blocked_ns(0) {}
+
+unsigned int Worker_Controller::get_n_active() const {
+  lock_guard<std::mutex> lck(mutex);
+  return n_active;
+}
+
+bool Worker_Controller::add_job(Clock::time_point now, uint64_t wall_ns,
+                                uint64_t cpu_ns) {
+  lock_guard<std::mutex> lck(mutex);
+  if (!interval_start) {
+    interval_start = now - std::chrono::nanoseconds(wall_ns);
+  }
+  n_jobs++;
+  this->wall_ns += wall_ns;
+  blocked_ns += wall_ns > cpu_ns ? wall_ns - cpu_ns : 0;
+
+  const auto elapsed = now - *interval_start;
+  if (elapsed < INTERVAL) {
+    return false;
+  }
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  const double blocked_fraction =
+      this->wall_ns == 0 ? 0.0
+                         : static_cast<double>(blocked_ns) /
+                               static_cast<double>(this->wall_ns);
+  const auto before = n_active;
+  evaluate_locked(static_cast<double>(n_jobs) / seconds, blocked_fraction);
+  interval_start = now;
+  n_jobs = 0;
+  this->wall_ns = 0;
+  blocked_ns = 0;
+  return before != n_active;
+}
+
+unsigned int Worker_Controller::evaluate(double files_per_second,
+                                         double blocked_fraction) {
+  lock_guard<std::mutex> lck(mutex);
+  return evaluate_locked(files_per_second, blocked_fraction);
+}
+
+unsigned int Worker_Controller::evaluate_locked(double files_per_second,
+                                                double blocked_fraction) {
+  const unsigned int upper = blocked_fraction >= IO_BOUND_FRACTION
+                                 ? max_workers
+                                 : std::min(n_cpus, max_workers);
+  if (n_active > upper) {
+    // not (or no longer) blocked: don't oversubscribe the CPUs
+    n_active = upper;
+    last_step = 0;
+    last_throughput = files_per_second;
+    return n_active;
+  }
+  if (last_step != 0 &&
+      files_per_second < last_throughput * (1.0 - TOLERANCE)) {
+    // the last change made it worse: revert it and take a new baseline
+    // in the next interval
+    n_active = static_cast<unsigned int>(static_cast<int>(n_active) -
+                                         last_step);
+    last_step = 0;
+    last_throughput = 0.0;
+    return n_active;
+  }
+  // try one more worker (after a baseline interval)
+  const int step = (n_active < upper && last_throughput > 0.0) ? 1 : 0;
+  n_active = static_cast<unsigned int>(static_cast<int>(n_active) + step);
+  last_step = step;
+  last_throughput = files_per_second;
+  return n_active;
+}
+
+uint64_t Worker_Controller::get_thread_cpu_ns() {
+  timespec ts{};
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000U +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+unsigned int Worker_Controller::get_cpu_budget() {
+  auto budget = get_affinity_cpus();
+  ifstream ifs("/proc/self/cgroup");
+  std::ostringstream cgroups;
+  cgroups << ifs.rdbuf();
+  auto quota = get_min_quota(
+      "/sys/fs/cgroup", parse_cgroup_path(cgroups.str(), "").value_or(""),
+      [](const string &dir) {
+        return parse_cpu_max(read_line(dir + "/cpu.max"));
+      });
+  if (!quota) {
+    quota = get_min_quota("/sys/fs/cgroup/cpu",
+                          parse_cgroup_path(cgroups.str(), "cpu").value_or(""),
+                          get_cfs_quota);
+  }
+  if (quota) {
+    const auto quota_cpus = static_cast<unsigned int>(std::ceil(*quota));
+    budget = std::min(budget, std::max(quota_cpus, 1U));
+  }
+  return budget;
+}
+
+/// @details
+///   Each line is "<hierarchy id>:<controllers>:<path>". The cgroup v2
+///   line has the id 0 and no controllers; a cgroup v1 line lists its
+///   controllers separated by commas (e.g. "cpu,cpuacct").
+optional<string> Worker_Controller::parse_cgroup_path(
+    const string &content, const string &controller) {
+  istringstream is(content);
+  string line;
+  while (std::getline(is, line)) {
+    const auto first = line.find(':');
+    const auto second =
+        first == string::npos ? string::npos : line.find(':', first + 1);
+    if (second == string::npos) {
+      continue;
+    }
+    const auto controllers = line.substr(first + 1, second - first - 1);
+    bool match = false;
+    if (controller.empty()) {
+      match = controllers.empty() && line.compare(0, first, "0") == 0;
+    } else {
+      istringstream names(controllers);
+      string name;
+      while (!match && std::getline(names, name, ',')) {
+        match = name == controller;
+      }
+    }
+    if (match) {
+      return line.substr(second + 1);
+    }
+  }
+  return {};
+}
+
+optional<double> Worker_Controller::parse_cpu_max(const string &content) {
+  istringstream is(content);
+  string quota;
+  long period = 0;
+  if (!(is >> quota >> period) || period <= 0 || quota == "max") {
+    return {};
+  }
+  if (quota.empty() || quota.find_first_not_of("0123456789") != string::npos) {
+    return {};
+  }
+  const double value = std::stod(quota);
+  if (value <= 0.0) {
+    return {};
+  }
+  return value / static_cast<double>(period);
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,151 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_tree.h"
+#include "file_detector.h"
+#include "solver_c.h"
+#include "statement_detector.h"
+#include "statement_py.h"
+
+using INCLUDE_GARDENER::Bench_Tree;
+using INCLUDE_GARDENER::File_Detector;
+using INCLUDE_GARDENER::get_bench_tree;
+using INCLUDE_GARDENER::Solver;
+using INCLUDE_GARDENER::Solver_C;
+using INCLUDE_GARDENER::Statement_Detector;
+using INCLUDE_GARDENER::Statement_Py;
+
+using std::istringstream;
+using std::make_shared;
+using std::string;
+
+namespace {
+
+/// @brief Solver which ignores all edges, to measure the detection only.
+class Null_Solver : public Solver_C {
+ public:
+  explicit Null_Solver(const Solver::Ptr &solver) : solver(solver) {}
+
+  void add_edge(const string & /*src_path*/, const string & /*statement*/,
+                unsigned int /*idx*/, unsigned int /*line_no*/) override {}
+
+  std::vector<string> get_statement_regex() const override {
+    return solver->get_statement_regex();
+  }
+
+ private:
+  Solver::Ptr solver;
+};
+
+/// @brief Gives access to the protected detection methods.
+class Bench_Statement_Detector : public Statement_Detector {
+ public:
+  explicit Bench_Statement_Detector(const Solver::Ptr &solver)
+      : Statement_Detector(solver, 0) {}
+  using Statement_Detector::detect;
+  using Statement_Detector::process_stream;
+};
+
+void BM_use_file(benchmark::State &state) {
+  const auto &tree = get_bench_tree("c", 1000);
+  const auto solver = tree.make_solver();
+  const File_Detector detector(solver->get_file_regex(),
+                               {"third_party", R"(.*\.generated\..*)"},
+                               {tree.get_root()});
+  const auto &files = tree.get_files();
+  for (auto _ : state) {
+    for (const auto &f : files) {
+      benchmark::DoNotOptimize(detector.use_file(f));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(files.size()));
+}
+
+void detect(benchmark::State &state, const string &language) {
+  const auto &tree = get_bench_tree(language, 100);
+  Bench_Statement_Detector detector(
+      make_shared<Null_Solver>(tree.make_solver()));
+  const string content = tree.get_first_content();
+  std::vector<string> lines;
+  istringstream iss(content);
+  for (string line; getline(iss, line);) {
+    lines.push_back(line);
+  }
+  for (auto _ : state) {
+    for (const auto &line : lines) {
+      benchmark::DoNotOptimize(detector.detect(line));
+    }
+  }
+  detector.wait_for_workers();
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(lines.size()));
+}
+
+void BM_detect_c(benchmark::State &state) { detect(state, "c"); }
+
+void BM_detect_py(benchmark::State &state) { detect(state, "py"); }
+
+void BM_detect_ruby(benchmark::State &state) { detect(state, "ruby"); }
+
+void BM_process_stream(benchmark::State &state) {
+  const auto &tree = get_bench_tree("c", 100);
+  Bench_Statement_Detector detector(
+      make_shared<Null_Solver>(tree.make_solver()));
+  const string content = tree.get_first_content();
+  for (auto _ : state) {
+    istringstream iss(content);
+    detector.process_stream(iss, "file.h");
+  }
+  detector.wait_for_workers();
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(content.size()));
+}
+
+void BM_statement_py(benchmark::State &state) {
+  const string src_path = "/home/user/work/project/package/module.py";
+  for (auto _ : state) {
+    Statement_Py single(src_path, "..package.sub_package.module as m", 0, 1);
+    Statement_Py multi(src_path, "package.a, package.b as b, package.c", 0,
+                       2);
+    Statement_Py from(src_path, ".sub_package import module_a, module_b", 1,
+                      3);
+    benchmark::DoNotOptimize(single.get_possible_path());
+    benchmark::DoNotOptimize(multi.get_child_statements());
+    benchmark::DoNotOptimize(from.get_child_statements());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 3);
+}
+
+}  // namespace
+
+BENCHMARK(BM_use_file);
+BENCHMARK(BM_detect_c);
+BENCHMARK(BM_detect_py);
+BENCHMARK(BM_detect_ruby);
+BENCHMARK(BM_process_stream);
+BENCHMARK(BM_statement_py);
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,96 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <fstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_tree.h"
+#include "file_detector.h"
+#include "statement_detector.h"
+
+using INCLUDE_GARDENER::File_Detector;
+using INCLUDE_GARDENER::get_bench_tree;
+using INCLUDE_GARDENER::Statement_Detector;
+
+using std::ofstream;
+using std::string;
+
+namespace {
+
+/// @brief A complete run on a generated tree: walk, scan, resolve and
+///        write the dot graph (to /dev/null).
+/// @details Arguments: number of files and number of worker threads.
+void end_to_end(benchmark::State &state, const string &language) {
+  const auto &tree =
+      get_bench_tree(language, static_cast<int>(state.range(0)));
+  const int n_threads = static_cast<int>(state.range(1));
+  ofstream null_stream("/dev/null", ofstream::binary);
+  std::size_t n_vertices = 0;
+  std::size_t n_edges = 0;
+  for (auto _ : state) {
+    auto solver = tree.make_solver();
+    File_Detector files(solver->get_file_regex(), {}, {tree.get_root()}, -1);
+    files.get(solver);
+    Statement_Detector detector(solver, n_threads);
+    for (auto id : files.take_ids()) {
+      detector.add_job(solver->get_abs_path(id));
+    }
+    detector.wait_for_workers();
+    solver->write_graph("dot", null_stream);
+    n_vertices = boost::num_vertices(solver->get_graph());
+    n_edges = boost::num_edges(solver->get_graph());
+  }
+  state.counters["vertices"] = static_cast<double>(n_vertices);
+  state.counters["edges"] = static_cast<double>(n_edges);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(tree.get_n_bytes()));
+}
+
+void BM_end_to_end_c(benchmark::State &state) { end_to_end(state, "c"); }
+
+void BM_end_to_end_py(benchmark::State &state) { end_to_end(state, "py"); }
+
+void BM_end_to_end_ruby(benchmark::State &state) {
+  end_to_end(state, "ruby");
+}
+
+}  // namespace
+
+// the wall time matters, the worker threads are not part of the CPU time
+BENCHMARK(BM_end_to_end_c)
+    ->Args({1000, 1})
+    ->Args({1000, 4})
+    ->Args({10000, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_end_to_end_py)
+    ->Args({1000, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_end_to_end_ruby)
+    ->Args({1000, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
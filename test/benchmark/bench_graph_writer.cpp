@@ -0,0 +1,94 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <fstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "solver_c.h"
+
+using INCLUDE_GARDENER::Solver_C;
+
+using std::ofstream;
+using std::string;
+using std::to_string;
+
+namespace {
+
+/// @brief Solver with a synthetic graph: n files in a deep directory
+///        structure, each including ten other files.
+class Bench_Solver : public Solver_C {
+ public:
+  explicit Bench_Solver(int n) {
+    for (int i = 0; i < n; ++i) {
+      add_vertex(name(i), "/home/user/work/monorepo/" + name(i));
+    }
+    for (int i = 0; i < n; ++i) {
+      for (int j = 1; j <= 10; ++j) {
+        insert_unique_edge(static_cast<unsigned int>(i),
+                           static_cast<unsigned int>((i * 31 + j) % n),
+                           static_cast<unsigned int>(j));
+      }
+    }
+  }
+
+  static string name(int i) {
+    return "components/module_" + to_string(i % 97) + "/include/detail/" +
+           "file_" + to_string(i) + ".h";
+  }
+};
+
+template <bool Use_Boost>
+void write_graph(benchmark::State &state, const string &format) {
+  Bench_Solver solver(static_cast<int>(state.range(0)));
+  ofstream null_stream("/dev/null", ofstream::binary);
+  for (auto _ : state) {
+    if (Use_Boost) {
+      solver.write_graph_boost(format, null_stream);
+    } else {
+      solver.write_graph(format, null_stream);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_write_dot_boost(benchmark::State &state) {
+  write_graph<true>(state, "dot");
+}
+
+void BM_write_dot(benchmark::State &state) { write_graph<false>(state, "dot"); }
+
+void BM_write_graphml_boost(benchmark::State &state) {
+  write_graph<true>(state, "graphml");
+}
+
+void BM_write_graphml(benchmark::State &state) {
+  write_graph<false>(state, "graphml");
+}
+
+}  // namespace
+
+BENCHMARK(BM_write_dot_boost)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_write_dot)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_write_graphml_boost)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_write_graphml)->Arg(1000)->Arg(100000);
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,70 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <fstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "gardener_log.h"
+
+using INCLUDE_GARDENER::Logging;
+
+using std::ofstream;
+using std::string;
+
+namespace {
+
+const string FILE_NAME = "src/some/directory/file_name.cpp";
+
+/// @brief A trace statement which is filtered at runtime (the filter is
+///        set to warning in main): each one checks the core's filter.
+void BM_log_trace_filtered(benchmark::State &state) {
+  for (auto _ : state) {
+    BOOST_LOG_TRIVIAL(trace) << "Considering " << FILE_NAME;
+  }
+}
+BENCHMARK(BM_log_trace_filtered);
+
+/// @brief The same statement, removed at compile time.
+void BM_log_trace_compiled_out(benchmark::State &state) {
+  for (auto _ : state) {
+    GARDENER_LOG_MIN(trace, boost::log::trivial::info)
+        << "Considering " << FILE_NAME;
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_log_trace_compiled_out);
+
+/// @brief Costs of a record which passes the filter for the logging thread,
+///        with a synchronous (arg 0) or an asynchronous (arg 1) sink.
+void BM_log_warning_sink(benchmark::State &state) {
+  ofstream null_stream("/dev/null");
+  Logging::init(state.range(0) != 0, null_stream);
+  for (auto _ : state) {
+    BOOST_LOG_TRIVIAL(warning) << "Considering " << FILE_NAME;
+  }
+  Logging::shutdown();
+}
+BENCHMARK(BM_log_warning_sink)->Arg(0)->Arg(1);
+
+}  // namespace
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,67 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_tree.h"
+#include "file_detector.h"
+
+using INCLUDE_GARDENER::File_Detector;
+using INCLUDE_GARDENER::get_bench_tree;
+
+using std::string;
+
+namespace {
+
+/// @brief Passes all statements of a generated tree to add_edge.
+/// @details
+///   The edges already exist after the first iteration, so this mainly
+///   measures the resolution (file system probes) and the lookups.
+void add_edge(benchmark::State &state, const string &language) {
+  const auto &tree =
+      get_bench_tree(language, static_cast<int>(state.range(0)));
+  auto solver = tree.make_solver();
+  File_Detector(solver->get_file_regex(), {}, {tree.get_root()}, -1)
+      .get(solver);
+  const auto &statements = tree.get_statements();
+  for (auto _ : state) {
+    for (const auto &s : statements) {
+      solver->add_edge(s.src_path, s.statement, s.idx, s.line_no);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(statements.size()));
+}
+
+void BM_add_edge_c(benchmark::State &state) { add_edge(state, "c"); }
+
+void BM_add_edge_py(benchmark::State &state) { add_edge(state, "py"); }
+
+void BM_add_edge_ruby(benchmark::State &state) { add_edge(state, "ruby"); }
+
+}  // namespace
+
+BENCHMARK(BM_add_edge_c)->Arg(1000);
+BENCHMARK(BM_add_edge_py)->Arg(1000);
+BENCHMARK(BM_add_edge_ruby)->Arg(1000);
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
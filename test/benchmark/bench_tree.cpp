@@ -0,0 +1,191 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "bench_tree.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include "helper.h"
+
+using std::make_unique;
+using std::map;
+using std::ofstream;
+using std::ostringstream;
+using std::string;
+using std::to_string;
+using std::unique_ptr;
+using std::vector;
+
+namespace po = boost::program_options;
+
+namespace INCLUDE_GARDENER {
+
+namespace {
+
+/// @brief Number of files per directory.
+constexpr int FILES_PER_DIR = 100;
+
+string dir_name(int i) { return "mod_" + to_string(i / FILES_PER_DIR); }
+
+string file_name(int i) { return "file_" + to_string(i); }
+
+string extension(const string &language) {
+  if ("py" == language) {
+    return ".py";
+  }
+  if ("ruby" == language) {
+    return ".rb";
+  }
+  return ".h";
+}
+
+/// @brief Returns the line of a statement and sets statement and idx.
+/// @param local True, if target is in the same directory as the file.
+/// @param target Index of the included file (-1: a missing file).
+string statement_line(const string &language, bool local, int target,
+                      string *statement, unsigned int *idx) {
+  if ("py" == language) {
+    *idx = 0;
+    *statement = target < 0 ? "missing_module"
+                            : dir_name(target) + "." + file_name(target);
+    return "import " + *statement;
+  }
+  if ("ruby" == language) {
+    if (target < 0) {
+      *idx = 1;
+      *statement = "missing_gem";
+      return "require '" + *statement + "'";
+    }
+    *idx = 0;
+    *statement = local ? file_name(target)
+                       : "../" + dir_name(target) + "/" + file_name(target);
+    return "require_relative '" + *statement + "'";
+  }
+  if (target < 0) {
+    *idx = 1;
+    *statement = "missing.h";
+    return "#include <" + *statement + ">";
+  }
+  if (local) {
+    *idx = 0;
+    *statement = file_name(target) + ".h";
+    return "#include \"" + *statement + "\"";
+  }
+  *idx = 1;
+  *statement = dir_name(target) + "/" + file_name(target) + ".h";
+  return "#include <" + *statement + ">";
+}
+
+/// @brief Returns a line which is not a statement.
+string code_line(const string &language, int i, int k) {
+  const string name = "f_" + to_string(i) + "_" + to_string(k);
+  if ("py" == language) {
+    return "def " + name + "(x): return x + " + to_string(k);
+  }
+  if ("ruby" == language) {
+    return "def " + name + "(x) x + " + to_string(k) + " end";
+  }
+  return "static inline int " + name + "(int x) { return x + " +
+         to_string(k) + "; }";
+}
+
+}  // namespace
+
+Bench_Tree::Bench_Tree(const string &language, int n_files, int n_statements)
+    : language(language), n_bytes(0) {
+  root = boost::filesystem::temp_directory_path() /
+         boost::filesystem::unique_path("gardener-bench-%%%%-%%%%");
+  boost::filesystem::create_directories(root);
+  root = boost::filesystem::canonical(root);
+  const string ext = extension(language);
+
+  for (int i = 0; i < n_files; ++i) {
+    const auto dir = root / dir_name(i);
+    if (i % FILES_PER_DIR == 0) {
+      boost::filesystem::create_directories(dir);
+    }
+    const string path = (dir / (file_name(i) + ext)).string();
+    files.push_back(path);
+
+    const int dir_begin = i - i % FILES_PER_DIR;
+    const int dir_size = std::min(FILES_PER_DIR, n_files - dir_begin);
+    ostringstream content;
+    unsigned int line_no = 1;
+    for (int k = 0; k < n_statements; ++k) {
+      for (int c = 0; c < 3; ++c, ++line_no) {
+        content << code_line(language, i, k * 3 + c) << "\n";
+      }
+      const bool local = k % 2 == 0;
+      int target = local ? dir_begin + (i - dir_begin + k + 1) % dir_size
+                         : (i * 31 + k * 7 + 1) % n_files;
+      if (k == n_statements - 1) {
+        target = -1;
+      }
+      Statement s{path, "", 0, line_no};
+      content << statement_line(language, local, target, &s.statement, &s.idx)
+              << "\n";
+      ++line_no;
+      statements.push_back(s);
+    }
+    ofstream of(path, ofstream::binary);
+    const auto data = content.str();
+    of << data;
+    n_bytes += data.size();
+  }
+}
+
+Bench_Tree::~Bench_Tree() {
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(root, ec);
+}
+
+Solver::Ptr Bench_Tree::make_solver() const {
+  auto solver = Solver::get_solver(language);
+  po::variables_map vm;
+  const vector<string> paths = {root.string()};
+  vm.insert({"process-path", po::variable_value(paths, false)});
+  vm.insert({"c-include-path", po::variable_value(paths, false)});
+  vm.insert({"ruby-include-path", po::variable_value(paths, false)});
+  solver->extract_options(vm);
+  return solver;
+}
+
+string Bench_Tree::get_first_content() const {
+  string content;
+  read_file(files.at(0), &content);
+  return content;
+}
+
+const Bench_Tree &get_bench_tree(const string &language, int n_files) {
+  static map<string, unique_ptr<Bench_Tree>> trees;
+  auto &tree = trees[language + "/" + to_string(n_files)];
+  if (!tree) {
+    tree = make_unique<Bench_Tree>(language, n_files, 10);
+  }
+  return *tree;
+}
+
+}  // namespace INCLUDE_GARDENER
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
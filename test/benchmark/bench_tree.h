@@ -0,0 +1,114 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef BENCH_TREE_H
+#define BENCH_TREE_H
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "solver.h"
+
+namespace INCLUDE_GARDENER {
+
+/// @brief A generated source tree in a temporary directory.
+/// @details
+///   The tree contains n_files files of one language (c, py or ruby),
+///   distributed over directories with 100 files each. Each file has
+///   some non-statement lines and n_statements statements: half of them
+///   refer to files in the same directory, half to files in other
+///   directories, and one refers to a file which doesn't exist.
+///   The directory is removed by the dtor.
+class Bench_Tree {
+ public:
+  /// @brief A statement, as passed to Solver::add_edge.
+  struct Statement {
+    std::string src_path;   ///< Path of the file with the statement
+    std::string statement;  ///< The statement (as detected)
+    unsigned int idx;       ///< Index of the statement regex
+    unsigned int line_no;   ///< Line of the statement
+  };
+
+  /// @brief Generates the tree.
+  Bench_Tree(const std::string &language, int n_files, int n_statements);
+
+  /// @brief Copy ctor: not implemented!
+  Bench_Tree(const Bench_Tree &other) = delete;
+
+  /// @brief Assignment operator: not implemented!
+  Bench_Tree &operator=(const Bench_Tree &rhs) = delete;
+
+  /// @brief Move constructor: not implemented!
+  Bench_Tree(Bench_Tree &&rhs) = delete;
+
+  /// @brief Move assignment operator: not implemented!
+  Bench_Tree &operator=(Bench_Tree &&rhs) = delete;
+
+  /// @brief Removes the tree.
+  ~Bench_Tree();
+
+  /// @brief Returns a solver with the options for this tree
+  ///        (the files are not added).
+  Solver::Ptr make_solver() const;
+
+  /// @brief Returns the root directory.
+  std::string get_root() const { return root.string(); }
+
+  /// @brief Returns the absolute paths of all files.
+  const std::vector<std::string> &get_files() const { return files; }
+
+  /// @brief Returns the statements of all files.
+  const std::vector<Statement> &get_statements() const { return statements; }
+
+  /// @brief Returns the content of the first file.
+  std::string get_first_content() const;
+
+  /// @brief Returns the total size of all files.
+  std::size_t get_n_bytes() const { return n_bytes; }
+
+ private:
+  /// @brief Language of the files.
+  const std::string language;
+
+  /// @brief The temporary directory.
+  boost::filesystem::path root;
+
+  /// @brief Absolute paths of all files.
+  std::vector<std::string> files;
+
+  /// @brief Statements of all files.
+  std::vector<Statement> statements;
+
+  /// @brief Total size of all files.
+  std::size_t n_bytes;
+
+};  // class Bench_Tree
+
+/// @brief Returns a tree with ten statements per file, which is generated
+///        at the first call and kept until the program ends.
+const Bench_Tree &get_bench_tree(const std::string &language, int n_files);
+
+}  // namespace INCLUDE_GARDENER
+
+#endif  // BENCH_TREE_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
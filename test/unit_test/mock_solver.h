@@ -0,0 +1,56 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef MOCK_SOLVER_H
+#define MOCK_SOLVER_H
+
+#include <string>
+#include <vector>
+
+#include "solver.h"
+
+/// @brief Solver without statements, files or options, whose add_edge
+///        de-duplicates like the real solvers.
+/// @details Used by the tests which build a graph by hand.
+class Mock_Solver : public INCLUDE_GARDENER::Solver {
+  std::vector<std::string> get_statement_regex() const override { return {}; }
+
+  std::string get_file_regex() const override { return std::string(); }
+
+  // NOLINTNEXTLINE
+  void add_options(
+      boost::program_options::options_description *) const override {}
+
+  // NOLINTNEXTLINE
+  void extract_options(const boost::program_options::variables_map &) override {
+  }
+
+ public:
+  // NOLINTNEXTLINE
+  void add_edge(const std::string &src, const std::string &dst, unsigned int,
+                unsigned int line_no) override {
+    insert_unique_edge(find_or_add_vertex(src), find_or_add_vertex(dst),
+                       line_no);
+  }
+};
+
+#endif  // MOCK_SOLVER_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
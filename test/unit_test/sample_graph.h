@@ -0,0 +1,57 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#ifndef SAMPLE_GRAPH_H
+#define SAMPLE_GRAPH_H
+
+#include <string>
+
+#include "graph.h"
+#include "vertex.h"
+
+#include <gtest/gtest.h>
+
+/// @brief Fixture with a small graph of units, headers and a cycle.
+/// @details
+///   0.c -> 3.h -> 5.h, 1.c -> 4.h -> 5.h, 2.c -> 4.h, 5.h <-> 6.h, 7.c
+///   File v has 2^v bytes and v + 1 lines.
+class Sample_Graph_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    boost::add_edge(0, 3, g);
+    boost::add_edge(1, 4, g);
+    boost::add_edge(2, 4, g);
+    boost::add_edge(3, 5, g);
+    boost::add_edge(4, 5, g);
+    boost::add_edge(5, 6, g);
+    boost::add_edge(6, 5, g);
+    for (INCLUDE_GARDENER::Vertex_Id v = 0; v < 8; ++v) {
+      const auto id = vertexes.insert(std::to_string(v), "").first;
+      vertexes.set_file_size(id, INCLUDE_GARDENER::File_Size{1U << v, v + 1});
+    }
+  }
+
+  INCLUDE_GARDENER::Graph g{8};
+  INCLUDE_GARDENER::Vertex_Table vertexes;
+};
+
+#endif  // SAMPLE_GRAPH_H
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,129 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "bounded_queue.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using INCLUDE_GARDENER::Bounded_Queue;
+using std::string;
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(Bounded_Queue_Test, fifo_and_capacity) {
+  Bounded_Queue<string> queue(3);
+  EXPECT_EQ(queue.get_capacity(), 4U);
+
+  for (int i = 0; i < 4; ++i) {
+    string value = std::to_string(i);
+    EXPECT_TRUE(queue.try_push(value));
+  }
+  string value = "full";
+  EXPECT_FALSE(queue.try_push(value));
+  EXPECT_EQ(value, "full");
+  EXPECT_EQ(queue.size(), 4U);
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_pop(&value));
+    EXPECT_EQ(value, std::to_string(i));
+  }
+  EXPECT_FALSE(queue.try_pop(&value));
+
+  const auto stats = queue.get_stats();
+  EXPECT_EQ(stats.capacity, 4U);
+  EXPECT_EQ(stats.n_pushes, 4U);
+  EXPECT_EQ(stats.depth_sum, 1U + 2U + 3U + 4U);
+  EXPECT_EQ(stats.max_depth, 4U);
+}
+
+// NOLINTNEXTLINE
+TEST(Bounded_Queue_Test, pop_returns_false_after_close) {
+  Bounded_Queue<int> queue(2);
+  queue.push(1);
+  queue.close();
+  int value = 0;
+  EXPECT_TRUE(queue.pop(&value));
+  EXPECT_EQ(value, 1);
+  EXPECT_FALSE(queue.pop(&value));
+}
+
+// All entries of multiple producers are taken exactly once by multiple
+// consumers, although the queue is much smaller than the number of
+// entries.
+//
+// NOLINTNEXTLINE
+TEST(Bounded_Queue_Test, multiple_producers_and_consumers) {
+  constexpr int N_PRODUCERS = 4;
+  constexpr int N_CONSUMERS = 3;
+  constexpr int N_ENTRIES = 20000;
+  Bounded_Queue<int> queue(16);
+
+  vector<std::thread> producers;
+  for (int p = 0; p < N_PRODUCERS; ++p) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < N_ENTRIES; ++i) {
+        queue.push(p * N_ENTRIES + i);
+      }
+    });
+  }
+  vector<vector<int>> taken(N_CONSUMERS);
+  vector<std::thread> consumers;
+  for (int c = 0; c < N_CONSUMERS; ++c) {
+    consumers.emplace_back([&queue, &taken, c]() {
+      int value;
+      while (queue.pop(&value)) {
+        taken[c].push_back(value);
+      }
+    });
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  queue.close();
+  for (auto &t : consumers) {
+    t.join();
+  }
+
+  vector<int> count(N_PRODUCERS * N_ENTRIES, 0);
+  for (const auto &values : taken) {
+    // the entries of one producer are taken in order
+    vector<int> last(N_PRODUCERS, -1);
+    for (auto v : values) {
+      ++count[v];
+      EXPECT_GT(v, last[v / N_ENTRIES]);
+      last[v / N_ENTRIES] = v;
+    }
+  }
+  for (auto n : count) {
+    ASSERT_EQ(n, 1);
+  }
+  const auto stats = queue.get_stats();
+  EXPECT_EQ(stats.n_pushes,
+            static_cast<std::uint64_t>(N_PRODUCERS * N_ENTRIES));
+  EXPECT_LE(stats.max_depth, 16U);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,186 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "compressed_ostream.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#ifdef GARDENER_WITH_ZLIB
+#define ZLIB_CONST
+#include <zlib.h>
+#endif
+
+using INCLUDE_GARDENER::Compressed_Ostream;
+using INCLUDE_GARDENER::Compressing_Buffer;
+using INCLUDE_GARDENER::Compression;
+
+using std::ostringstream;
+using std::string;
+using std::to_string;
+
+// NOLINTNEXTLINE
+TEST(Compression_Test, parse) {
+  auto c = Compression::parse("gzip");
+  ASSERT_TRUE(c);
+  EXPECT_EQ(c->method, Compression::Method::GZIP);
+  EXPECT_EQ(c->level, Compression::DEFAULT_LEVEL);
+
+  c = Compression::parse("zstd:19");
+  ASSERT_TRUE(c);
+  EXPECT_EQ(c->method, Compression::Method::ZSTD);
+  EXPECT_EQ(c->level, 19);
+
+  c = Compression::parse("none");
+  ASSERT_TRUE(c);
+  EXPECT_EQ(c->method, Compression::Method::NONE);
+
+  EXPECT_FALSE(Compression::parse(""));
+  EXPECT_FALSE(Compression::parse("bzip2"));
+  EXPECT_FALSE(Compression::parse("gzip:"));
+  EXPECT_FALSE(Compression::parse("gzip:0"));
+  EXPECT_FALSE(Compression::parse("gzip:10"));
+  EXPECT_FALSE(Compression::parse("gzip:-1"));
+  EXPECT_FALSE(Compression::parse("zstd:23"));
+  EXPECT_FALSE(Compression::parse("none:1"));
+}
+
+#ifdef GARDENER_WITH_ZLIB
+
+namespace {
+
+/// Decompresses data, which is a complete stream if finished is true.
+string gunzip(const string &data, bool finished = true) {
+  z_stream stream{};
+  EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+  stream.next_in = reinterpret_cast<const Bytef *>(data.data());
+  stream.avail_in = static_cast<uInt>(data.size());
+  string out;
+  int result;
+  do {
+    char buffer[4096];
+    stream.next_out = reinterpret_cast<Bytef *>(buffer);
+    stream.avail_out = sizeof(buffer);
+    result = inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - stream.avail_out);
+  } while (result == Z_OK &&
+           (stream.avail_in != 0 || stream.avail_out == 0));
+  EXPECT_EQ(result, finished ? Z_STREAM_END : Z_OK);
+  EXPECT_EQ(stream.avail_in, 0U);
+  inflateEnd(&stream);
+  return out;
+}
+
+/// Sink which remembers its content at each flush.
+class Flush_Sink : public std::stringbuf {
+ public:
+  /// Waits for the n-th flush and returns the content at this flush.
+  string wait_for_flush(std::size_t n) {
+    std::unique_lock<std::mutex> lck(mutex);
+    condition.wait(lck, [&] { return flushed.size() >= n; });
+    return flushed[n - 1];
+  }
+
+ protected:
+  int sync() override {
+    std::lock_guard<std::mutex> lck(mutex);
+    flushed.push_back(str());
+    condition.notify_all();
+    return 0;
+  }
+
+ private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<string> flushed;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(Compressed_Ostream_Test, gzip_round_trip) {
+  string expectation;
+  ostringstream compressed;
+  {
+    Compressed_Ostream os(compressed, {Compression::Method::GZIP, 9});
+    // more than a few chunks, with flushes in between
+    for (int i = 0; expectation.size() < 3 * Compressing_Buffer::CHUNK_SIZE;
+         ++i) {
+      const string line = "/repo/src/file_" + to_string(i) + ".c\n";
+      os << line;
+      expectation += line;
+      if (i % 10000 == 0) {
+        os.flush();
+      }
+    }
+    os.close();
+  }
+  EXPECT_LT(compressed.str().size(), expectation.size() / 4);
+  EXPECT_EQ(gunzip(compressed.str()), expectation);
+}
+
+// NOLINTNEXTLINE
+TEST(Compressed_Ostream_Test, gzip_sync_flush) {
+  Flush_Sink sink_buffer;
+  std::ostream sink(&sink_buffer);
+  Compressed_Ostream os(sink, {Compression::Method::GZIP, 9}, true);
+  os << "{\"type\":\"vertex\",\"id\":0}\n";
+  os.flush();
+  EXPECT_EQ(gunzip(sink_buffer.wait_for_flush(1), false),
+            "{\"type\":\"vertex\",\"id\":0}\n");
+  os << "{\"type\":\"vertex\",\"id\":1}\n";
+  os.flush();
+  EXPECT_EQ(gunzip(sink_buffer.wait_for_flush(2), false),
+            "{\"type\":\"vertex\",\"id\":0}\n"
+            "{\"type\":\"vertex\",\"id\":1}\n");
+  os.close();
+}
+
+// NOLINTNEXTLINE
+TEST(Compressed_Ostream_Test, empty_gzip_stream) {
+  ostringstream compressed;
+  {
+    Compressed_Ostream os(compressed, {Compression::Method::GZIP,
+                                       Compression::DEFAULT_LEVEL});
+  }
+  EXPECT_FALSE(compressed.str().empty());
+  EXPECT_EQ(gunzip(compressed.str()), "");
+}
+
+#endif
+
+// NOLINTNEXTLINE
+TEST(Compressed_Ostream_Test, unsupported_method) {
+  ostringstream compressed;
+  EXPECT_THROW(Compressed_Ostream os(compressed, Compression{}),
+               std::runtime_error);
+  if (!Compression::is_supported(Compression::Method::ZSTD)) {
+    EXPECT_THROW(
+        Compressed_Ostream os(compressed, {Compression::Method::ZSTD, 3}),
+        std::runtime_error);
+  }
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
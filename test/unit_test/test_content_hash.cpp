@@ -0,0 +1,53 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "content_hash.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::content_hash;
+
+using std::string;
+
+// NOLINTNEXTLINE
+TEST(Content_Hash_Test, reference_values) {
+  const string empty;
+  const string abc = "abc";
+  const string text = "Nobody inspects the spammish repetition";
+  EXPECT_EQ(content_hash(empty.data(), empty.size()), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(content_hash(abc.data(), abc.size()), 0x44BC2CF5AD770999ULL);
+  EXPECT_EQ(content_hash(text.data(), text.size()), 0xFBCEA83C8A378BF1ULL);
+}
+
+// NOLINTNEXTLINE
+TEST(Content_Hash_Test, seed_and_content_change_the_hash) {
+  string data(100, 'x');
+  const auto hash = content_hash(data.data(), data.size());
+  EXPECT_NE(hash, content_hash(data.data(), data.size(), 1));
+  data[57] = 'y';
+  EXPECT_NE(hash, content_hash(data.data(), data.size()));
+  EXPECT_NE(hash, content_hash(data.data(), data.size() - 1));
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
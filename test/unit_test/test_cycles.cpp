@@ -0,0 +1,78 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <vector>
+
+#include "csr_graph.h"
+#include "cycles.h"
+#include "scc.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Csr_Graph;
+using INCLUDE_GARDENER::Edge;
+using INCLUDE_GARDENER::find_cycles;
+using INCLUDE_GARDENER::Graph;
+using INCLUDE_GARDENER::Strong_Components;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(Cycles_Test, reports_shortest_cycle_per_component) {
+  // 0 -> 1 -> 2 -> 0, 1 -> 0 (shortest: 0 -> 1 -> 0),
+  // 3 -> 4 -> 5 -> 3, 6 -> 6, 7 -> 3
+  Graph g(8);
+  boost::add_edge(0, 1, Edge{10}, g);
+  boost::add_edge(1, 2, Edge{11}, g);
+  boost::add_edge(2, 0, Edge{12}, g);
+  boost::add_edge(1, 0, Edge{13}, g);
+  boost::add_edge(3, 4, Edge{20}, g);
+  boost::add_edge(4, 5, Edge{21}, g);
+  boost::add_edge(5, 3, Edge{22}, g);
+  boost::add_edge(6, 6, Edge{30}, g);
+  boost::add_edge(7, 3, Edge{40}, g);
+  Csr_Graph csr(g);
+  Strong_Components components(csr);
+  auto cycles = find_cycles(csr, components);
+
+  ASSERT_EQ(cycles.size(), 3U);
+  EXPECT_EQ(cycles[0].vertices, (vector<Vertex_Id>{0, 1}));
+  EXPECT_EQ(cycles[0].lines, (vector<int>{10, 13}));
+  EXPECT_EQ(cycles[0].component_size, 3U);
+  EXPECT_EQ(cycles[1].vertices, (vector<Vertex_Id>{3, 4, 5}));
+  EXPECT_EQ(cycles[1].lines, (vector<int>{20, 21, 22}));
+  EXPECT_EQ(cycles[2].vertices, vector<Vertex_Id>{6});
+  EXPECT_EQ(cycles[2].lines, vector<int>{30});
+}
+
+// NOLINTNEXTLINE
+TEST(Cycles_Test, no_cycles_in_dag) {
+  Graph g(4);
+  boost::add_edge(0, 1, g);
+  boost::add_edge(1, 2, g);
+  boost::add_edge(0, 2, g);
+  Csr_Graph csr(g);
+  Strong_Components components(csr);
+  EXPECT_TRUE(find_cycles(csr, components).empty());
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
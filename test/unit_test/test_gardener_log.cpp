@@ -0,0 +1,68 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "gardener_log.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Logging;
+
+using std::ostringstream;
+using std::string;
+
+// NOLINTNEXTLINE
+TEST(Gardener_Log_Test, statements_below_min_level_are_not_evaluated) {
+  int n_calls = 0;
+  auto count = [&n_calls] { return ++n_calls; };
+  ostringstream os;
+  Logging::init(false, os);
+  GARDENER_LOG_MIN(trace, boost::log::trivial::info) << "trace " << count();
+  GARDENER_LOG_MIN(debug, boost::log::trivial::info) << "debug " << count();
+  GARDENER_LOG_MIN(info, boost::log::trivial::info) << "info " << count();
+  Logging::shutdown();
+  EXPECT_EQ(n_calls, 1);
+  EXPECT_EQ(os.str().find("trace"), string::npos);
+  EXPECT_NE(os.str().find("[info] info 1\n"), string::npos);
+}
+
+// NOLINTNEXTLINE
+TEST(Gardener_Log_Test, async_sink_writes_all_records_on_shutdown) {
+  constexpr int N_RECORDS = 3 * Logging::MAX_PENDING_RECORDS;
+  ostringstream os;
+  Logging::init(true, os);
+  for (int i = 0; i < N_RECORDS; ++i) {
+    BOOST_LOG_TRIVIAL(warning) << "record " << i;
+  }
+  Logging::shutdown();
+
+  const string log = os.str();
+  EXPECT_NE(log.find("[warning] record 0\n"), string::npos);
+  EXPECT_NE(log.find("[warning] record " + std::to_string(N_RECORDS - 1) +
+                     "\n"),
+            string::npos);
+  EXPECT_EQ(std::count(log.begin(), log.end(), '\n'), N_RECORDS);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,201 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+
+#include "graph_file.h"
+#include "mock_solver.h"
+#include "solver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+using INCLUDE_GARDENER::Graph_File;
+using INCLUDE_GARDENER::Graph_File_Header;
+using INCLUDE_GARDENER::NO_VERTEX;
+using INCLUDE_GARDENER::Solver;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::ofstream;
+using std::string;
+
+class Graph_File_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path = boost::filesystem::temp_directory_path() /
+           boost::filesystem::unique_path("gardener-%%%%-%%%%.bin");
+  }
+
+  void TearDown() override { boost::filesystem::remove(path); }
+
+  void write(Solver *s) {
+    ofstream of(path.string(), ofstream::binary);
+    s->write_graph("bin", of);
+  }
+
+  /// Reads the 64-bit value at offset of the written file.
+  std::uint64_t peek(std::uint64_t offset) {
+    std::uint64_t value = 0;
+    std::ifstream ifs(path.string(), std::ifstream::binary);
+    ifs.seekg(static_cast<std::streamoff>(offset));
+    ifs.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+  }
+
+  /// Overwrites the 64-bit value at offset of the written file.
+  void patch(std::uint64_t offset, std::uint64_t value) {
+    std::fstream fs(path.string(), std::fstream::in | std::fstream::out |
+                                       std::fstream::binary);
+    fs.seekp(static_cast<std::streamoff>(offset));
+    fs.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  /// Overwrites the 32-bit value at offset of the written file.
+  void patch_id(std::uint64_t offset, std::uint32_t value) {
+    std::fstream fs(path.string(), std::fstream::in | std::fstream::out |
+                                       std::fstream::binary);
+    fs.seekp(static_cast<std::streamoff>(offset));
+    fs.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  boost::filesystem::path path;
+};
+
+// NOLINTNEXTLINE
+TEST_F(Graph_File_Test, round_trip) {
+  Mock_Solver s;
+  s.add_vertex("src/a.c", "/repo/src/a.c");
+  s.add_vertex("inc/b.h", "/repo/inc/b.h");
+  s.add_vertex("stdio.h", "");
+  s.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 3);
+  s.add_edge("/repo/src/a.c", "stdio.h", 0, 1);
+  s.add_edge("/repo/inc/b.h", "stdio.h", 0, 7);
+  s.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 9);
+  write(&s);
+
+  Graph_File g(path.string());
+  EXPECT_EQ(g.get_n_vertices(), 3U);
+  EXPECT_EQ(g.get_n_edges(), 3U);
+
+  EXPECT_EQ(g.get_name(0), "src/a.c");
+  EXPECT_EQ(g.get_abs_path(0), "/repo/src/a.c");
+  EXPECT_EQ(g.get_abs_path(2), "");
+  EXPECT_EQ(g.get_key(2), "stdio.h");
+
+  EXPECT_EQ(g.find("/repo/inc/b.h"), 1U);
+  EXPECT_EQ(g.find("stdio.h"), 2U);
+  EXPECT_EQ(g.find("inc/b.h"), NO_VERTEX);
+
+  ASSERT_EQ(g.get_end_edge(0) - g.get_first_edge(0), 2U);
+  auto e = g.get_first_edge(0);
+  EXPECT_EQ(g.get_target(e), 1U);
+  EXPECT_EQ(g.get_line(e), 3);
+  EXPECT_EQ(g.get_count(e), 2U);
+  EXPECT_EQ(g.get_target(e + 1), 2U);
+  EXPECT_EQ(g.get_line(e + 1), 1);
+
+  ASSERT_EQ(g.get_end_edge(1) - g.get_first_edge(1), 1U);
+  EXPECT_EQ(g.get_target(g.get_first_edge(1)), 2U);
+  EXPECT_EQ(g.get_first_edge(2), g.get_end_edge(2));
+}
+
+// NOLINTNEXTLINE
+TEST_F(Graph_File_Test, empty_graph) {
+  Mock_Solver s;
+  write(&s);
+  Graph_File g(path.string());
+  EXPECT_EQ(g.get_n_vertices(), 0U);
+  EXPECT_EQ(g.get_n_edges(), 0U);
+  EXPECT_EQ(g.find("x"), NO_VERTEX);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Graph_File_Test, rejects_invalid_files) {
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+
+  {
+    ofstream of(path.string());
+    of << "digraph G {\n}\n";
+  }
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+
+  Mock_Solver s;
+  s.add_vertex("x", "x");
+  write(&s);
+  boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 8);
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Graph_File_Test, rejects_corrupt_sections) {
+  Mock_Solver s;
+  s.add_vertex("a.h", "/repo/a.h");
+  s.add_vertex("b.h", "/repo/b.h");
+  s.add_edge("/repo/a.h", "/repo/b.h", 0, 1);
+  write(&s);
+  EXPECT_NO_THROW(Graph_File g(path.string()));
+
+  // (n_strings + 1) * 8 overflows to 8
+  const auto n_strings_offset = offsetof(Graph_File_Header, n_strings);
+  const auto n_strings = peek(n_strings_offset);
+  patch(n_strings_offset, (1ULL << 61U) - 1);
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+  patch(n_strings_offset, n_strings);
+
+  // the first string would end behind the second one
+  const auto string_offsets =
+      peek(offsetof(Graph_File_Header, string_offsets));
+  const auto end_of_first = peek(string_offsets + 8);
+  patch(string_offsets + 8, 1000);
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+  patch(string_offsets + 8, end_of_first);
+  EXPECT_NO_THROW(Graph_File g(path.string()));
+
+  // the edges of the first vertex would end behind the last edge
+  const auto rows = peek(offsetof(Graph_File_Header, rows));
+  patch(rows + 8, 2);
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+}
+// NOLINTNEXTLINE
+TEST_F(Graph_File_Test, rejects_bad_vertex_ids) {
+  Mock_Solver s;
+  s.add_vertex("a.h", "/repo/a.h");
+  s.add_vertex("b.h", "/repo/b.h");
+  s.add_edge("/repo/a.h", "/repo/b.h", 0, 1);
+  write(&s);
+
+  // a key index entry behind the vertex table
+  const auto key_index = peek(offsetof(Graph_File_Header, key_index));
+  patch_id(key_index + 4, 2);
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+  patch_id(key_index + 4, 1);
+  EXPECT_NO_THROW(Graph_File g(path.string()));
+
+  // an edge target behind the vertex table
+  const auto targets = peek(offsetof(Graph_File_Header, targets));
+  patch_id(targets, 0xffffffffU);
+  EXPECT_THROW(Graph_File g(path.string()), std::runtime_error);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,166 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+#include "graph_merger.h"
+#include "mock_solver.h"
+#include "solver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+
+using INCLUDE_GARDENER::Graph_Merger;
+using INCLUDE_GARDENER::NO_VERTEX;
+using INCLUDE_GARDENER::Solver;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::ofstream;
+using std::string;
+
+namespace {
+
+/// (source name, target name, line, count)
+using Edge_Record = std::tuple<string, string, int, unsigned int>;
+
+std::set<Edge_Record> get_edges(const Graph_Merger &merger) {
+  const auto &graph = merger.get_graph();
+  const auto &vertexes = merger.get_vertexes();
+  std::set<Edge_Record> edges;
+  for (auto e : boost::make_iterator_range(boost::edges(graph))) {
+    edges.emplace(
+        vertexes.get_name(static_cast<Vertex_Id>(boost::source(e, graph))),
+        vertexes.get_name(static_cast<Vertex_Id>(boost::target(e, graph))),
+        graph[e].line, graph[e].count);
+  }
+  return edges;
+}
+
+}  // namespace
+
+class Graph_Merger_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("gardener-%%%%-%%%%");
+    boost::filesystem::create_directories(dir);
+  }
+
+  void TearDown() override { boost::filesystem::remove_all(dir); }
+
+  string write(Solver *s, const string &name, const string &format) {
+    const auto path = (dir / name).string();
+    ofstream of(path, ofstream::binary);
+    s->write_graph(format, of);
+    return path;
+  }
+
+  boost::filesystem::path dir;
+};
+
+// Vertices are unified by their absolute path, edges with the same
+// source and target are merged (smallest line, largest count).
+//
+// NOLINTNEXTLINE
+TEST_F(Graph_Merger_Test, merges_binary_graphs) {
+  Mock_Solver s1;
+  s1.add_vertex("src/a.c", "/repo/src/a.c");
+  s1.add_vertex("inc/b.h", "/repo/inc/b.h");
+  s1.add_vertex("stdio.h", "");
+  s1.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 3);
+  s1.add_edge("/repo/src/a.c", "stdio.h", 0, 1);
+  const auto p1 = write(&s1, "1.bin", "bin");
+
+  Mock_Solver s2;
+  s2.add_vertex("stdio.h", "");
+  s2.add_vertex("inc/b.h", "/repo/inc/b.h");
+  s2.add_vertex("src/a.c", "/repo/src/a.c");
+  s2.add_vertex("src/d.c", "/repo/src/d.c");
+  s2.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 5);
+  s2.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 8);
+  s2.add_edge("/repo/src/d.c", "/repo/inc/b.h", 0, 2);
+  s2.add_edge("/repo/inc/b.h", "stdio.h", 0, 4);
+  const auto p2 = write(&s2, "2.bin", "bin");
+
+  // one edge per run
+  Graph_Merger merger(2, 1);
+  merger.merge({p1, p2});
+  EXPECT_EQ(merger.get_n_runs(), 5U);
+
+  const auto &vertexes = merger.get_vertexes();
+  ASSERT_EQ(vertexes.size(), 4U);
+  EXPECT_EQ(vertexes.get_name(0), "src/a.c");
+  EXPECT_EQ(vertexes.get_name(3), "src/d.c");
+  EXPECT_EQ(vertexes.find("/repo/inc/b.h"), 1U);
+  EXPECT_EQ(vertexes.find("stdio.h"), 2U);
+
+  const std::set<Edge_Record> expected = {
+      {"src/a.c", "inc/b.h", 3, 2},
+      {"src/a.c", "stdio.h", 1, 1},
+      {"inc/b.h", "stdio.h", 4, 1},
+      {"src/d.c", "inc/b.h", 2, 1},
+  };
+  EXPECT_EQ(get_edges(merger), expected);
+}
+
+// GraphML files have no absolute paths, their vertices are unified by
+// name (names are XML-decoded).
+//
+// NOLINTNEXTLINE
+TEST_F(Graph_Merger_Test, merges_graphml) {
+  Mock_Solver s1;
+  s1.add_vertex("a&b.c", "/repo/a&b.c");
+  s1.add_vertex("<c.h>", "/repo/<c.h>");
+  s1.add_edge("/repo/a&b.c", "/repo/<c.h>", 0, 1);
+  const auto p1 = write(&s1, "1.graphml", "graphml");
+
+  Mock_Solver s2;
+  s2.add_vertex("d.c", "/repo/d.c");
+  s2.add_vertex("<c.h>", "/repo/<c.h>");
+  s2.add_edge("/repo/d.c", "/repo/<c.h>", 0, 7);
+  const auto p2 = write(&s2, "2.graphml", "graphml");
+
+  Graph_Merger merger;
+  merger.merge({p1, p2});
+  EXPECT_EQ(merger.get_n_runs(), 1U);
+  EXPECT_EQ(merger.get_vertexes().size(), 3U);
+  EXPECT_NE(merger.get_vertexes().find("<c.h>"), NO_VERTEX);
+
+  const std::set<Edge_Record> expected = {
+      {"a&b.c", "<c.h>", 1, 1},
+      {"d.c", "<c.h>", 7, 1},
+  };
+  EXPECT_EQ(get_edges(merger), expected);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Graph_Merger_Test, missing_file) {
+  Graph_Merger merger;
+  EXPECT_THROW(merger.merge({(dir / "missing.bin").string()}),
+               std::runtime_error);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
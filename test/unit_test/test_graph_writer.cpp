@@ -0,0 +1,115 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <sstream>
+
+#include "graph_writer.h"
+#include "mock_solver.h"
+#include "solver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Graph_Writer;
+using INCLUDE_GARDENER::Solver;
+
+using std::ostringstream;
+using std::string;
+using std::to_string;
+
+namespace {
+
+class Mock_Solver_Writer : public Mock_Solver {
+ public:
+  string write_small_buffer(const string &format) {
+    ostringstream os;
+    Graph_Writer writer(graph, vertexes, 16);
+    if (format == "dot") {
+      writer.write_dot(os);
+    } else {
+      writer.write_graphml(os);
+    }
+    return os.str();
+  }
+};
+
+string write(Solver *s, const string &format) {
+  ostringstream os;
+  s->write_graph(format, os);
+  return os.str();
+}
+
+string write_boost(Solver *s, const string &format) {
+  ostringstream os;
+  s->write_graph_boost(format, os);
+  return os.str();
+}
+
+}  // namespace
+
+class Graph_Writer_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < 50; ++i) {
+      s.add_vertex("src/file_" + to_string(i) + ".c",
+                   "/repo/src/file_" + to_string(i) + ".c");
+    }
+    s.add_vertex("a<b>&\"c'.h", "");
+    s.add_vertex("   ", "");
+    s.add_vertex("", "");
+    for (int i = 0; i < 50; ++i) {
+      s.add_edge("/repo/src/file_" + to_string(i) + ".c",
+                 "/repo/src/file_" + to_string((i * 7) % 50) + ".c", 0,
+                 static_cast<unsigned int>(i));
+      s.add_edge("/repo/src/file_" + to_string(i) + ".c", "a<b>&\"c'.h", 0,
+                 1);
+    }
+    s.add_edge("   ", "", 0, 0);
+  }
+
+  Mock_Solver_Writer s;
+};
+
+// NOLINTNEXTLINE
+TEST_F(Graph_Writer_Test, dot_equals_boost) {
+  auto expectation = write_boost(&s, "dot");
+  EXPECT_EQ(write(&s, "dot"), expectation);
+  EXPECT_EQ(s.write_small_buffer("dot"), expectation);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Graph_Writer_Test, graphml_equals_boost) {
+  auto expectation = write_boost(&s, "graphml");
+  EXPECT_EQ(write(&s, "graphml"), expectation);
+  EXPECT_EQ(write(&s, "xml"), expectation);
+  EXPECT_EQ(s.write_small_buffer("graphml"), expectation);
+  EXPECT_THAT(expectation, testing::HasSubstr(
+                               "a&lt;b&gt;&amp;&quot;c&apos;.h</data>"));
+  EXPECT_THAT(expectation, testing::HasSubstr(">&#32;  </data>"));
+}
+
+// NOLINTNEXTLINE
+TEST_F(Graph_Writer_Test, empty_graph_equals_boost) {
+  Mock_Solver_Writer empty;
+  EXPECT_EQ(write(&empty, "dot"), write_boost(&empty, "dot"));
+  EXPECT_EQ(write(&empty, "graphml"), write_boost(&empty, "graphml"));
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
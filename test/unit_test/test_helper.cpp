@@ -20,15 +20,19 @@
 //
 #include <gtest/gtest.h>
 
+#include <fstream>
 #include <string>
 #include <vector>
 
+#include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
 
 #include "helper.h"
 
 using boost::regex;
 using INCLUDE_GARDENER::init_regex_vector;
+using INCLUDE_GARDENER::parse_size;
+using INCLUDE_GARDENER::read_file;
 using std::string;
 using std::vector;
 
@@ -41,4 +45,41 @@ TEST(Helper_Test, test_init_regex_vector) {
   EXPECT_EQ(init_regex_vector(arg), expected);
 }
 
+// NOLINTNEXTLINE
+TEST(Helper_Test, test_parse_size) {
+  EXPECT_EQ(parse_size("4096"), 4096U);
+  EXPECT_EQ(parse_size("64k"), 64U << 10U);
+  EXPECT_EQ(parse_size("512M"), 512U << 20U);
+  EXPECT_EQ(parse_size("2G"), std::size_t{2} << 30U);
+  EXPECT_FALSE(parse_size(""));
+  EXPECT_FALSE(parse_size("M"));
+  EXPECT_FALSE(parse_size("12T"));
+  EXPECT_FALSE(parse_size("12MB"));
+  EXPECT_FALSE(parse_size("-1"));
+}
+
+// NOLINTNEXTLINE
+TEST(Helper_Test, test_read_file) {
+  const auto path = boost::filesystem::temp_directory_path() /
+                    boost::filesystem::unique_path("gardener-%%%%-%%%%.h");
+  string expected;
+  for (int i = 0; i < 10000; ++i) {
+    expected += "#include \"file_" + std::to_string(i) + ".h\"\n";
+  }
+  {
+    std::ofstream of(path.string(), std::ofstream::binary);
+    of << expected;
+  }
+  string content = "old content";
+  EXPECT_TRUE(read_file(path.string(), &content));
+  EXPECT_EQ(content, expected);
+
+  { std::ofstream of(path.string(), std::ofstream::binary); }
+  EXPECT_TRUE(read_file(path.string(), &content));
+  EXPECT_EQ(content, "");
+
+  boost::filesystem::remove(path);
+  EXPECT_FALSE(read_file(path.string(), &content));
+}
+
 // vim: filetype=cpp et ts=2 sw=2 sts=2
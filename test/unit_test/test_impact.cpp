@@ -0,0 +1,54 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <vector>
+
+#include "csr_graph.h"
+#include "impact.h"
+#include "sample_graph.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Csr_Graph;
+using INCLUDE_GARDENER::find_affected;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::vector;
+
+class Impact_Test : public Sample_Graph_Test {};
+
+// NOLINTNEXTLINE
+TEST_F(Impact_Test, single_header) {
+  auto reverse = Csr_Graph(g).reversed();
+  EXPECT_EQ(find_affected(reverse, {3}), (vector<Vertex_Id>{0, 3}));
+  EXPECT_EQ(find_affected(reverse, {4}), (vector<Vertex_Id>{1, 2, 4}));
+  EXPECT_EQ(find_affected(reverse, {6}),
+            (vector<Vertex_Id>{0, 1, 2, 3, 4, 5, 6}));
+}
+
+// NOLINTNEXTLINE
+TEST_F(Impact_Test, multiple_sources) {
+  auto reverse = Csr_Graph(g).reversed();
+  EXPECT_EQ(find_affected(reverse, {3, 7, 3}), (vector<Vertex_Id>{0, 3, 7}));
+  EXPECT_EQ(find_affected(reverse, {}), vector<Vertex_Id>{});
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
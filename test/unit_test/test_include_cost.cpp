@@ -0,0 +1,86 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <vector>
+
+#include "csr_graph.h"
+#include "include_cost.h"
+#include "sample_graph.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Csr_Graph;
+using INCLUDE_GARDENER::Graph;
+using INCLUDE_GARDENER::Include_Cost;
+using INCLUDE_GARDENER::Transitive_Closure;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::vector;
+
+class Include_Cost_Test : public Sample_Graph_Test {};
+
+// NOLINTNEXTLINE
+TEST_F(Include_Cost_Test, units_and_headers) {
+  for (unsigned int n_threads : {1U, 3U}) {
+    const Csr_Graph csr(g);
+    const Transitive_Closure closure(csr, n_threads);
+    const Include_Cost cost(csr, closure, vertexes, {0, 1, 2, 7}, n_threads);
+
+    const auto &units = cost.get_units();
+    ASSERT_EQ(units.size(), 4U);
+    vector<Vertex_Id> order;
+    for (const auto &u : units) {
+      order.push_back(u.unit);
+    }
+    EXPECT_EQ(order, (vector<Vertex_Id>{7, 2, 1, 0}));
+    EXPECT_EQ(units[0].bytes, 128U);
+    EXPECT_EQ(units[0].n_headers, 0U);
+    EXPECT_EQ(units[1].bytes, 4U + 16U + 32U + 64U);
+    EXPECT_EQ(units[1].lines, 3U + 5U + 6U + 7U);
+    EXPECT_EQ(units[1].n_headers, 3U);
+    EXPECT_EQ(units[3].bytes, 1U + 8U + 32U + 64U);
+
+    const auto &headers = cost.get_headers();
+    ASSERT_EQ(headers.size(), 4U);
+    order.clear();
+    for (const auto &h : headers) {
+      order.push_back(h.header);
+    }
+    EXPECT_EQ(order, (vector<Vertex_Id>{6, 5, 4, 3}));
+    EXPECT_EQ(headers[0].n_units, 3U);
+    EXPECT_EQ(headers[0].bytes, 3U * 64U);
+    EXPECT_EQ(headers[0].lines, 3U * 7U);
+    EXPECT_EQ(headers[2].n_units, 2U);
+    EXPECT_EQ(headers[3].bytes, 8U);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(Include_Cost_Test, empty_graph) {
+  const Graph empty;
+  const Csr_Graph csr(empty);
+  const Transitive_Closure closure(csr, 2);
+  const Include_Cost cost(csr, closure, vertexes, {}, 2);
+  EXPECT_TRUE(cost.get_units().empty());
+  EXPECT_TRUE(cost.get_headers().empty());
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,203 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "include_gardener.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+using INCLUDE_GARDENER::Analysis_Options;
+using INCLUDE_GARDENER::analyze;
+using INCLUDE_GARDENER::Include_Graph;
+using INCLUDE_GARDENER::NO_VERTEX;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+class Include_Gardener_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("gardener-%%%%-%%%%");
+    boost::filesystem::create_directories(dir / "inc");
+    dir = boost::filesystem::canonical(dir);
+    write("a.c", "#include \"b.h\"\n#include <c.h>\n#include <stdio.h>\n");
+    write("b.h", "#include <c.h>\n");
+    write("inc/c.h", "");
+    options.process_paths = {dir.string()};
+    options.include_paths = {(dir / "inc").string()};
+    options.n_threads = 2;
+  }
+
+  void TearDown() override { boost::filesystem::remove_all(dir); }
+
+  void write(const string &name, const string &content) {
+    ofstream of((dir / name).string());
+    of << content;
+  }
+
+  boost::filesystem::path dir;
+  Analysis_Options options;
+};
+
+// NOLINTNEXTLINE
+TEST_F(Include_Gardener_Test, analyze) {
+  const Include_Graph graph = analyze(options);
+  EXPECT_EQ(graph.get_n_vertices(), 4U);
+  EXPECT_EQ(graph.get_n_edges(), 4U);
+
+  const Vertex_Id a = graph.find((dir / "a.c").string());
+  const Vertex_Id c = graph.find((dir / "inc" / "c.h").string());
+  ASSERT_NE(a, NO_VERTEX);
+  ASSERT_NE(c, NO_VERTEX);
+  EXPECT_EQ(graph.get_vertex(c).name, "inc/c.h");
+  EXPECT_EQ(graph.get_vertex(c).path, (dir / "inc" / "c.h").string());
+  EXPECT_TRUE(graph.get_vertex(graph.find("stdio.h")).path.empty());
+
+  vector<string> included;
+  for (const auto &e : graph.out_edges(a)) {
+    EXPECT_EQ(e.source, a);
+    included.emplace_back(graph.get_vertex(e.target).name);
+  }
+  EXPECT_THAT(included,
+              ::testing::UnorderedElementsAre("b.h", "inc/c.h", "stdio.h"));
+
+  size_t n_vertices = 0;
+  for (const auto &v : graph.vertices()) {
+    EXPECT_EQ(v.id, n_vertices++);
+  }
+  EXPECT_EQ(n_vertices, 4U);
+
+  size_t n_edges = 0;
+  for (const auto &e : graph.edges()) {
+    EXPECT_GT(e.line, 0);
+    ++n_edges;
+    if (e.target == c) {
+      EXPECT_NE(e.source, c);
+    }
+  }
+  EXPECT_EQ(n_edges, 4U);
+}
+
+// The views refer to the data of the graph, which is not moved along with
+// the Include_Graph.
+//
+// NOLINTNEXTLINE
+TEST_F(Include_Gardener_Test, views_survive_move) {
+  Include_Graph graph = analyze(options);
+  const auto vertices = graph.vertices();
+  const auto edges = graph.edges();
+  const Include_Graph moved(std::move(graph));
+  size_t n_vertices = 0;
+  for (const auto &v : vertices) {
+    EXPECT_EQ(v.name, moved.get_vertex(v.id).name);
+    ++n_vertices;
+  }
+  EXPECT_EQ(n_vertices, moved.get_n_vertices());
+  size_t n_edges = 0;
+  for (const auto &e : edges) {
+    EXPECT_LT(e.source, moved.get_n_vertices());
+    ++n_edges;
+  }
+  EXPECT_EQ(n_edges, moved.get_n_edges());
+}
+
+// The size of each scanned file is recorded, also if its statements are
+// taken from the cache.
+//
+// NOLINTNEXTLINE
+TEST_F(Include_Gardener_Test, file_sizes) {
+  options.cache_file = (dir / "cache").string();
+  for (int run = 0; run < 2; ++run) {
+    const Include_Graph graph = analyze(options);
+    const auto a = graph.get_vertex(graph.find((dir / "a.c").string()));
+    EXPECT_EQ(a.size.bytes, 49U);
+    EXPECT_EQ(a.size.lines, 3U);
+    const auto b = graph.get_vertex(graph.find((dir / "b.h").string()));
+    EXPECT_EQ(b.size.bytes, 15U);
+    EXPECT_EQ(b.size.lines, 1U);
+    EXPECT_EQ(graph.get_vertex(graph.find("stdio.h")).size.bytes, 0U);
+  }
+}
+
+// The graph is written and checked for cycles without access to the
+// (internal) solver.
+//
+// NOLINTNEXTLINE
+TEST_F(Include_Gardener_Test, write_and_report_cycles) {
+  const Include_Graph graph = analyze(options);
+  std::ostringstream dot;
+  graph.write("dot", dot);
+  EXPECT_EQ(dot.str().rfind("digraph G {", 0), 0U);
+  EXPECT_NE(dot.str().find("inc/c.h"), string::npos);
+  std::ostringstream graphml;
+  graph.write("graphml", graphml);
+  EXPECT_NE(graphml.str().find("<graphml"), string::npos);
+  EXPECT_EQ(graph.report_cycles(), 0U);
+
+  write("inc/c.h", "#include \"b.h\"\n");
+  options.include_paths.push_back(dir.string());
+  EXPECT_EQ(analyze(options).report_cycles(), 1U);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Include_Gardener_Test, unknown_language) {
+  options.language = "cobol";
+  EXPECT_THROW(analyze(options), std::invalid_argument);
+}
+
+// Each shard has the vertices of all files, but only the out-edges of its
+// files; all shards together have the edges of the whole graph.
+//
+// NOLINTNEXTLINE
+TEST_F(Include_Gardener_Test, shards) {
+  for (int i = 0; i < 20; ++i) {
+    write("d" + std::to_string(i) + ".c", "#include \"b.h\"\n");
+  }
+  const Include_Graph all = analyze(options);
+  constexpr unsigned int N_SHARDS = 3;
+  size_t n_edges = 0;
+  for (unsigned int i = 1; i <= N_SHARDS; ++i) {
+    options.shard = {i, N_SHARDS};
+    const Include_Graph part = analyze(options);
+    for (const auto &v : all.vertices()) {
+      if (!v.path.empty()) {
+        EXPECT_NE(part.find(string(v.path)), NO_VERTEX) << v.path;
+      }
+    }
+    EXPECT_LT(part.get_n_edges(), all.get_n_edges());
+    for (const auto &e : part.edges()) {
+      const auto name = part.get_vertex(e.source).name;
+      EXPECT_TRUE(options.shard.contains(name)) << name;
+    }
+    n_edges += part.get_n_edges();
+  }
+  EXPECT_EQ(n_edges, all.get_n_edges());
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
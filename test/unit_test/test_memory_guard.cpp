@@ -0,0 +1,50 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "memory_guard.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Memory_Guard;
+
+// NOLINTNEXTLINE
+TEST(Memory_Guard_Test, reads_resident_memory) {
+  EXPECT_GT(Memory_Guard::get_rss(), 0U);
+}
+
+// NOLINTNEXTLINE
+TEST(Memory_Guard_Test, checks_limit) {
+  Memory_Guard unlimited;
+  EXPECT_FALSE(unlimited.is_exceeded());
+
+  Memory_Guard tiny(1);
+  EXPECT_TRUE(tiny.is_exceeded());
+  EXPECT_TRUE(tiny.is_exceeded());
+
+  Memory_Guard huge(static_cast<std::size_t>(1) << 50U);
+  for (unsigned int i = 0; i <= Memory_Guard::CHECK_INTERVAL; ++i) {
+    EXPECT_FALSE(huge.is_exceeded());
+  }
+  EXPECT_FALSE(huge.check());
+  EXPECT_TRUE(tiny.check());
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,123 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+#include "mock_solver.h"
+#include "mpsc_queue.h"
+#include "ndjson_stream.h"
+#include "solver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Mpsc_Queue;
+using INCLUDE_GARDENER::Ndjson_Stream;
+
+using std::make_shared;
+using std::ostringstream;
+using std::string;
+using std::thread;
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(Mpsc_Queue_Test, keeps_order_of_each_producer) {
+  constexpr int N_PRODUCERS = 4;
+  constexpr int N_ITEMS = 20000;
+  Mpsc_Queue<int> q;
+  vector<thread> producers;
+  for (int p = 0; p < N_PRODUCERS; ++p) {
+    producers.emplace_back([&q, p] {
+      for (int i = 0; i < N_ITEMS; ++i) {
+        q.push(p * N_ITEMS + i);
+      }
+    });
+  }
+
+  vector<int> last(N_PRODUCERS, -1);
+  int n_popped = 0;
+  while (n_popped < N_PRODUCERS * N_ITEMS) {
+    int value;
+    if (!q.pop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    const int p = value / N_ITEMS;
+    EXPECT_GT(value % N_ITEMS, last[p]);
+    last[p] = value % N_ITEMS;
+    ++n_popped;
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  int value;
+  EXPECT_FALSE(q.pop(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(Ndjson_Stream_Test, escapes_strings) {
+  string out;
+  Ndjson_Stream::append_string("a\"b\\c\nd\x01", &out);
+  EXPECT_EQ(out, "\"a\\\"b\\\\c\\nd\\u0001\"");
+}
+
+// NOLINTNEXTLINE
+TEST(Ndjson_Stream_Test, stream_equals_graph_output) {
+  Mock_Solver s;
+  ostringstream streamed;
+  auto stream = make_shared<Ndjson_Stream>(streamed);
+  s.set_stream(stream);
+
+  s.add_vertex("src/a.c", "/repo/src/a.c");
+  s.add_vertex("inc/b.h", "/repo/inc/b.h");
+  s.add_vertex("src/a.c", "/repo/src/a.c");
+  s.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 3);
+  s.add_edge("/repo/src/a.c", "stdio.h", 0, 1);
+  s.add_edge("/repo/src/a.c", "/repo/inc/b.h", 0, 9);
+  stream->close();
+
+  EXPECT_EQ(streamed.str(),
+            "{\"type\":\"vertex\",\"id\":0,\"name\":\"src/a.c\","
+            "\"path\":\"/repo/src/a.c\"}\n"
+            "{\"type\":\"vertex\",\"id\":1,\"name\":\"inc/b.h\","
+            "\"path\":\"/repo/inc/b.h\"}\n"
+            "{\"type\":\"edge\",\"source\":0,\"target\":1,\"line\":3}\n"
+            "{\"type\":\"vertex\",\"id\":2,\"name\":\"stdio.h\","
+            "\"path\":\"\"}\n"
+            "{\"type\":\"edge\",\"source\":0,\"target\":2,\"line\":1}\n");
+
+  // the same records, but vertices first
+  ostringstream written;
+  s.write_graph("ndjson", written);
+  auto sorted = [](const string &text) {
+    vector<string> lines;
+    std::istringstream is(text);
+    for (string line; std::getline(is, line);) {
+      lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+  };
+  EXPECT_EQ(sorted(written.str()), sorted(streamed.str()));
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,88 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "path_table.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Path_Table;
+
+using std::string;
+
+class Path_Table_Test : public ::testing::Test {
+ protected:
+  Path_Table table;
+};
+
+// NOLINTNEXTLINE
+TEST_F(Path_Table_Test, round_trip) {
+  for (const string p : {"/abs/path/to/file.h", "rel/file.h", "file.h",
+                         "../non/existing.h", "/", "a//b", "trailing/", ""}) {
+    auto id = table.insert(p);
+    EXPECT_NE(id, Path_Table::NONE);
+    EXPECT_EQ(table.get(id), p);
+    EXPECT_EQ(table.find(p), id);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(Path_Table_Test, insert_twice) {
+  auto id1 = table.insert("/abs/path/to/file.h");
+  auto n_nodes = table.size();
+  auto id2 = table.insert("/abs/path/to/file.h");
+  EXPECT_EQ(id1, id2);
+  EXPECT_EQ(n_nodes, table.size());
+}
+
+// NOLINTNEXTLINE
+TEST_F(Path_Table_Test, shares_prefixes_and_components) {
+  table.insert("/repo/third_party/lib/inc/a.h");
+  auto n_nodes = table.size();
+  table.insert("/repo/third_party/lib/inc/b.h");
+  EXPECT_EQ(n_nodes + 1, table.size());
+
+  // "lib", "inc" and "a.h" are stored only once
+  auto n_components = table.get_n_components();
+  table.insert("/repo/vendor/lib/inc/a.h");
+  EXPECT_EQ(n_components + 1, table.get_n_components());
+}
+
+// NOLINTNEXTLINE
+TEST_F(Path_Table_Test, find_missing) {
+  table.insert("/abs/path/to/file.h");
+  EXPECT_EQ(table.find("/abs/path/to/other.h"), Path_Table::NONE);
+  EXPECT_EQ(table.find("/abs/path/to/file.h/x"), Path_Table::NONE);
+  EXPECT_EQ(table.find("path/to/file.h"), Path_Table::NONE);
+  // a prefix of a stored path is a node, too
+  EXPECT_NE(table.find("/abs/path"), Path_Table::NONE);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Path_Table_Test, append) {
+  auto id = table.insert("inc/lib/f_1.h");
+  string out = "label=";
+  table.append(id, &out);
+  EXPECT_EQ(out, "label=inc/lib/f_1.h");
+  table.append(Path_Table::ROOT, &out);
+  EXPECT_EQ(out, "label=inc/lib/f_1.h");
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,93 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <vector>
+
+#include "csr_graph.h"
+#include "include_cost.h"
+#include "pch_recommender.h"
+#include "sample_graph.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Csr_Graph;
+using INCLUDE_GARDENER::Include_Cost;
+using INCLUDE_GARDENER::Pch_Candidate;
+using INCLUDE_GARDENER::Pch_Recommender;
+using INCLUDE_GARDENER::Transitive_Closure;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::vector;
+
+namespace {
+
+vector<Vertex_Id> get_headers(const vector<Pch_Candidate> &candidates) {
+  vector<Vertex_Id> headers;
+  for (const auto &c : candidates) {
+    headers.push_back(c.header);
+  }
+  return headers;
+}
+
+}  // namespace
+
+class Pch_Recommender_Test : public Sample_Graph_Test {};
+
+// 3.h is only included by one unit, 5.h and 6.h (a cycle) have the same
+// transitive bytes and units.
+//
+// NOLINTNEXTLINE
+TEST_F(Pch_Recommender_Test, scores) {
+  const Csr_Graph csr(g);
+  const Transitive_Closure closure(csr, 2);
+  const Include_Cost cost(csr, closure, vertexes, {0, 1, 2, 7}, 2);
+  const Pch_Recommender pch(closure, vertexes, cost, 1000, 2);
+
+  const auto &candidates = pch.get_candidates();
+  EXPECT_EQ(get_headers(candidates), (vector<Vertex_Id>{5, 6, 4}));
+  EXPECT_EQ(candidates[0].n_units, 3U);
+  EXPECT_EQ(candidates[0].bytes, 32U + 64U);
+  EXPECT_EQ(candidates[0].score, 3U * 96U);
+  EXPECT_EQ(candidates[2].n_units, 2U);
+  EXPECT_EQ(candidates[2].bytes, 16U + 32U + 64U);
+  EXPECT_EQ(candidates[2].score, 2U * 112U);
+
+  // 6.h is part of the PCH via 5.h
+  EXPECT_EQ(get_headers(pch.get_selected()), (vector<Vertex_Id>{5, 4}));
+  EXPECT_EQ(pch.get_selected_bytes(), 112U);
+}
+
+// NOLINTNEXTLINE
+TEST_F(Pch_Recommender_Test, budget) {
+  const Csr_Graph csr(g);
+  const Transitive_Closure closure(csr, 1);
+  const Include_Cost cost(csr, closure, vertexes, {0, 1, 2, 7}, 1);
+
+  const Pch_Recommender small(closure, vertexes, cost, 100, 1);
+  EXPECT_EQ(get_headers(small.get_selected()), (vector<Vertex_Id>{5}));
+  EXPECT_EQ(small.get_selected_bytes(), 96U);
+
+  const Pch_Recommender tiny(closure, vertexes, cost, 50, 1);
+  EXPECT_TRUE(tiny.get_selected().empty());
+  EXPECT_EQ(tiny.get_selected_bytes(), 0U);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,252 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "file_detector.h"
+#include "query_server.h"
+#include "statement_detector.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+using INCLUDE_GARDENER::File_Detector;
+using INCLUDE_GARDENER::Query_Server;
+using INCLUDE_GARDENER::Solver;
+using INCLUDE_GARDENER::Statement_Detector;
+
+using std::make_shared;
+using std::ofstream;
+using std::string;
+
+class Query_Server_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("gardener-%%%%-%%%%");
+    boost::filesystem::create_directories(dir);
+    dir = boost::filesystem::canonical(dir);
+    write("a.c", "#include \"b.h\"\n#include <stdio.h>\n");
+    write("b.h", "\n\n#include \"c.h\"\n");
+    write("c.h", "");
+
+    solver = Solver::get_solver("c");
+    File_Detector files(solver->get_file_regex(), {}, {dir.string()}, -1);
+    files.get(solver);
+    Statement_Detector detector(solver, 2);
+    for (auto id : files.take_ids()) {
+      detector.add_job(solver->get_abs_path(id));
+    }
+    detector.wait_for_workers();
+  }
+
+  void TearDown() override { boost::filesystem::remove_all(dir); }
+
+  void write(const string &name, const string &content) {
+    ofstream of((dir / name).string());
+    of << content;
+  }
+
+  string path(const string &name) const { return (dir / name).string(); }
+
+  /// @brief Connects to the server, retrying until it listens.
+  static int connect(const string &socket_path) {
+    for (int i = 0; i < 100; ++i) {
+      const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      sockaddr_un address{};
+      address.sun_family = AF_UNIX;
+      socket_path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+      if (::connect(fd, reinterpret_cast<sockaddr *>(&address),
+                    sizeof(address)) == 0) {
+        return fd;
+      }
+      ::close(fd);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+  }
+
+  static void send(int fd, const string &request) {
+    ASSERT_EQ(::write(fd, request.data(), request.size()),
+              static_cast<ssize_t>(request.size()));
+  }
+
+  /// @brief Reads until the server closes the connection.
+  static string read_all(int fd) {
+    string reply;
+    char buffer[256];
+    for (ssize_t n; (n = ::read(fd, buffer, sizeof(buffer))) > 0;) {
+      reply.append(buffer, static_cast<size_t>(n));
+    }
+    return reply;
+  }
+
+  /// @brief Reads one reply (up to and including the empty line).
+  static string read_reply(int fd) {
+    string reply;
+    char c;
+    while (reply.size() < 2 || reply.compare(reply.size() - 2, 2, "\n\n")) {
+      if (::read(fd, &c, 1) != 1) {
+        break;
+      }
+      reply.push_back(c);
+    }
+    return reply;
+  }
+
+  boost::filesystem::path dir;
+  Solver::Ptr solver;
+};
+
+// NOLINTNEXTLINE
+TEST_F(Query_Server_Test, queries) {
+  Query_Server server(solver, 1);
+  EXPECT_EQ(server.handle("deps " + path("a.c")),
+            "OK\n" + path("b.h") + "\nstdio.h\n\n");
+  EXPECT_EQ(server.handle("rdeps " + path("c.h")),
+            "OK\n" + path("b.h") + "\n\n");
+  EXPECT_EQ(server.handle("rdeps stdio.h"), "OK\n" + path("a.c") + "\n\n");
+  EXPECT_EQ(server.handle("path " + path("a.c") + " " + path("c.h")),
+            "OK\n" + path("a.c") + ":1\n" + path("b.h") + ":3\n" +
+                path("c.h") + "\n\n");
+  EXPECT_EQ(server.handle("path " + path("c.h") + " " + path("a.c")),
+            "ERROR no path\n\n");
+  EXPECT_EQ(server.handle("deps nope.h"), "ERROR unknown file nope.h\n\n");
+  EXPECT_EQ(server.handle("frobnicate"),
+            "ERROR invalid request: frobnicate\n\n");
+  EXPECT_FALSE(server.is_shut_down());
+  EXPECT_EQ(server.handle("shutdown"), "OK\n\n");
+  EXPECT_TRUE(server.is_shut_down());
+}
+
+// NOLINTNEXTLINE
+TEST_F(Query_Server_Test, rescan) {
+  Query_Server server(solver, 1, {dir.string()});
+  EXPECT_EQ(server.handle("rdeps " + path("c.h")),
+            "OK\n" + path("b.h") + "\n\n");
+
+  write("b.h", "#include <string.h>\n");
+  write("d.h", "#include \"c.h\"\n");
+  EXPECT_EQ(server.handle("rescan " + path("b.h") + " " + path("d.h")),
+            "OK\n2 files rescanned\n\n");
+  EXPECT_EQ(server.handle("deps " + path("b.h")), "OK\nstring.h\n\n");
+  EXPECT_EQ(server.handle("rdeps " + path("c.h")),
+            "OK\n" + path("d.h") + "\n\n");
+  EXPECT_EQ(solver->get_vertexes().get_name(solver->find_file(path("d.h"))),
+            "d.h");
+  EXPECT_EQ(server.handle("rescan " + path("x.h")),
+            "ERROR can't read " + path("x.h") + "\n\n");
+}
+
+// NOLINTNEXTLINE
+TEST_F(Query_Server_Test, socket) {
+  const string socket_path = path("gardener.sock");
+  Query_Server server(solver, 1);
+  std::thread thread([&] { server.serve(socket_path); });
+
+  const int fd = connect(socket_path);
+  ASSERT_GE(fd, 0);
+
+  send(fd, "deps " + path("b.h") + "\nshutdown\n");
+  const string reply = read_all(fd);
+  ::close(fd);
+  thread.join();
+  EXPECT_EQ(reply, "OK\n" + path("c.h") + "\n\nOK\n\n");
+  EXPECT_FALSE(boost::filesystem::exists(socket_path));
+}
+
+// A client which closes before it reads its replies doesn't stop the
+// server (no SIGPIPE).
+//
+// NOLINTNEXTLINE
+TEST_F(Query_Server_Test, client_closes_early) {
+  const string socket_path = path("gardener.sock");
+  Query_Server server(solver, 1);
+  std::thread thread([&] { server.serve(socket_path); });
+
+  for (int i = 0; i < 10; ++i) {
+    const int fd = connect(socket_path);
+    ASSERT_GE(fd, 0);
+    // Sends requests until the sockets are full, so the server is still
+    // answering when the client is gone.
+    ::fcntl(fd, F_SETFL, O_NONBLOCK);
+    const string request = "deps " + path("a.c") + "\n";
+    while (::write(fd, request.data(), request.size()) ==
+           static_cast<ssize_t>(request.size())) {
+    }
+    ::close(fd);
+  }
+
+  const int fd = connect(socket_path);
+  ASSERT_GE(fd, 0);
+  send(fd, "deps " + path("b.h") + "\nshutdown\n");
+  const string reply = read_all(fd);
+  ::close(fd);
+  thread.join();
+  EXPECT_EQ(reply, "OK\n" + path("c.h") + "\n\nOK\n\n");
+}
+
+// An idle, connected client doesn't block other clients.
+//
+// NOLINTNEXTLINE
+TEST_F(Query_Server_Test, idle_client) {
+  const string socket_path = path("gardener.sock");
+  Query_Server server(solver, 1);
+  std::thread thread([&] { server.serve(socket_path); });
+
+  const int idle = connect(socket_path);
+  ASSERT_GE(idle, 0);
+  send(idle, "deps " + path("b.h"));  // incomplete request line
+
+  const int fd = connect(socket_path);
+  ASSERT_GE(fd, 0);
+  send(fd, "deps " + path("b.h") + "\n");
+  EXPECT_EQ(read_reply(fd), "OK\n" + path("c.h") + "\n\n");
+
+  send(idle, "\n");
+  EXPECT_EQ(read_reply(idle), "OK\n" + path("c.h") + "\n\n");
+
+  send(fd, "shutdown\n");
+  EXPECT_EQ(read_all(fd), "OK\n\n");
+  EXPECT_EQ(read_all(idle), "");
+  ::close(fd);
+  ::close(idle);
+  thread.join();
+}
+
+// Only a socket is replaced, other files are never removed.
+//
+// NOLINTNEXTLINE
+TEST_F(Query_Server_Test, socket_path_is_file) {
+  Query_Server server(solver, 1);
+  EXPECT_THROW(server.serve(path("c.h")), std::runtime_error);
+  EXPECT_TRUE(boost::filesystem::exists(path("c.h")));
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,123 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "run_stats.h"
+#include "trace.h"
+
+#include <sstream>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Run_Stats;
+using INCLUDE_GARDENER::Scoped_Timer;
+using INCLUDE_GARDENER::Thread_Counter;
+using INCLUDE_GARDENER::Thread_Stats;
+using INCLUDE_GARDENER::Trace;
+
+using std::ostringstream;
+using std::string;
+using std::thread;
+
+// NOLINTNEXTLINE
+TEST(Run_Stats_Test, counter) {
+  Thread_Counter c;
+  EXPECT_EQ(c.get(), 0U);
+  c.add(3);
+  c.add(4);
+  EXPECT_EQ(c.get(), 7U);
+}
+
+// NOLINTNEXTLINE
+TEST(Run_Stats_Test, each_thread_has_own_stats) {
+  Run_Stats::enable();
+  Thread_Stats *first = nullptr;
+  Thread_Stats *second = nullptr;
+  thread t1([&first] {
+    Run_Stats::set_thread_name("stats test 1");
+    first = &Run_Stats::local();
+    first->n_files.add(2);
+    first->n_bytes.add(1234567);
+  });
+  t1.join();
+  thread t2([&second] {
+    second = &Run_Stats::local();
+    second->n_files.add(5);
+  });
+  t2.join();
+
+  ASSERT_NE(first, second);
+  EXPECT_EQ(first->n_files.get(), 2U);
+  EXPECT_EQ(second->n_files.get(), 5U);
+  EXPECT_EQ(&Run_Stats::local(), &Run_Stats::local());
+
+  // the stats of finished threads are part of the report
+  ostringstream os;
+  Run_Stats::write_report(os);
+  EXPECT_NE(os.str().find("stats test 1"), string::npos);
+  EXPECT_NE(os.str().find("1234567"), string::npos);
+}
+
+// Without statistics and trace, threads and phases are not registered.
+//
+// NOLINTNEXTLINE
+TEST(Run_Stats_Test, nothing_is_registered_if_disabled) {
+  const bool stats_enabled = Run_Stats::is_enabled();
+  const bool trace_enabled = Trace::is_enabled();
+  Run_Stats::disable();
+  Trace::disable();
+  auto count = [] {
+    int n = 0;
+    Run_Stats::for_each_thread([&n](const Thread_Stats &) { ++n; });
+    return n;
+  };
+  const int n_threads = count();
+  thread t([] {
+    Run_Stats::set_thread_name("unregistered thread");
+    Run_Stats::local().n_files.add(1);
+  });
+  t.join();
+  Run_Stats::add_phase("unregistered phase", Run_Stats::Clock::duration());
+  EXPECT_EQ(count(), n_threads);
+
+  ostringstream os;
+  Run_Stats::write_report(os);
+  EXPECT_EQ(os.str().find("unregistered"), string::npos);
+  if (stats_enabled) {
+    Run_Stats::enable();
+  }
+  if (trace_enabled) {
+    Trace::enable();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(Run_Stats_Test, timer) {
+  Thread_Counter c;
+  Run_Stats::enable();
+  {
+    const Scoped_Timer timer(&c);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_GE(c.get(), 2000000U);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,216 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "scan_cache.h"
+
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <fstream>
+
+#include "content_hash.h"
+#include "solver.h"
+#include "statement_detector.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+using INCLUDE_GARDENER::content_hash;
+using INCLUDE_GARDENER::Detected_Statement;
+using INCLUDE_GARDENER::File_Size;
+using INCLUDE_GARDENER::Scan_Cache;
+using INCLUDE_GARDENER::Solver;
+using INCLUDE_GARDENER::Statement_Detector;
+
+using std::make_shared;
+using std::ofstream;
+using std::optional;
+using std::string;
+using std::vector;
+
+class Scan_Cache_Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("gardener-%%%%-%%%%");
+    boost::filesystem::create_directories(dir);
+    dir = boost::filesystem::canonical(dir);
+    cache_file = (dir / "cache").string();
+    write("a.c", "#include \"b.h\"\n\n#include <stdio.h>\n");
+    write("b.h", "");
+  }
+
+  void TearDown() override { boost::filesystem::remove_all(dir); }
+
+  void write(const string &name, const string &content) {
+    ofstream of(path(name));
+    of << content;
+  }
+
+  // sets the mtime of a file to the given second
+  void set_mtime(const string &name, long seconds) {
+    const struct timeval times[2] = {{seconds, 0}, {seconds, 0}};
+    utimes(path(name).c_str(), times);
+  }
+
+  string path(const string &name) const { return (dir / name).string(); }
+
+  // scans all files with a new solver and a new cache
+  Solver::Ptr scan(size_t *n_hits, size_t *n_misses) {
+    auto solver = Solver::get_solver("c");
+    auto cache =
+        make_shared<Scan_Cache>(cache_file, solver->get_statement_regex());
+    solver->add_vertex("a.c", path("a.c"));
+    solver->add_vertex("b.h", path("b.h"));
+    Statement_Detector detector(solver, 1, cache);
+    detector.add_job(path("a.c"));
+    detector.add_job(path("b.h"));
+    detector.wait_for_workers();
+    *n_hits = cache->get_n_hits();
+    *n_misses = cache->get_n_misses();
+    EXPECT_TRUE(cache->save());
+    return solver;
+  }
+
+  boost::filesystem::path dir;
+  string cache_file;
+};
+
+// NOLINTNEXTLINE
+TEST_F(Scan_Cache_Test, store_and_lookup) {
+  const vector<string> regex = {"x"};
+  Scan_Cache cache(cache_file, regex);
+  optional<string> content;
+  EXPECT_FALSE(cache.lookup(path("a.c"), &content));
+  EXPECT_FALSE(content);
+  const string data = "#include \"b.h\"\n\n#include <stdio.h>\n";
+  cache.store(path("a.c"), data.size(), content_hash(data.data(), data.size()),
+              {{"b.h", 0, 1}, {"stdio.h", 1, 3}});
+
+  auto found = cache.lookup(path("a.c"), &content);
+  ASSERT_TRUE(found);
+  ASSERT_EQ(found->size(), 2U);
+  EXPECT_EQ((*found)[1].statement, "stdio.h");
+  EXPECT_EQ((*found)[1].idx, 1U);
+  EXPECT_EQ((*found)[1].line_no, 3U);
+  EXPECT_EQ(cache.get_n_hits(), 1U);
+  EXPECT_EQ(cache.get_n_misses(), 1U);
+  ASSERT_TRUE(cache.save());
+
+  // a reload returns the same, a different regex invalidates the cache
+  EXPECT_TRUE(Scan_Cache(cache_file, regex).lookup(path("a.c"), &content));
+  EXPECT_FALSE(Scan_Cache(cache_file, {"y"}).lookup(path("a.c"), &content));
+}
+
+// NOLINTNEXTLINE
+TEST_F(Scan_Cache_Test, broken_string_length) {
+  const vector<string> regex = {"x"};
+  Scan_Cache cache(cache_file, regex);
+  optional<string> content;
+  cache.lookup(path("b.h"), &content);
+  cache.store(path("b.h"), 0, content_hash("", 0), {});
+  ASSERT_TRUE(cache.save());
+
+  // the length of the first path (after magic, endian check, regex hash
+  // and number of entries) exceeds the file: the cache is not used
+  std::fstream fs(cache_file, std::fstream::in | std::fstream::out |
+                                  std::fstream::binary);
+  fs.seekp(28);
+  fs.write("\xff\xff\xff\x7f", 4);
+  fs.close();
+  EXPECT_FALSE(Scan_Cache(cache_file, regex).lookup(path("b.h"), &content));
+}
+
+// NOLINTNEXTLINE
+TEST_F(Scan_Cache_Test, content_of_modified_file) {
+  Scan_Cache cache(cache_file, {"x"});
+  optional<string> content;
+  cache.lookup(path("b.h"), &content);
+  cache.store(path("b.h"), 0, content_hash("", 0), {});
+  EXPECT_TRUE(cache.lookup(path("b.h"), &content));
+
+  // same size, but new content and mtime: the read content is returned
+  write("b.h", "");
+  set_mtime("b.h", 1000);
+  EXPECT_TRUE(cache.lookup(path("b.h"), &content));
+  const string old_content = "#include \"c.h\"\n\n#include <stdio.h>\n";
+  write("a.c", old_content);
+  cache.lookup(path("a.c"), &content);
+  cache.store(path("a.c"), old_content.size(),
+              content_hash(old_content.data(), old_content.size()), {});
+  write("a.c", "#include \"d.h\"\n\n#include <stdio.h>\n");
+  set_mtime("a.c", 1000);
+  content.reset();
+  EXPECT_FALSE(cache.lookup(path("a.c"), &content));
+  ASSERT_TRUE(content);
+  EXPECT_EQ(*content, "#include \"d.h\"\n\n#include <stdio.h>\n");
+}
+
+// NOLINTNEXTLINE
+TEST_F(Scan_Cache_Test, detector_uses_cache) {
+  size_t n_hits;
+  size_t n_misses;
+  auto first = scan(&n_hits, &n_misses);
+  EXPECT_EQ(n_hits, 0U);
+  EXPECT_EQ(n_misses, 2U);
+
+  auto second = scan(&n_hits, &n_misses);
+  EXPECT_EQ(n_hits, 2U);
+  EXPECT_EQ(n_misses, 0U);
+  EXPECT_EQ(boost::num_edges(second->get_graph()), 2U);
+  EXPECT_EQ(boost::num_vertices(second->get_graph()),
+            boost::num_vertices(first->get_graph()));
+
+  // only touched: still a hit
+  set_mtime("a.c", 1000);
+  scan(&n_hits, &n_misses);
+  EXPECT_EQ(n_hits, 2U);
+
+  // modified: a.c is scanned again
+  write("a.c", "#include <stdio.h>\n");
+  auto third = scan(&n_hits, &n_misses);
+  EXPECT_EQ(n_hits, 1U);
+  EXPECT_EQ(n_misses, 1U);
+  EXPECT_EQ(boost::num_edges(third->get_graph()), 1U);
+}
+
+// A file which can't be read is not scanned, its size is kept.
+//
+// NOLINTNEXTLINE
+TEST_F(Scan_Cache_Test, unreadable_file) {
+  boost::filesystem::create_directory(dir / "d.h");
+  auto solver = Solver::get_solver("c");
+  auto cache =
+      make_shared<Scan_Cache>(cache_file, solver->get_statement_regex());
+  const auto v = solver->add_vertex("d.h", path("d.h"));
+  solver->set_file_sizes({{path("d.h"), File_Size{100, 5}}});
+  {
+    Statement_Detector detector(solver, 1, cache);
+    detector.add_job(path("d.h"));
+    detector.wait_for_workers();
+  }
+  EXPECT_EQ(cache->get_n_misses(), 1U);
+  EXPECT_EQ(solver->get_vertexes().get_file_size(v).bytes, 100U);
+  EXPECT_EQ(solver->get_vertexes().get_file_size(v).lines, 5U);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
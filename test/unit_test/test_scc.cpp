@@ -0,0 +1,105 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <vector>
+
+#include "csr_graph.h"
+#include "scc.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Csr_Graph;
+using INCLUDE_GARDENER::Edge;
+using INCLUDE_GARDENER::Graph;
+using INCLUDE_GARDENER::Strong_Components;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::vector;
+
+namespace {
+
+Graph make_graph(Vertex_Id n_vertices,
+                 const vector<std::pair<Vertex_Id, Vertex_Id>> &edges) {
+  Graph g(n_vertices);
+  int line = 0;
+  for (auto e : edges) {
+    boost::add_edge(e.first, e.second, Edge{line++}, g);
+  }
+  return g;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(Csr_Graph_Test, snapshot_and_reverse) {
+  auto g = make_graph(4, {{0, 1}, {0, 2}, {1, 2}, {3, 0}});
+  Csr_Graph csr(g);
+  EXPECT_EQ(csr.get_n_vertices(), 4U);
+  EXPECT_EQ(csr.get_n_edges(), 4U);
+  ASSERT_EQ(csr.get_end_edge(0) - csr.get_first_edge(0), 2U);
+  EXPECT_EQ(csr.get_target(csr.get_first_edge(0)), 1U);
+  EXPECT_EQ(csr.get_line(csr.get_first_edge(0) + 1), 1);
+  EXPECT_EQ(csr.get_first_edge(2), csr.get_end_edge(2));
+
+  auto r = csr.reversed();
+  EXPECT_EQ(r.get_n_edges(), 4U);
+  ASSERT_EQ(r.get_end_edge(2) - r.get_first_edge(2), 2U);
+  EXPECT_EQ(r.get_target(r.get_first_edge(2)), 0U);
+  EXPECT_EQ(r.get_line(r.get_first_edge(2)), 1);
+  EXPECT_EQ(r.get_target(r.get_first_edge(2) + 1), 1U);
+  EXPECT_EQ(r.get_target(r.get_first_edge(0)), 3U);
+  EXPECT_EQ(r.get_first_edge(3), r.get_end_edge(3));
+}
+
+// NOLINTNEXTLINE
+TEST(Strong_Components_Test, components_in_reverse_topological_order) {
+  // 0 -> 1 <-> 2 -> 3, 4 -> 4, 5
+  auto g = make_graph(6, {{0, 1}, {1, 2}, {2, 1}, {2, 3}, {4, 4}});
+  Csr_Graph csr(g);
+  Strong_Components scc(csr);
+  EXPECT_EQ(scc.size(), 5U);
+  EXPECT_EQ(scc.get_component(1), scc.get_component(2));
+  EXPECT_EQ(scc.get_n_members(scc.get_component(1)), 2U);
+  EXPECT_NE(scc.get_component(4), scc.get_component(5));
+  EXPECT_EQ(scc.get_n_members(scc.get_component(4)), 1U);
+
+  for (Vertex_Id v = 0; v < csr.get_n_vertices(); ++v) {
+    for (auto e = csr.get_first_edge(v); e < csr.get_end_edge(v); ++e) {
+      EXPECT_GE(scc.get_component(v), scc.get_component(csr.get_target(e)));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(Strong_Components_Test, deep_chain_does_not_overflow) {
+  constexpr Vertex_Id N = 1000000;
+  Graph g(N);
+  for (Vertex_Id v = 0; v + 1 < N; ++v) {
+    boost::add_edge(v, v + 1, g);
+  }
+  boost::add_edge(N - 1, 0, g);
+  Csr_Graph csr(g);
+  Strong_Components scc(csr);
+  EXPECT_EQ(scc.size(), 1U);
+  EXPECT_EQ(scc.get_n_members(0), N);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -0,0 +1,74 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "shard.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using INCLUDE_GARDENER::Shard;
+using std::string;
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(Shard_Test, parse) {
+  const auto shard = Shard::parse("2/3");
+  ASSERT_TRUE(shard);
+  EXPECT_EQ(shard->index, 2U);
+  EXPECT_EQ(shard->count, 3U);
+  EXPECT_TRUE(shard->is_partial());
+  EXPECT_FALSE(Shard::parse("1/1")->is_partial());
+
+  for (const string spec :
+       {"", "1", "/2", "1/", "0/2", "3/2", "-1/2", "1/0", "a/2", "1/2/3"}) {
+    EXPECT_FALSE(Shard::parse(spec)) << spec;
+  }
+}
+
+// Each file belongs to exactly one shard, and the shards are balanced.
+//
+// NOLINTNEXTLINE
+TEST(Shard_Test, partitions_the_files) {
+  constexpr unsigned int N_SHARDS = 4;
+  constexpr unsigned int N_FILES = 4000;
+  vector<unsigned int> sizes(N_SHARDS, 0);
+  for (unsigned int i = 0; i < N_FILES; ++i) {
+    const string name = "src/dir_" + std::to_string(i % 17) + "/file_" +
+                        std::to_string(i) + ".c";
+    unsigned int n_shards = 0;
+    for (unsigned int s = 1; s <= N_SHARDS; ++s) {
+      if (Shard{s, N_SHARDS}.contains(name)) {
+        ++n_shards;
+        ++sizes[s - 1];
+      }
+    }
+    EXPECT_EQ(n_shards, 1U) << name;
+    EXPECT_TRUE(Shard().contains(name));
+  }
+  for (auto size : sizes) {
+    EXPECT_GT(size, N_FILES / N_SHARDS * 9 / 10);
+    EXPECT_LT(size, N_FILES / N_SHARDS * 11 / 10);
+  }
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
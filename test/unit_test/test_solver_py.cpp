@@ -52,6 +52,12 @@ class SolverPyTest : public ::testing::Test, public Solver_Py {
  public:
   using Solver_Py::is_module;
   using Solver_Py::is_package;
+
+  unsigned int edge_count(const string &src, const string &dst) {
+    return graph[boost::edge(vertexes.find(src), vertexes.find(dst), graph)
+                     .first]
+        .count;
+  }
 };
 
 class Mock_Solver_Py : public Solver_Py {
@@ -181,5 +187,15 @@ TEST_F(SolverPyTest, MultiLineMatch) {
   d->call_process_stream(sstream, "id");
   d->wait_for_workers();
 }
+// A duplicate found via the dummy entry of the same name is counted
+// like any other duplicate.
+// NOLINTNEXTLINE
+TEST_F(SolverPyTest, DuplicateByNameIsCounted) {
+  insert_edge("/a.py", "", "mod", 1);
+  insert_edge("/a.py", "/x/mod.py", "mod", 2);
+  insert_edge("/a.py", "", "mod", 3);
+  EXPECT_EQ(boost::num_edges(graph), 1U);
+  EXPECT_EQ(edge_count("/a.py", "mod"), 3U);
+}
 
 // vim: filetype=cpp et ts=2 sw=2 sts=2
@@ -22,14 +22,27 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
+#include <boost/filesystem.hpp>
+
+#include "memory_guard.h"
+#include "solver_c.h"
+
+using INCLUDE_GARDENER::Memory_Guard;
 using INCLUDE_GARDENER::Solver;
+using INCLUDE_GARDENER::Solver_C;
 using INCLUDE_GARDENER::Statement_Detector;
 
 using std::endl;
 using std::istream;
 using std::make_shared;
+using std::ofstream;
 using std::optional;
 using std::pair;
 using std::string;
@@ -352,4 +365,243 @@ TEST_F(Statement_Detector_Test, ml_detection_from_stream_6) {
   d->wait_for_workers();
 }
 
+//
+// The statements of byte-identical files are kept once two of them
+// were scanned; further files are not scanned anymore, but the
+// statements are reported for each file.
+//
+// NOLINTNEXTLINE
+TEST_F(Statement_Detector_Test, identical_files_are_scanned_once) {
+  using ::testing::_;
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("gardener-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+  const string content = "#include \"abc.h\"\n\n#include <xyz.h>\n";
+  const vector<string> files = {(dir / "a.h").string(),
+                                (dir / "b.h").string(),
+                                (dir / "c.h").string(),
+                                (dir / "d.h").string()};
+  for (const auto &f : files) {
+    ofstream(f) << (f == files[3] ? content + "\n" : content);
+  }
+
+  auto s = make_shared<Mock_C_Solver>();
+  for (const auto &f : files) {
+    EXPECT_CALL(*s, add_edge(f, "abc.h", 0, 1)).Times(1);
+    EXPECT_CALL(*s, add_edge(f, "xyz.h", 1, 3)).Times(1);
+  }
+  EXPECT_CALL(*s, add_edge((dir / "empty.h").string(), _, _, _)).Times(0);
+  ofstream((dir / "empty.h").string()).close();
+
+  Statement_Detector d(s, 1);
+  for (const auto &f : files) {
+    d.add_job(f);
+  }
+  d.add_job((dir / "empty.h").string());
+  d.add_job((dir / "missing.h").string());
+  d.wait_for_workers();
+  EXPECT_EQ(d.get_n_reused(), 1U);
+  boost::filesystem::remove_all(dir);
+}
+
+// With a bounded queue (and a memory limit which is always exceeded),
+// add_job blocks until the workers took the queued jobs; all files are
+// still processed.
+//
+// NOLINTNEXTLINE
+TEST_F(Statement_Detector_Test, bounded_queue_processes_all_jobs) {
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("gardener-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+  constexpr int N_FILES = 50;
+  auto s = make_shared<Mock_C_Solver>();
+  vector<string> files;
+  for (int i = 0; i < N_FILES; ++i) {
+    files.push_back((dir / (std::to_string(i) + ".h")).string());
+    ofstream(files.back()) << "#include \"" << i << ".h\"\n";
+    EXPECT_CALL(*s, add_edge(files.back(), std::to_string(i) + ".h", 0, 1))
+        .Times(1);
+  }
+
+  Statement_Detector bounded(s, 2, nullptr, 1);
+  for (const auto &f : files) {
+    bounded.add_job(f);
+  }
+  bounded.wait_for_workers();
+  EXPECT_EQ(bounded.get_n_throttled(), 0U);
+  ::testing::Mock::VerifyAndClearExpectations(s.get());
+
+  for (const auto &f : files) {
+    EXPECT_CALL(*s, add_edge(f, ::testing::_, 0, 1)).Times(1);
+  }
+  Statement_Detector throttled(s, 2, nullptr, 0, 1);
+  for (const auto &f : files) {
+    throttled.add_job(f);
+  }
+  throttled.wait_for_workers();
+  ::testing::Mock::VerifyAndClearExpectations(s.get());
+
+  // the same files, read via io_uring (if available)
+  for (const auto &f : files) {
+    EXPECT_CALL(*s, add_edge(f, ::testing::_, 0, 1)).Times(1);
+  }
+  Statement_Detector uring(s, 2, nullptr, 4, 0, 8);
+  for (const auto &f : files) {
+    uring.add_job(f);
+  }
+  uring.wait_for_workers();
+  boost::filesystem::remove_all(dir);
+}
+
+// When the memory limit is exceeded partway through the scan, the
+// remaining jobs are throttled, but still scanned by more than one worker.
+//
+// NOLINTNEXTLINE
+TEST_F(Statement_Detector_Test, memory_limit_keeps_workers_busy) {
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("gardener-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+  // the resident memory is measured at every CHECK_INTERVAL-th job: the
+  // ballast is allocated after the second measurement, so the jobs from
+  // the third measurement on are throttled ("late" files)
+  constexpr int INTERVAL = Memory_Guard::CHECK_INTERVAL;
+  constexpr int N_FILES = 3 * INTERVAL;
+  constexpr std::size_t MARGIN = 64U << 20U;
+  vector<string> files;
+  for (int i = 0; i < N_FILES; ++i) {
+    const auto name = (i < 2 * INTERVAL ? "" : "late") + std::to_string(i);
+    files.push_back((dir / (name + ".h")).string());
+    ofstream(files.back()) << "#include <stdio.h>\n";
+  }
+
+  auto s = make_shared<Mock_C_Solver>();
+  std::mutex active_mutex;
+  int n_active = 0;
+  int max_active = 0;
+  EXPECT_CALL(*s, add_edge(::testing::_, "stdio.h", 1, 1))
+      .Times(N_FILES)
+      .WillRepeatedly(::testing::Invoke(
+          [&](const string &file, const string &, unsigned int,
+              unsigned int) {
+            const bool late = file.find("late") != string::npos;
+            if (late) {
+              std::lock_guard<std::mutex> lck(active_mutex);
+              max_active = std::max(max_active, ++n_active);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if (late) {
+              std::lock_guard<std::mutex> lck(active_mutex);
+              --n_active;
+            }
+          }));
+
+  Statement_Detector d(s, 2, nullptr, 0, Memory_Guard::get_rss() + MARGIN);
+  vector<char> ballast;
+  for (int i = 0; i < N_FILES; ++i) {
+    if (i == INTERVAL + 1) {
+      ballast.assign(2 * MARGIN, 1);
+    }
+    d.add_job(files[static_cast<std::size_t>(i)]);
+  }
+  d.wait_for_workers();
+  EXPECT_GT(d.get_n_throttled(), 0U);
+  EXPECT_GE(max_active, 2);
+  EXPECT_EQ(ballast.back(), 1);
+  boost::filesystem::remove_all(dir);
+}
+
+// While the memory limit is exceeded, add_job hands over one job per
+// worker and then waits until they are processed.
+//
+// NOLINTNEXTLINE
+TEST_F(Statement_Detector_Test, memory_limit_pauses_the_hand_over) {
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("gardener-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+  constexpr int N_FILES = 20;
+  constexpr int N_WORKERS = 2;
+  vector<string> files;
+  for (int i = 0; i < N_FILES; ++i) {
+    files.push_back((dir / (std::to_string(i) + ".h")).string());
+    ofstream(files.back()) << "#include <stdio.h>\n";
+  }
+
+  auto s = make_shared<Mock_C_Solver>();
+  std::atomic<int> n_processed{0};
+  EXPECT_CALL(*s, add_edge(::testing::_, "stdio.h", 1, 1))
+      .Times(N_FILES)
+      .WillRepeatedly(::testing::Invoke(
+          [&](const string &, const string &, unsigned int, unsigned int) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ++n_processed;
+          }));
+
+  Statement_Detector d(s, N_WORKERS, nullptr, 0, 1);
+  for (int i = 0; i < N_FILES; ++i) {
+    d.add_job(files[static_cast<std::size_t>(i)]);
+    EXPECT_LE(i + 1 - n_processed.load(), N_WORKERS);
+  }
+  d.wait_for_workers();
+  EXPECT_EQ(d.get_n_throttled(), static_cast<std::size_t>(N_FILES));
+  boost::filesystem::remove_all(dir);
+}
+
+// With resolver threads, all statements are still passed to the solver:
+// via add_edge if the solver doesn't support resolve_edge, otherwise as
+// resolved edges, which give the same graph as without pipeline.
+//
+// NOLINTNEXTLINE
+TEST_F(Statement_Detector_Test, pipeline_processes_all_jobs) {
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("gardener-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+  constexpr int N_FILES = 50;
+  auto s = make_shared<Mock_C_Solver>();
+  vector<string> files;
+  for (int i = 0; i < N_FILES; ++i) {
+    files.push_back((dir / (std::to_string(i) + ".h")).string());
+    ofstream(files.back()) << "#include \"" << (i + 1) % N_FILES
+                           << ".h\"\n#include <missing.h>\n";
+    EXPECT_CALL(*s, add_edge(files.back(), ::testing::_, ::testing::_,
+                             ::testing::_))
+        .Times(2);
+  }
+
+  Statement_Detector mocked(s, 2, nullptr, 4, 0, 0, 2);
+  for (const auto &f : files) {
+    mocked.add_job(f);
+  }
+  mocked.wait_for_workers();
+  const auto stats = mocked.get_queue_stats();
+  ASSERT_EQ(stats.size(), 3U);
+  EXPECT_EQ(stats[0].first, "jobs");
+  EXPECT_EQ(stats[0].second.n_pushes, static_cast<std::uint64_t>(N_FILES));
+  EXPECT_EQ(stats[1].first, "resolve");
+  EXPECT_EQ(stats[1].second.capacity, 4U);
+  EXPECT_LE(stats[1].second.max_depth, 4U);
+  EXPECT_EQ(stats[2].first, "insert");
+  EXPECT_EQ(stats[2].second.n_pushes, 0U);
+
+  auto direct = make_shared<Solver_C>();
+  auto pipelined = make_shared<Solver_C>();
+  for (const auto &solver : {direct, pipelined}) {
+    Statement_Detector d(solver, 2, nullptr, 0, 0, 0,
+                         solver == pipelined ? 3 : 0);
+    for (const auto &f : files) {
+      d.add_job(f);
+    }
+    d.wait_for_workers();
+  }
+  EXPECT_EQ(boost::num_edges(pipelined->get_graph()),
+            static_cast<std::size_t>(2 * N_FILES));
+  EXPECT_EQ(boost::num_vertices(pipelined->get_graph()),
+            boost::num_vertices(direct->get_graph()));
+  for (const auto &f : files) {
+    const auto v = pipelined->find_file(f);
+    ASSERT_NE(v, INCLUDE_GARDENER::NO_VERTEX);
+    EXPECT_EQ(boost::out_degree(v, pipelined->get_graph()), 2U);
+  }
+  boost::filesystem::remove_all(dir);
+}
+
 // vim: filetype=cpp et ts=2 sw=2 sts=2
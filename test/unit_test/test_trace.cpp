@@ -0,0 +1,62 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "trace.h"
+
+#include <sstream>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Run_Stats;
+using INCLUDE_GARDENER::Trace;
+using INCLUDE_GARDENER::Trace_Span;
+
+using std::ostringstream;
+using std::string;
+using std::thread;
+
+// NOLINTNEXTLINE
+TEST(Trace_Test, records_spans_per_thread) {
+  Trace::enable();
+  thread t([] {
+    Run_Stats::set_thread_name("trace test");
+    const Trace_Span span("job", "dir/\"file\".h", 42);
+  });
+  t.join();
+  const auto begin = Run_Stats::Clock::now();
+  Trace::record("phase", begin, begin + std::chrono::nanoseconds(1500));
+
+  ostringstream os;
+  Trace::write(os);
+  const string json = os.str();
+  EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0),
+            0U);
+  EXPECT_NE(json.find("\"args\":{\"name\":\"trace test\"}"), string::npos);
+  EXPECT_NE(json.find("\"name\":\"job\",\"ph\":\"X\""), string::npos);
+  EXPECT_NE(
+      json.find("\"args\":{\"detail\":\"dir/\\\"file\\\".h\",\"size\":42}"),
+      string::npos);
+  EXPECT_NE(json.find("\"dur\":1.500"), string::npos);
+  EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
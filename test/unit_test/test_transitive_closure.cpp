@@ -0,0 +1,124 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include <stdexcept>
+#include <vector>
+
+#include "csr_graph.h"
+#include "transitive_closure.h"
+
+#include <boost/range/iterator_range.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Csr_Graph;
+using INCLUDE_GARDENER::Graph;
+using INCLUDE_GARDENER::Transitive_Closure;
+using INCLUDE_GARDENER::Vertex_Id;
+
+using std::vector;
+
+namespace {
+
+/// Reachable set via a plain DFS, as reference.
+vector<Vertex_Id> reachable(const Graph &g, Vertex_Id v) {
+  vector<bool> seen(boost::num_vertices(g), false);
+  vector<Vertex_Id> todo{v};
+  while (!todo.empty()) {
+    auto u = todo.back();
+    todo.pop_back();
+    for (auto e : boost::make_iterator_range(boost::out_edges(u, g))) {
+      auto w = static_cast<Vertex_Id>(boost::target(e, g));
+      if (!seen[w]) {
+        seen[w] = true;
+        todo.push_back(w);
+      }
+    }
+  }
+  vector<Vertex_Id> result;
+  for (Vertex_Id w = 0; w < seen.size(); ++w) {
+    if (seen[w]) {
+      result.push_back(w);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(Transitive_Closure_Test, small_graph) {
+  // 0 -> 1 -> 2 <-> 3 -> 4, 5 -> 1
+  Graph g(6);
+  boost::add_edge(0, 1, g);
+  boost::add_edge(1, 2, g);
+  boost::add_edge(2, 3, g);
+  boost::add_edge(3, 2, g);
+  boost::add_edge(3, 4, g);
+  boost::add_edge(5, 1, g);
+  Csr_Graph csr(g);
+  Transitive_Closure closure(csr, 1);
+
+  EXPECT_EQ(closure.get_reachable(0), (vector<Vertex_Id>{1, 2, 3, 4}));
+  EXPECT_EQ(closure.get_reachable(2), (vector<Vertex_Id>{2, 3, 4}));
+  EXPECT_EQ(closure.get_reachable(4), vector<Vertex_Id>{});
+  EXPECT_TRUE(closure.reaches(5, 4));
+  EXPECT_FALSE(closure.reaches(1, 1));
+  EXPECT_TRUE(closure.reaches(3, 3));
+  EXPECT_EQ(closure.count_reachable(5), 4U);
+}
+
+// NOLINTNEXTLINE
+TEST(Transitive_Closure_Test, memory_limit) {
+  // 300 vertices without edges: 300 components with rows of 8 words
+  Graph g(300);
+  Csr_Graph csr(g);
+  EXPECT_THROW(Transitive_Closure(csr, 1, 300 * 8 * 8 - 1),
+               std::runtime_error);
+  Transitive_Closure closure(csr, 1, 300 * 8 * 8);
+  EXPECT_EQ(closure.count_reachable(0), 0U);
+  EXPECT_GT(Transitive_Closure::get_physical_memory(), 0U);
+}
+
+// NOLINTNEXTLINE
+TEST(Transitive_Closure_Test, parallel_equals_dfs) {
+  // layered random-ish DAG with a few back edges
+  constexpr Vertex_Id N = 3000;
+  Graph g(N);
+  for (Vertex_Id v = 0; v < N; ++v) {
+    for (Vertex_Id k = 1; k <= 3; ++k) {
+      auto w = (v * 7919U + k * 104729U) % N;
+      if (w > v || v % 97 == 0) {
+        boost::add_edge(v, w, g);
+      }
+    }
+  }
+  Csr_Graph csr(g);
+  Transitive_Closure single(csr, 1);
+  Transitive_Closure parallel(csr, 4);
+  for (Vertex_Id v = 0; v < N; v += 13) {
+    auto expectation = reachable(g, v);
+    EXPECT_EQ(single.get_reachable(v), expectation);
+    EXPECT_EQ(parallel.get_reachable(v), expectation);
+  }
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
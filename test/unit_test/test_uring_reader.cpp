@@ -0,0 +1,89 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "uring_reader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Uring_Reader;
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(Uring_Reader_Test, reads_all_files) {
+  std::unique_ptr<Uring_Reader> reader;
+  try {
+    reader = std::make_unique<Uring_Reader>(4);
+  } catch (const std::runtime_error &e) {
+    GTEST_SKIP() << e.what();
+  }
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("gardener-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+
+  // empty, small, exactly one buffer and several buffers
+  const vector<size_t> sizes = {0, 100, Uring_Reader::INITIAL_BUFFER_SIZE,
+                                5 * Uring_Reader::INITIAL_BUFFER_SIZE + 7,
+                                42, 1, 4096, 3};
+  vector<string> paths;
+  vector<string> contents;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    paths.push_back((dir / (std::to_string(i) + ".h")).string());
+    contents.emplace_back(sizes[i], static_cast<char>('a' + i));
+    ofstream(paths.back(), ofstream::binary) << contents.back();
+  }
+  paths.push_back((dir / "missing.h").string());
+
+  vector<Uring_Reader::Result> done;
+  size_t next = 0;
+  while (next < paths.size() || reader->get_n_in_flight() > 0) {
+    while (next < paths.size() && reader->has_space()) {
+      reader->add(paths[next++]);
+    }
+    reader->run(&done);
+  }
+
+  ASSERT_EQ(done.size(), paths.size());
+  for (const auto &result : done) {
+    const auto pos = std::find(paths.begin(), paths.end(), result.path);
+    ASSERT_NE(pos, paths.end());
+    const auto index = static_cast<size_t>(pos - paths.begin());
+    if (index == sizes.size()) {
+      EXPECT_FALSE(result.content) << result.path;
+    } else {
+      ASSERT_TRUE(result.content) << result.path;
+      EXPECT_EQ(*result.content, contents[index]) << result.path;
+    }
+  }
+  boost::filesystem::remove_all(dir);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2
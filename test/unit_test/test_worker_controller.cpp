@@ -0,0 +1,99 @@
+// Include-Gardener
+//
+// Copyright (C) 2019  Christian Haettich [feddischson]
+//
+// This program is free software; you can redistribute it
+// and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation;
+// either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will
+// be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General
+// Public License along with this program; if not, see
+// <http://www.gnu.org/licenses/>.
+//
+#include "worker_controller.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using INCLUDE_GARDENER::Worker_Controller;
+
+using std::string;
+using std::chrono::milliseconds;
+
+namespace {
+constexpr std::uint64_t MS = 1000000;
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(Worker_Controller_Test, parses_cgroup_cpu_max) {
+  EXPECT_EQ(Worker_Controller::parse_cpu_max("200000 100000"), 2.0);
+  EXPECT_EQ(Worker_Controller::parse_cpu_max("150000 100000\n"), 1.5);
+  EXPECT_FALSE(Worker_Controller::parse_cpu_max("max 100000"));
+  EXPECT_FALSE(Worker_Controller::parse_cpu_max(""));
+  EXPECT_FALSE(Worker_Controller::parse_cpu_max("100000 0"));
+  EXPECT_FALSE(Worker_Controller::parse_cpu_max("-1 100000"));
+}
+
+// NOLINTNEXTLINE
+TEST(Worker_Controller_Test, parses_proc_self_cgroup) {
+  const string v1 =
+      "12:cpu,cpuacct:/docker/abc\n11:memory:/docker/abc\n0::/init.scope\n";
+  EXPECT_EQ(Worker_Controller::parse_cgroup_path(v1, "cpu"), "/docker/abc");
+  EXPECT_EQ(Worker_Controller::parse_cgroup_path(v1, ""), "/init.scope");
+  EXPECT_FALSE(Worker_Controller::parse_cgroup_path(v1, "cpuset"));
+  EXPECT_EQ(Worker_Controller::parse_cgroup_path("0::/\n", ""), "/");
+  EXPECT_FALSE(Worker_Controller::parse_cgroup_path("0::/\n", "cpu"));
+  EXPECT_FALSE(Worker_Controller::parse_cgroup_path("", ""));
+}
+
+// NOLINTNEXTLINE
+TEST(Worker_Controller_Test, cpu_budget_is_positive) {
+  EXPECT_GE(Worker_Controller::get_cpu_budget(), 1U);
+}
+
+// NOLINTNEXTLINE
+TEST(Worker_Controller_Test, climbs_while_blocked_and_reverts_on_loss) {
+  Worker_Controller controller(4, 8);
+  EXPECT_EQ(controller.get_n_active(), 4U);
+
+  // CPU-bound: no more workers than CPUs
+  EXPECT_EQ(controller.evaluate(100.0, 0.0), 4U);
+
+  // blocked: one more worker per interval, as long as it doesn't hurt
+  EXPECT_EQ(controller.evaluate(100.0, 0.5), 5U);
+  EXPECT_EQ(controller.evaluate(120.0, 0.5), 6U);
+
+  // the throughput dropped: revert, take a new baseline, climb again
+  EXPECT_EQ(controller.evaluate(80.0, 0.5), 5U);
+  EXPECT_EQ(controller.evaluate(80.0, 0.5), 5U);
+  EXPECT_EQ(controller.evaluate(80.0, 0.5), 6U);
+
+  // no longer blocked: back to the CPU budget
+  EXPECT_EQ(controller.evaluate(90.0, 0.1), 4U);
+  EXPECT_EQ(controller.get_n_active(), 4U);
+}
+
+// NOLINTNEXTLINE
+TEST(Worker_Controller_Test, evaluates_jobs_per_interval) {
+  Worker_Controller controller(1, 2);
+  const auto start = Worker_Controller::Clock::now();
+
+  // the first interval is the baseline
+  EXPECT_FALSE(controller.add_job(start + milliseconds(10), 10 * MS, MS));
+  EXPECT_FALSE(controller.add_job(start + milliseconds(150), 10 * MS, MS));
+  EXPECT_EQ(controller.get_n_active(), 1U);
+
+  // mostly blocked: a second worker is activated
+  EXPECT_TRUE(controller.add_job(start + milliseconds(300), 10 * MS, MS));
+  EXPECT_EQ(controller.get_n_active(), 2U);
+}
+
+// vim: filetype=cpp et ts=2 sw=2 sts=2